@@ -0,0 +1,163 @@
+/**
+ * the agent of the distributed version of the program.
+ *
+ * usage: ./Agent-Main [coordinator host] [coordinator port] [num workers]
+ *
+ * connects to a coordinator (Coordinator-Main.out), and finds the factors in
+ *   the chunks of the range it hands out, using the same pool of worker threads
+ *   as Threads-Main.out.
+ *
+ * @sourceFile Agent-Main.cpp
+ *
+ * @program    Agent-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       see Coordinator-Main.cpp for the messages exchanged with the
+ *   coordinator.
+ */
+#include <netdb.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include "Engine.h"
+#include "ThreadTransport.h"
+
+int main(int,char**);
+
+/**
+ * entry point of the program.
+ *
+ * @function   main
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * connects to the coordinator, starts a ThreadTransport, and posts the chunks
+ *   received from the coordinator to it until the coordinator shuts down its
+ *   side of the connection, then waits for the workers to terminate. the
+ *   collector of the transport relays the results of every chunk to the
+ *   coordinator as a batch.
+ *
+ * the number to factor, and the chunk size come from the coordinator; the
+ *   rest of the options of the pool are left at their defaults.
+ *
+ * @signature  int main(int argc,char** argv)
+ *
+ * @param      argc number of command line arguments
+ * @param      argv array of c strings of command line arguments
+ *
+ * @return     status code.
+ */
+int main(int argc,char** argv)
+{
+    // parse command line arguments
+    if (argc != 4)
+    {
+        fprintf(stderr,"usage: %s [coordinator host] [coordinator port] [num workers]\n",argv[0]);
+        return 1;
+    }
+    int numWorkers = atoi(argv[3]);
+    if (numWorkers <= 0)
+    {
+        fprintf(stderr,"usage: %s [coordinator host] [coordinator port] [num workers]\n num workers must be larger than or equal to 1",argv[0]);
+        return 1;
+    }
+
+    // connect to the coordinator
+    addrinfo hints;
+    addrinfo* addresses;
+    memset(&hints,0,sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int error = getaddrinfo(argv[1],argv[2],&hints,&addresses);
+    if (error != 0)
+    {
+        fprintf(stderr,"failed to resolve %s: %s\n",argv[1],gai_strerror(error));
+        return 1;
+    }
+    int fd = -1;
+    for(addrinfo* address = addresses; address != 0 && fd < 0; address = address->ai_next)
+    {
+        fd = socket(address->ai_family,address->ai_socktype,address->ai_protocol);
+        if (fd >= 0 && connect(fd,address->ai_addr,address->ai_addrlen) < 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0)
+    {
+        perror("failed to connect");
+        return 1;
+    }
+
+    signal(SIGPIPE,SIG_IGN);
+    FILE* coordinatorIn = fdopen(fd,"r");
+    FILE* coordinatorOut = fdopen(dup(fd),"w");
+    if (!coordinatorIn || !coordinatorOut)
+    {
+        perror("failed on fdopen");
+        return 1;
+    }
+
+    // introduce the agent, and get the subject and chunk size
+    EngineOptions options;
+    init_options(&options);
+    options.numWorkers = numWorkers;
+    Number message;
+    mpz_set_ui(message.value,numWorkers);
+    if (!mpz_out_raw(coordinatorOut,message.value) ||
+        fflush(coordinatorOut) != 0 ||
+        !mpz_inp_raw(options.prime.value,coordinatorIn) ||
+        !mpz_inp_raw(message.value,coordinatorIn))
+    {
+        perror("failed to greet coordinator");
+        return 1;
+    }
+    options.chunkSize = mpz_get_ui(message.value);
+
+    // start the workers; their results are relayed to the coordinator
+    ResultCollector collector(numWorkers,0);
+    collector.start_relay(coordinatorOut);
+    ThreadTransport transport(&options,&collector);
+    if (!transport.start())
+    {
+        perror("failed to start workers");
+        return 1;
+    }
+
+    // receive chunks, and post them to the workers. the coordinator never
+    // sends more chunks than the agent has room for
+    while(mpz_inp_raw(message.value,coordinatorIn))
+    {
+        transport.post(mpz_get_ui(message.value));
+    }
+
+    // wait for the workers to finish the chunks, and terminate
+    transport.finish();
+
+    // release system resources
+    fclose(coordinatorIn);
+    fclose(coordinatorOut);
+
+    return 0;
+}
@@ -0,0 +1,413 @@
+/**
+ * benchmark of the allocator that GMP uses under the load of the workers.
+ *
+ * usage: ./AllocatorBenchmark [--gmp-arena] [--label name] [--threads list]
+ *   [--tasks n] [--limbs n] [--chunk-size n] [--no-header]
+ *
+ * runs the tasks of a search on 1, 2, 4, 8, 16, 32, and 64 threads, or the
+ *   comma separated counts given with --threads, and prints how fast they went
+ *   as csv, one line per thread count. with --gmp-arena, GMP allocates from
+ *   the arena in GmpArena.h; otherwise from malloc.
+ *
+ * every thread does what a worker of the threads backend does: it takes
+ *   chunks of --chunk-size candidates (1000 by default) off a shared counter,
+ *   finds the factors of a --limbs limb number (4 by default) in them by trial
+ *   division, which allocates a temporary for every candidate, copies the
+ *   factors into new Numbers, and hands them to a shared list. the thread that
+ *   finds the list full deletes every Number in it, so most of them are freed
+ *   by a thread other than the one that allocated them, as they are by the
+ *   collector. --tasks chunks (2000 by default) are searched for each thread
+ *   count.
+ *
+ * malloc is whatever the program is linked, or preloaded with, so other
+ *   allocators are measured by preloading them, and naming the line with
+ *   --label. make allocator-benchmark runs glibc as it is, with a single arena
+ *   for every thread, and without its thread caches, the gmp arena, and
+ *   jemalloc, and tcmalloc if they are installed.
+ *
+ * the output has these columns:
+ *
+ *   allocator,threads,tasks,seconds,tasks_per_second,arena_kib,rss_kib
+ *
+ * @sourceFile AllocatorBenchmark.cpp
+ *
+ * @program    AllocatorBenchmark.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the number is a fixed random number times 720720, so the first chunks have
+ *   plenty of factors. arena_kib is how much of the arena has been carved into
+ *   slabs, and rss_kib the resident set size, both once the line is done;
+ *   neither ever shrinks, so they are cumulative over the lines before them.
+ */
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <vector>
+#include "FindFactorsTask.h"
+#include "GmpArena.h"
+#include "Semaphore.h"
+#include "Number.h"
+#include "Lock.h"
+
+#define USAGE "usage: %s [--gmp-arena] [--label name] [--threads list] [--tasks n] [--limbs n] [--chunk-size n] [--no-header]\n"
+
+#define DEFAULT_THREADS "1,2,4,8,16,32,64"
+#define DEFAULT_TASKS 2000
+#define DEFAULT_LIMBS 4
+#define DEFAULT_CHUNK_SIZE 1000
+#define HANDOFF_SIZE 64
+#define SUBJECT_SEED 8005
+
+/**
+ * what the threads of a line share.
+ */
+struct Run
+{
+    Run();
+    Number subject;
+    unsigned long chunkSize;
+    unsigned long numTasks;
+    unsigned long nextTask;
+    std::vector<Number*> handoff;
+    Semaphore handoffAccess;
+};
+
+int main(int,char**);
+void* worker_routine(void* run);
+double run_line(Run* run,unsigned int numThreads);
+long read_rss_kib();
+
+/**
+ * instantiates a Run instance.
+ *
+ * @class      Run
+ *
+ * @method     Run
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  Run::Run()
+ *
+ * @return     an instance of a Run.
+ */
+Run::Run()
+    :chunkSize(DEFAULT_CHUNK_SIZE)
+    ,numTasks(DEFAULT_TASKS)
+    ,nextTask(0)
+    ,handoffAccess(false,1)
+{
+}
+
+/**
+ * entry point of the program.
+ *
+ * @function   main
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the arena is enabled before the number is made, so everything
+ *   GMP allocates comes from it.
+ *
+ * @signature  int main(int argc,char** argv)
+ *
+ * @param      argc number of command line arguments
+ * @param      argv array of c strings of command line arguments
+ *
+ * @return     status code.
+ */
+int main(int argc,char** argv)
+{
+    // parse command line options
+    static option longOptions[] =
+    {
+        {"gmp-arena",no_argument,0,'a'},
+        {"label",required_argument,0,'l'},
+        {"threads",required_argument,0,'t'},
+        {"tasks",required_argument,0,'n'},
+        {"limbs",required_argument,0,'b'},
+        {"chunk-size",required_argument,0,'z'},
+        {"no-header",no_argument,0,'H'},
+        {0,0,0,0}
+    };
+    bool arena = false;
+    const char* label = 0;
+    const char* threadList = DEFAULT_THREADS;
+    long numTasks = DEFAULT_TASKS;
+    long limbs = DEFAULT_LIMBS;
+    long chunkSize = DEFAULT_CHUNK_SIZE;
+    bool header = true;
+    int opt;
+    while((opt = getopt_long(argc,argv,"",longOptions,0)) != -1)
+    {
+        switch(opt)
+        {
+        case 'a':
+            arena = true;
+            break;
+        case 'l':
+            label = optarg;
+            break;
+        case 't':
+            threadList = optarg;
+            break;
+        case 'n':
+            numTasks = atol(optarg);
+            break;
+        case 'b':
+            limbs = atol(optarg);
+            break;
+        case 'z':
+            chunkSize = atol(optarg);
+            break;
+        case 'H':
+            header = false;
+            break;
+        default:
+            fprintf(stderr,USAGE,argv[0]);
+            return 1;
+        }
+    }
+
+    // parse the thread counts
+    std::vector<unsigned int> threadCounts;
+    for(const char* count = threadList; *count != '\0';)
+    {
+        char* end;
+        long numThreads = strtol(count,&end,10);
+        if (end == count || numThreads <= 0 || (*end != ',' && *end != '\0'))
+        {
+            threadCounts.clear();
+            break;
+        }
+        threadCounts.push_back(numThreads);
+        count = *end == ',' ? end+1 : end;
+    }
+    if (argc-optind != 0 || threadCounts.empty() || numTasks <= 0 || limbs <= 0 || chunkSize <= 0)
+    {
+        fprintf(stderr,USAGE,argv[0]);
+        return 1;
+    }
+
+    if (arena && !gmp_arena_enable())
+    {
+        perror("failed to enable the gmp arena");
+        return 1;
+    }
+    if (label == 0)
+    {
+        label = arena ? "gmp-arena" : "glibc";
+    }
+
+    // make the number
+    Run run;
+    run.numTasks = numTasks;
+    run.chunkSize = chunkSize;
+    gmp_randstate_t random;
+    gmp_randinit_default(random);
+    gmp_randseed_ui(random,SUBJECT_SEED);
+    mpz_urandomb(run.subject.value,random,limbs*GMP_NUMB_BITS);
+    mpz_setbit(run.subject.value,limbs*GMP_NUMB_BITS-1);
+    mpz_mul_ui(run.subject.value,run.subject.value,720720);
+    gmp_randclear(random);
+
+    if (header)
+    {
+        printf("allocator,threads,tasks,seconds,tasks_per_second,arena_kib,rss_kib\n");
+    }
+    for(register unsigned int i = 0; i < threadCounts.size(); ++i)
+    {
+        double seconds = run_line(&run,threadCounts[i]);
+        if (seconds < 0)
+        {
+            perror("failed to start threads");
+            return 1;
+        }
+        printf("%s,%u,%lu,%.6f,%.1f,%lu,%ld\n",label,threadCounts[i],run.numTasks,seconds,
+            run.numTasks/seconds,(unsigned long) gmp_arena_carved()/1024,read_rss_kib());
+        fflush(stdout);
+    }
+    return 0;
+}
+
+/**
+ * runs every task on a number of threads.
+ *
+ * @function   run_line
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the Numbers left in the hand off list are deleted once the
+ *   threads are done, inside the time.
+ *
+ * @signature  double run_line(Run* run,unsigned int numThreads)
+ *
+ * @param      run what the threads share.
+ * @param      numThreads number of threads to run the tasks on.
+ *
+ * @return     seconds it took, or -1 if the threads could not be created.
+ */
+double run_line(Run* run,unsigned int numThreads)
+{
+    timespec start;
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC,&start);
+
+    run->nextTask = 0;
+    std::vector<pthread_t> threads(numThreads);
+    for(register unsigned int i = 0; i < numThreads; ++i)
+    {
+        if (pthread_create(&threads[i],0,worker_routine,run) != 0)
+        {
+            return -1;
+        }
+    }
+    for(register unsigned int i = 0; i < numThreads; ++i)
+    {
+        pthread_join(threads[i],0);
+    }
+    for(register unsigned int i = 0; i < run->handoff.size(); ++i)
+    {
+        delete run->handoff[i];
+    }
+    run->handoff.clear();
+
+    clock_gettime(CLOCK_MONOTONIC,&end);
+    return (end.tv_sec-start.tv_sec)+(end.tv_nsec-start.tv_nsec)/1e9;
+}
+
+/**
+ * routine executed by the threads; searches chunks until there are none
+ *   left.
+ *
+ * @function   worker_routine
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       see the top of this file for what a task does.
+ *
+ * @signature  void* worker_routine(void* run)
+ *
+ * @param      run pointer to what the threads share.
+ */
+void* worker_routine(void* run)
+{
+    Run* self = (Run*) run;
+    unsigned long task;
+    while((task = __sync_fetch_and_add(&self->nextTask,1)) < self->numTasks)
+    {
+        Number loBound;
+        Number hiBound;
+        mpz_set_ui(loBound.value,task*self->chunkSize+1);
+        mpz_set_ui(hiBound.value,(task+1)*self->chunkSize);
+
+        std::vector<Number*> factors;
+        {
+            FindFactorsTask findFactors(self->subject.value,hiBound.value,loBound.value);
+            findFactors.set_kernel(KERNEL_TRIAL_DIVISION);
+            findFactors.execute();
+            std::vector<mpz_t*>* results = findFactors.get_results();
+            for(register unsigned int i = 0; i < results->size(); ++i)
+            {
+                Number* factor = new Number();
+                mpz_set(factor->value,*results->at(i));
+                factors.push_back(factor);
+            }
+        }
+
+        // hand the factors off; whoever fills the list deletes all of them
+        std::vector<Number*> full;
+        {
+            Lock scopelock(&self->handoffAccess.sem);
+            self->handoff.insert(self->handoff.end(),factors.begin(),factors.end());
+            if (self->handoff.size() >= HANDOFF_SIZE)
+            {
+                full.swap(self->handoff);
+            }
+        }
+        for(register unsigned int i = 0; i < full.size(); ++i)
+        {
+            delete full[i];
+        }
+        gmp_arena_task_done();
+    }
+    gmp_arena_thread_done();
+    return 0;
+}
+
+/**
+ * returns the resident set size of the program.
+ *
+ * @function   read_rss_kib
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  long read_rss_kib()
+ *
+ * @return     resident set size in KiB, or 0 if it could not be read.
+ */
+long read_rss_kib()
+{
+    FILE* status = fopen("/proc/self/status","r");
+    if (status == 0)
+    {
+        return 0;
+    }
+    char line[256];
+    long kib = 0;
+    while(fgets(line,sizeof(line),status) != 0)
+    {
+        if (strncmp(line,"VmRSS:",6) == 0)
+        {
+            sscanf(line+6,"%ld",&kib);
+            break;
+        }
+    }
+    fclose(status);
+    return kib;
+}
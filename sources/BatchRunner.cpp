@@ -0,0 +1,577 @@
+/**
+ * implementation of the BatchRunner class declared in BatchRunner.h
+ *
+ * @sourceFile BatchRunner.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out
+ *
+ * @class      BatchRunner
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the output of each number looks like this:
+ *
+ *   factors of 12: 1, 2, 3, 4, 6, 12
+ *   runtime of 12: 0ms
+ *
+ * the runtime of a number is measured from when its first chunk is scheduled
+ *   to when its last chunk is completed. lines that are not integers above 0,
+ *   or whose priority is not valid are reported as invalid in their place in
+ *   the output; a line with a bad priority is reported with the range the
+ *   priority must be in. BATCH_SHARE_UNIT is divisible by every priority, so
+ *   the virtual times are exact.
+ */
+#include "BatchRunner.h"
+#include <map>
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Lock.h"
+#include "Contention.h"
+
+/**
+ * instantiates a BatchJob instance.
+ *
+ * @class      BatchJob
+ *
+ * @method     BatchJob
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the job has no collector, or factorization until its line is
+ *   parsed.
+ *
+ * @signature  BatchJob::BatchJob()
+ *
+ * @return     an instance of a BatchJob.
+ */
+BatchJob::BatchJob()
+    :job(0)
+    ,factorization(0)
+    ,valid(false)
+    ,cached(false)
+    ,priority(1)
+    ,virtualFinish(0)
+    ,numChunks(0)
+    ,nextChunk(0)
+    ,startTime(0)
+{
+}
+
+/**
+ * destructor for the BatchJob. deletes the collector, and factorization of the
+ *   job.
+ *
+ * @class      BatchJob
+ *
+ * @method     ~BatchJob
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  BatchJob::~BatchJob()
+ */
+BatchJob::~BatchJob()
+{
+    delete job.collector;
+    delete factorization;
+}
+
+/**
+ * instantiates a BatchRunner instance.
+ *
+ * @class      BatchRunner
+ *
+ * @method     BatchRunner
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       nothing is read until run is called.
+ *
+ * @signature  BatchRunner::BatchRunner(EngineOptions* _options)
+ *
+ * @param      _options options of the run; batchPath is the file to read the
+ *   numbers from, or - for stdin.
+ *
+ * @return     an instance of a BatchRunner.
+ */
+BatchRunner::BatchRunner(EngineOptions* _options)
+    :options(_options)
+    ,in(0)
+    ,writer(0)
+    ,transport(_options,0)
+    ,useCache(false)
+    ,parsedAccess(false,1)
+    ,parsedSem(false,0)
+    ,orderedAccess(false,1)
+    ,orderedSem(false,0)
+    ,inFlightSem(false,MAX_BATCH_JOBS_IN_FLIGHT)
+{
+    contention_name(&parsedAccess.sem,"parsedAccess");
+    contention_name(&parsedSem.sem,"parsedSem");
+    contention_name(&orderedAccess.sem,"orderedAccess");
+    contention_name(&orderedSem.sem,"orderedSem");
+    contention_name(&inFlightSem.sem,"inFlightSem");
+}
+
+/**
+ * finds the factors of every number in the batch file, and prints them.
+ *
+ * @class      BatchRunner
+ *
+ * @method     run
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       starts the workers, the parser, and the printer, schedules the
+ *   chunks of the jobs on the calling thread until the whole file is parsed,
+ *   then waits for everything to terminate, and prints the total runtime.
+ *   with --metrics, the metrics of the workers are dumped once they are done,
+ *   and with --trace, their timeline is written. with --footprint, the memory
+ *   the run took up is printed last.
+ *
+ * @signature  int BatchRunner::run()
+ *
+ * @return     status code.
+ */
+int BatchRunner::run()
+{
+    // open the batch file
+    in = strcmp(options->batchPath,"-") == 0 ? stdin : fopen(options->batchPath,"r");
+    if (in == 0)
+    {
+        fprintf(stderr,"failed to open %s: ",options->batchPath);
+        perror(0);
+        return 1;
+    }
+
+    useCache = open_cache(options,&cache);
+
+    // everything printed to stdout, and the log file from here on goes
+    // through the writer
+    fflush(stdout);
+    fflush(options->logFileOut);
+    TeeWriter teeWriter(fileno(stdout),fileno(options->logFileOut));
+    writer = &teeWriter;
+
+    // get start time
+    long startTime = current_timestamp();
+
+    // create the workers, and the parsing, and output stages
+    if (!transport.start())
+    {
+        perror("failed to start workers");
+        return 1;
+    }
+    pthread_t parser;
+    pthread_t printer;
+    int error = pthread_create(&parser,0,parser_routine,this);
+    if (error == 0)
+    {
+        error = pthread_create(&printer,0,printer_routine,this);
+    }
+    if (error != 0)
+    {
+        errno = error;
+        perror("failed to start batch stages");
+        return 1;
+    }
+
+    schedule();
+
+    // wait for the remaining jobs to be printed
+    pthread_join(parser,0);
+    pthread_join(printer,0);
+    transport.finish();
+    if (options->metricsPath != 0 && !transport.get_metrics()->dump(options->metricsPath))
+    {
+        perror("failed to dump metrics");
+    }
+    if (options->tracePath != 0 && !transport.get_timeline()->write(options->tracePath))
+    {
+        perror("failed to write trace");
+    }
+    if (options->footprint)
+    {
+        print_footprint(stdout,options->logFileOut,0);
+    }
+    if (in != stdin)
+    {
+        fclose(in);
+    }
+
+    // get end time
+    long endTime = current_timestamp();
+
+    char line[64];
+    snprintf(line,sizeof(line),"total runtime: %lums\n",endTime-startTime);
+    writer->append(line);
+    writer->flush();
+
+    return 0;
+}
+
+/**
+ * routine executed by the parser thread.
+ *
+ * @class      BatchRunner
+ *
+ * @method     parser_routine
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * reads the batch file a line at a time, and creates a job for every line
+ *   that is not blank. the priority is split off of the number first. each job is passed to both the scheduler, and the
+ *   printer. waits while MAX_BATCH_JOBS_IN_FLIGHT jobs are not printed yet.
+ *   jobs whose number is in the cache, or is factored by the pre-analysis are
+ *   given its factors, and no chunks. otherwise the whole range of the number
+ *   is searched.
+ *
+ * at the end of the file, 0 is passed to both of them, so they know there are
+ *   no more jobs.
+ *
+ * @signature  void* BatchRunner::parser_routine(void* runner)
+ *
+ * @param      runner pointer to the BatchRunner.
+ */
+void* BatchRunner::parser_routine(void* runner)
+{
+    BatchRunner* self = (BatchRunner*) runner;
+
+    char* line = 0;
+    size_t capacity = 0;
+    ssize_t length;
+    while(true)
+    {
+        BatchJob* job = 0;
+        length = getline(&line,&capacity,self->in);
+        if (length != -1)
+        {
+            // strip the line ending, and skip blank lines
+            while(length > 0 && isspace(line[length-1]))
+            {
+                line[--length] = '\0';
+            }
+            if (length == 0)
+            {
+                continue;
+            }
+
+            self->inFlightSem.wait();
+            job = new BatchJob();
+            job->line = line;
+
+            // split the priority off of the number
+            char* priority = line;
+            while(*priority != '\0' && !isspace(*priority))
+            {
+                ++priority;
+            }
+            if (*priority != '\0')
+            {
+                *priority++ = '\0';
+                char* end;
+                job->priority = strtoul(priority,&end,10);
+                if (end == priority || *end != '\0' ||
+                    job->priority < 1 || job->priority > MAX_BATCH_PRIORITY)
+                {
+                    job->priority = 0;
+                }
+            }
+            job->valid = job->priority != 0 &&
+                mpz_set_str(job->job.subject.value,line,10) == 0 &&
+                mpz_sgn(job->job.subject.value) > 0;
+            if (job->valid)
+            {
+                job->job.collector = new ResultCollector(self->options->numWorkers,self->options->memoryBudget);
+                job->factorization = new Factorization(job->job.subject.value);
+                job->cached = self->useCache &&
+                    self->cache.lookup(job->job.subject.value,job->factorization);
+                if (job->cached || (self->options->analyze && job->factorization->pre_analyze()))
+                {
+                    collect_divisors(self->options,job->factorization,job->job.collector);
+                }
+                else
+                {
+                    job->job.collector->set_factorization(job->factorization);
+                    job->numChunks = count_chunks(job->job.subject.value,self->options->chunkSize);
+                }
+                job->job.chunksLeft = job->numChunks;
+            }
+        }
+
+        {
+            Lock scopelock(&self->orderedAccess.sem);
+            self->orderedJobs.push_back(job);
+        }
+        self->orderedSem.post();
+        {
+            Lock scopelock(&self->parsedAccess.sem);
+            self->parsedJobs.push_back(job);
+        }
+        self->parsedSem.post();
+
+        if (job == 0)
+        {
+            break;
+        }
+    }
+    free(line);
+
+    return 0;
+}
+
+/**
+ * routine executed by the printer thread.
+ *
+ * @class      BatchRunner
+ *
+ * @method     printer_routine
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       takes the jobs in the order they were parsed, waits for each of
+ *   them to be done, prints it, adds it to the cache, and deletes it.
+ *   terminates once it takes 0.
+ *
+ * @signature  void* BatchRunner::printer_routine(void* runner)
+ *
+ * @param      runner pointer to the BatchRunner.
+ */
+void* BatchRunner::printer_routine(void* runner)
+{
+    BatchRunner* self = (BatchRunner*) runner;
+
+    while(true)
+    {
+        BatchJob* job;
+        self->orderedSem.wait();
+        {
+            Lock scopelock(&self->orderedAccess.sem);
+            job = self->orderedJobs.front();
+            self->orderedJobs.pop_front();
+        }
+        if (job == 0)
+        {
+            break;
+        }
+
+        job->job.doneSem.wait();
+        self->print_job(job);
+        if (self->useCache && job->valid && !job->cached && job->factorization->is_complete() &&
+            !self->cache.store(job->job.subject.value,job->factorization))
+        {
+            perror("failed to add the factorization to the cache");
+        }
+        delete job;
+        self->inFlightSem.post();
+    }
+
+    return 0;
+}
+
+/**
+ * posts the chunks of the parsed jobs to the workers until every job is
+ *   scheduled.
+ *
+ * @class      BatchRunner
+ *
+ * @method     schedule
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * posts the chunks of the jobs that still have chunks left in turns, picking
+ *   up newly parsed jobs between turns. blocks for the next parsed job only
+ *   when there is nothing to post. a turn posts as many chunks as there are
+ *   active jobs, each taken from the job with the earliest virtual finish
+ *   time; see BatchRunner.h. jobs with the same finish time are served in the
+ *   order they came in, so jobs of the same priority that were parsed
+ *   together move through their chunks together, and the chunk of all the
+ *   jobs at the same chunk is posted as a single task.
+ *
+ * a job is taken out of the queue before its last chunk is posted, because the
+ *   printer may delete it as soon as that chunk is completed. jobs without
+ *   chunks are done right away.
+ *
+ * @signature  void BatchRunner::schedule()
+ */
+void BatchRunner::schedule()
+{
+    std::multimap<unsigned long,BatchJob*> activeJobs;
+    unsigned long virtualTime = 0;
+    bool parsing = true;
+    while(parsing || !activeJobs.empty())
+    {
+        // take the newly parsed jobs
+        while(parsing)
+        {
+            if (activeJobs.empty())
+            {
+                parsedSem.wait();
+            }
+            else if (sem_trywait(&parsedSem.sem) != 0)
+            {
+                break;
+            }
+
+            BatchJob* job;
+            {
+                Lock scopelock(&parsedAccess.sem);
+                job = parsedJobs.front();
+                parsedJobs.pop_front();
+            }
+            if (job == 0)
+            {
+                parsing = false;
+                break;
+            }
+
+            job->startTime = current_timestamp();
+            if (job->numChunks == 0)
+            {
+                job->job.endTime = job->startTime;
+                job->job.doneSem.post();
+            }
+            else
+            {
+                job->virtualFinish = virtualTime+BATCH_SHARE_UNIT/job->priority;
+                activeJobs.insert(std::make_pair(job->virtualFinish,job));
+            }
+        }
+
+        // post a chunk for every active job, taking each one from the job
+        // with the earliest virtual finish time. jobs at the same chunk share
+        // a task, so their factors are found together
+        std::map<unsigned long,std::vector<Job*> > turn;
+        for(size_t picks = activeJobs.size(); picks > 0; --picks)
+        {
+            BatchJob* job = activeJobs.begin()->second;
+            virtualTime = activeJobs.begin()->first;
+            activeJobs.erase(activeJobs.begin());
+            turn[job->nextChunk++].push_back(&job->job);
+            if (job->nextChunk != job->numChunks)
+            {
+                job->virtualFinish += BATCH_SHARE_UNIT/job->priority;
+                activeJobs.insert(std::make_pair(job->virtualFinish,job));
+            }
+        }
+        std::map<unsigned long,std::vector<Job*> >::iterator chunk;
+        for(chunk = turn.begin(); chunk != turn.end(); ++chunk)
+        {
+            transport.post(&chunk->second,chunk->first);
+        }
+    }
+}
+
+/**
+ * prints the factors of a job, and its runtime to stdout, and the log file.
+ *
+ * @class      BatchRunner
+ *
+ * @method     print_job
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the job must be done.
+ *
+ * @signature  void BatchRunner::print_job(BatchJob* job)
+ *
+ * @param      job job to print.
+ */
+void BatchRunner::print_job(BatchJob* job)
+{
+    if (job->priority == 0)
+    {
+        char bounds[64];
+        snprintf(bounds,sizeof(bounds)," (priority must be from 1 to %d)\n",MAX_BATCH_PRIORITY);
+        writer->append("invalid priority: ");
+        writer->append(job->line.c_str());
+        writer->append(bounds);
+        writer->flush();
+        return;
+    }
+    if (!job->valid)
+    {
+        writer->append("invalid integer: ");
+        writer->append(job->line.c_str());
+        writer->append("\n");
+        writer->flush();
+        return;
+    }
+
+    job->job.collector->finish();
+    writer->append("factors of ");
+    writer->append_number(job->job.subject.value);
+    writer->append(": ");
+    append_factors(job->job.collector,writer);
+    writer->append("\n");
+
+    char line[64];
+    snprintf(line,sizeof(line),": %lums\n",job->job.endTime-job->startTime);
+    writer->append("runtime of ");
+    writer->append_number(job->job.subject.value);
+    writer->append(line);
+    writer->flush();
+}
@@ -0,0 +1,111 @@
+/**
+ * header file for the BatchRunner class. implementation is in BatchRunner.cpp
+ *
+ * @sourceFile BatchRunner.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * finds the factors of every number in a batch file, one number per line,
+ *   using a single pool of worker threads for all of them. the work is split
+ *   into three stages that run at the same time:
+ *
+ *   parsing: a thread reads, and parses the numbers, and creates a job for
+ *     each of them. at most MAX_BATCH_JOBS_IN_FLIGHT jobs exist at a time, so
+ *     a long batch file is not read into memory all at once.
+ *   scheduling: the calling thread posts the chunks of every parsed job to
+ *     the worker pool by weighted fair queuing, so small numbers are not
+ *     stuck behind the chunks of large ones, and each job gets a share of the
+ *     pool in proportion to its priority.
+ *   output: a thread waits for the jobs in input order, and prints the
+ *     factors of each one, and how long it took, as soon as it and every job
+ *     before it is done.
+ *
+ * a line may hold a priority after the number, from 1 to MAX_BATCH_PRIORITY;
+ *   1 if it is left out. while jobs compete for the pool, a job of priority p
+ *   gets p chunks posted for every one posted for a job of priority 1. each
+ *   job has a virtual finish time, which goes up by BATCH_SHARE_UNIT/p for
+ *   every chunk of it that is posted, and the job with the earliest one is
+ *   served next. a new job starts at the virtual time of the job served last,
+ *   so it neither waits for, nor makes up for the chunks posted before it
+ *   came.
+ *
+ * with --cache, the parser looks every number up in the cache file; numbers
+ *   that are found get no chunks, and are done right away. the printer adds
+ *   the numbers that were not found to the cache after printing them. the
+ *   same goes for numbers that are factored by the pre-analysis.
+ */
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <deque>
+#include <string>
+#include <stdio.h>
+#include <pthread.h>
+#include "Engine.h"
+#include "Semaphore.h"
+#include "TeeWriter.h"
+#include "ThreadTransport.h"
+
+#define MAX_BATCH_JOBS_IN_FLIGHT 64
+#define MAX_BATCH_PRIORITY 16
+#define BATCH_SHARE_UNIT 720720
+
+/**
+ * a line of the batch file, and the job created for it.
+ */
+struct BatchJob
+{
+    BatchJob();
+    ~BatchJob();
+    Job job;
+    Factorization* factorization;
+    std::string line;
+    bool valid;
+    bool cached;
+    unsigned long priority;
+    unsigned long virtualFinish;
+    unsigned long numChunks;
+    unsigned long nextChunk;
+    long startTime;
+};
+
+class BatchRunner
+{
+public:
+
+    BatchRunner(EngineOptions* _options);
+    int run();
+
+private:
+
+    static void* parser_routine(void* runner);
+    static void* printer_routine(void* runner);
+    void schedule();
+    void print_job(BatchJob* job);
+
+    EngineOptions* options;
+    FILE* in;
+    TeeWriter* writer;
+    ThreadTransport transport;
+    FactorCache cache;
+    bool useCache;
+    std::deque<BatchJob*> parsedJobs;
+    std::deque<BatchJob*> orderedJobs;
+    Semaphore parsedAccess;
+    Semaphore parsedSem;
+    Semaphore orderedAccess;
+    Semaphore orderedSem;
+    Semaphore inFlightSem;
+};
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * contains a main function that uses the BatchRunner class. meant to be run
+ *   with debugging tools to make sure there are no memory leaks and other
+ *   problems.
+ *
+ * @sourceFile BatchRunnerTest.cpp
+ *
+ * @program    BatchRunnerTest.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ */
+#include <stdio.h>
+#include <string>
+#include "Engine.h"
+#include "BatchRunner.h"
+
+/**
+ * lines of the batch file, and what is expected to be printed for each.
+ */
+static const char* batchLines[][2] =
+{
+    {"12","factors of 12: 1, 2, 3, 4, 6, 12"},
+    {"0","invalid integer: 0"},
+    {"-5","invalid integer: -5"},
+    {"abc","invalid integer: abc"},
+    {"12 17","invalid priority: 12 17 (priority must be from 1 to 16)"},
+    {"7 2","factors of 7: 1, 7"},
+};
+
+/**
+ * uses the BatchRunner class, and checks that each line of the batch file
+ *   gets the expected output in the log file. this program is meant to be run
+ *   with debugging tools like valgrind to verify that there are no memory
+ *   leaks and other issues.
+ *
+ * @function   main
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       prints each expected line with whether it was found, and fails
+ *   if any was not.
+ *
+ * @signature  int main()
+ *
+ * @return     exit status.
+ */
+int main()
+{
+    const unsigned int numLines = sizeof(batchLines)/sizeof(*batchLines);
+
+    // write the batch file
+    FILE* batch = fopen("BatchRunnerTest.txt","w");
+    if (!batch)
+    {
+        perror("failed to create BatchRunnerTest.txt");
+        return 1;
+    }
+    for(register unsigned int i = 0; i < numLines; ++i)
+    {
+        fprintf(batch,"%s\n",batchLines[i][0]);
+    }
+    fclose(batch);
+
+    // do test stuff... run the batch, logging to BatchRunnerTest.log
+    EngineOptions options;
+    init_options(&options);
+    options.batchPath = "BatchRunnerTest.txt";
+    options.numWorkers = 2;
+    options.logFileOut = fopen("BatchRunnerTest.log","w+");
+    if (!options.logFileOut)
+    {
+        perror("failed to create BatchRunnerTest.log");
+        return 1;
+    }
+    {
+        BatchRunner runner(&options);
+        runner.run();
+    }
+
+    // read back the log
+    std::string log;
+    char buffer[256];
+    rewind(options.logFileOut);
+    while(fgets(buffer,sizeof(buffer),options.logFileOut))
+    {
+        log += buffer;
+    }
+    fclose(options.logFileOut);
+
+    // print the results
+    bool passed = true;
+    for(register unsigned int i = 0; i < numLines; ++i)
+    {
+        std::string expected = std::string(batchLines[i][1])+"\n";
+        bool found = log.find(expected) != std::string::npos;
+        printf("%s: %s\n",batchLines[i][1],found ? "found" : "MISSING");
+        passed = passed && found;
+    }
+
+    remove("BatchRunnerTest.txt");
+    remove("BatchRunnerTest.log");
+
+    return passed ? 0 : 1;
+}
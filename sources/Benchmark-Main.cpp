@@ -0,0 +1,512 @@
+/**
+ * the scaling benchmark of the threads, and processes backends.
+ *
+ * usage: ./Benchmark-Main [--repeats n] [--span n] [--baseline file]
+ *   [--tolerance percent] [--program file] [csv file]
+ *
+ * runs the program (./Factors-Main.out by default) over every combination of
+ *   backend, number of workers, chunk size, and subject, and writes the
+ *   results to the csv file, one line per combination.
+ *
+ * the subjects are 1, 2, and 4 limbs long, and each of them is a prime, a
+ *   semiprime, or highly composite. the whole range of such numbers cannot be
+ *   searched, so only the candidates from 1 to the span (1000000 by default)
+ *   are, using --range. --no-analysis is passed, so the search is always run.
+ *
+ * each combination is run --repeats times (5 by default). its line holds the
+ *   median, and 95th percentile of the wall time, the median cpu time of the
+ *   program, and its workers, and the speedup, and efficiency over a single
+ *   worker of the same backend, chunk size, and subject.
+ *
+ * with --baseline, the medians are compared to the ones in a csv file written
+ *   by an earlier run. a combination whose median is slower than the baseline
+ *   by more than the tolerance (10 percent by default) is flagged as a
+ *   regression, and the benchmark exits with status 1.
+ *
+ * @sourceFile Benchmark-Main.cpp
+ *
+ * @program    Benchmark-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the program is run as a child process with its output thrown away, and its
+ *   cpu time is taken from wait4, which includes the worker processes that it
+ *   waited for. the percentile is the nearest rank.
+ *
+ * the csv file has these columns:
+ *
+ *   backend,workers,chunk_size,limbs,kind,repeats,median_ms,p95_ms,cpu_ms,
+ *   speedup,efficiency,baseline_ms,regression
+ */
+#include <map>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <algorithm>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "Number.h"
+
+#define USAGE "usage: %s [--repeats n] [--span n] [--baseline file] [--tolerance percent] [--program file] [csv file]\n"
+
+#define DEFAULT_PROGRAM "./Factors-Main.out"
+#define DEFAULT_REPEATS 5
+#define DEFAULT_SPAN 1000000
+#define DEFAULT_TOLERANCE 10
+
+/**
+ * a number whose factors are searched for by the benchmark.
+ */
+struct Subject
+{
+    Number value;
+    unsigned long limbs;
+    const char* kind;
+};
+
+/**
+ * the measurements of a combination.
+ */
+struct Measurement
+{
+    double medianMs;
+    double p95Ms;
+    double cpuMs;
+};
+
+int main(int,char**);
+void make_subjects(std::vector<Subject*>* subjects);
+bool run_once(const char* program,const char* backend,unsigned int workers,unsigned long chunkSize,unsigned long span,Subject* subject,double* wallMs,double* cpuMs);
+bool load_baseline(const char* path,std::map<std::string,double>* baseline);
+std::string make_key(const char* backend,unsigned int workers,unsigned long chunkSize,unsigned long limbs,const char* kind);
+
+/**
+ * entry point of the program.
+ *
+ * @function   main
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the number of workers goes up in powers of 2 to the number of online cpus,
+ *   which is always included. the single worker run of each backend, chunk
+ *   size, and subject comes first, so the speedups of the others can be
+ *   worked out from it.
+ *
+ * @signature  int main(int argc,char** argv)
+ *
+ * @param      argc number of command line arguments
+ * @param      argv array of c strings of command line arguments
+ *
+ * @return     status code.
+ */
+int main(int argc,char** argv)
+{
+    // parse command line options
+    static option longOptions[] =
+    {
+        {"repeats",required_argument,0,'r'},
+        {"span",required_argument,0,'s'},
+        {"baseline",required_argument,0,'B'},
+        {"tolerance",required_argument,0,'t'},
+        {"program",required_argument,0,'p'},
+        {0,0,0,0}
+    };
+    const char* program = DEFAULT_PROGRAM;
+    const char* baselinePath = 0;
+    int repeats = DEFAULT_REPEATS;
+    long span = DEFAULT_SPAN;
+    double tolerance = DEFAULT_TOLERANCE;
+    int opt;
+    while((opt = getopt_long(argc,argv,"",longOptions,0)) != -1)
+    {
+        switch(opt)
+        {
+        case 'r':
+            repeats = atoi(optarg);
+            break;
+        case 's':
+            span = atol(optarg);
+            break;
+        case 'B':
+            baselinePath = optarg;
+            break;
+        case 't':
+            tolerance = atof(optarg);
+            break;
+        case 'p':
+            program = optarg;
+            break;
+        default:
+            fprintf(stderr,USAGE,argv[0]);
+            return 1;
+        }
+    }
+    if (argc-optind != 1 || repeats <= 0 || span <= 0 || tolerance < 0)
+    {
+        fprintf(stderr,USAGE,argv[0]);
+        return 1;
+    }
+
+    std::map<std::string,double> baseline;
+    if (baselinePath != 0 && !load_baseline(baselinePath,&baseline))
+    {
+        fprintf(stderr,"failed to read %s: ",baselinePath);
+        perror(0);
+        return 1;
+    }
+    FILE* out = fopen(argv[optind],"w");
+    if (out == 0)
+    {
+        fprintf(stderr,"failed to create %s: ",argv[optind]);
+        perror(0);
+        return 1;
+    }
+    fprintf(out,"backend,workers,chunk_size,limbs,kind,repeats,median_ms,p95_ms,cpu_ms,speedup,efficiency,baseline_ms,regression\n");
+
+    // the dimensions of the sweep
+    const char* backends[] = {"threads","processes"};
+    unsigned long chunkSizes[] = {1000,10000,100000};
+    std::vector<unsigned int> workerCounts;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for(unsigned int i = 1; (long) i < cpus; i *= 2)
+    {
+        workerCounts.push_back(i);
+    }
+    workerCounts.push_back(cpus > 0 ? cpus : 1);
+    std::vector<Subject*> subjects;
+    make_subjects(&subjects);
+
+    unsigned int regressions = 0;
+    int status = 0;
+    for(register unsigned int s = 0; s < subjects.size() && status == 0; ++s)
+    {
+        for(register unsigned int b = 0; b < sizeof(backends)/sizeof(*backends) && status == 0; ++b)
+        {
+            for(register unsigned int c = 0; c < sizeof(chunkSizes)/sizeof(*chunkSizes) && status == 0; ++c)
+            {
+                double singleMs = 0;
+                for(register unsigned int w = 0; w < workerCounts.size() && status == 0; ++w)
+                {
+                    // run the combination, and sort its runs
+                    std::vector<double> wallTimes;
+                    std::vector<double> cpuTimes;
+                    for(register int i = 0; i < repeats; ++i)
+                    {
+                        double wallMs;
+                        double cpuMs;
+                        if (!run_once(program,backends[b],workerCounts[w],chunkSizes[c],span,subjects[s],&wallMs,&cpuMs))
+                        {
+                            fprintf(stderr,"failed to run %s\n",program);
+                            status = 1;
+                            break;
+                        }
+                        wallTimes.push_back(wallMs);
+                        cpuTimes.push_back(cpuMs);
+                    }
+                    if (status != 0)
+                    {
+                        break;
+                    }
+                    std::sort(wallTimes.begin(),wallTimes.end());
+                    std::sort(cpuTimes.begin(),cpuTimes.end());
+                    Measurement measurement;
+                    measurement.medianMs = wallTimes[wallTimes.size()/2];
+                    measurement.p95Ms = wallTimes[(wallTimes.size()*95+99)/100-1];
+                    measurement.cpuMs = cpuTimes[cpuTimes.size()/2];
+                    if (w == 0)
+                    {
+                        singleMs = measurement.medianMs;
+                    }
+                    double speedup = singleMs/measurement.medianMs;
+
+                    // compare it to the baseline
+                    std::string key = make_key(backends[b],workerCounts[w],chunkSizes[c],subjects[s]->limbs,subjects[s]->kind);
+                    std::map<std::string,double>::iterator base = baseline.find(key);
+                    bool regressed = base != baseline.end() &&
+                        measurement.medianMs > base->second*(1+tolerance/100);
+                    char baseMs[32] = "";
+                    if (base != baseline.end())
+                    {
+                        snprintf(baseMs,sizeof(baseMs),"%.3f",base->second);
+                    }
+                    if (regressed)
+                    {
+                        ++regressions;
+                        fprintf(stderr,"regression: %s %.3fms, baseline %.3fms\n",key.c_str(),measurement.medianMs,base->second);
+                    }
+
+                    fprintf(out,"%s,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%s,%s\n",key.c_str(),repeats,
+                        measurement.medianMs,measurement.p95Ms,measurement.cpuMs,
+                        speedup,speedup/workerCounts[w],baseMs,regressed ? "yes" : "no");
+                    fflush(out);
+                    fprintf(stderr,"%s: %.3fms\n",key.c_str(),measurement.medianMs);
+                }
+            }
+        }
+    }
+
+    fclose(out);
+    for(register unsigned int i = 0; i < subjects.size(); ++i)
+    {
+        delete subjects[i];
+    }
+    if (status == 0 && regressions != 0)
+    {
+        fprintf(stderr,"%u regressions against %s\n",regressions,baselinePath);
+        status = 1;
+    }
+    return status;
+}
+
+/**
+ * makes a prime, a semiprime, and a highly composite subject of each size.
+ *
+ * @function   make_subjects
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * for a size of n bits, the prime is the first one above 2^(n-1), the
+ *   semiprime is the product of the first two primes above 2^(n/2-1), and the
+ *   highly composite number is the largest lcm(1..k) below 2^n. the subjects
+ *   are deleted by the caller.
+ *
+ * @signature  void make_subjects(std::vector<Subject*>* subjects)
+ *
+ * @param      subjects vector to append the subjects to.
+ */
+void make_subjects(std::vector<Subject*>* subjects)
+{
+    unsigned long sizes[] = {1,2,4};
+    for(register unsigned int i = 0; i < sizeof(sizes)/sizeof(*sizes); ++i)
+    {
+        unsigned long bits = sizes[i]*GMP_NUMB_BITS;
+        Number bound;
+        Number factor;
+
+        Subject* prime = new Subject();
+        mpz_ui_pow_ui(bound.value,2,bits-1);
+        mpz_nextprime(prime->value.value,bound.value);
+        prime->kind = "prime";
+
+        Subject* semiprime = new Subject();
+        mpz_ui_pow_ui(bound.value,2,bits/2-1);
+        mpz_nextprime(factor.value,bound.value);
+        mpz_nextprime(semiprime->value.value,factor.value);
+        mpz_mul(semiprime->value.value,semiprime->value.value,factor.value);
+        semiprime->kind = "semiprime";
+
+        Subject* composite = new Subject();
+        mpz_ui_pow_ui(bound.value,2,bits);
+        mpz_set_ui(composite->value.value,1);
+        for(register unsigned long k = 2; ; ++k)
+        {
+            mpz_lcm_ui(factor.value,composite->value.value,k);
+            if (mpz_cmp(factor.value,bound.value) >= 0)
+            {
+                break;
+            }
+            mpz_set(composite->value.value,factor.value);
+        }
+        composite->kind = "composite";
+
+        Subject* made[] = {prime,semiprime,composite};
+        for(register unsigned int j = 0; j < sizeof(made)/sizeof(*made); ++j)
+        {
+            made[j]->limbs = mpz_size(made[j]->value.value);
+            subjects->push_back(made[j]);
+        }
+    }
+}
+
+/**
+ * runs the program once, and measures its wall, and cpu time.
+ *
+ * @function   run_once
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the output of the program goes to /dev/null, and so does its
+ *   log file.
+ *
+ * @signature  bool run_once(const char* program,const char* backend,
+ *   unsigned int workers,unsigned long chunkSize,unsigned long span,
+ *   Subject* subject,double* wallMs,double* cpuMs)
+ *
+ * @param      program path to the program to run.
+ * @param      backend backend passed to -b.
+ * @param      workers number of workers.
+ * @param      chunkSize chunk size passed to --chunk-size.
+ * @param      span end of the range that is searched.
+ * @param      subject number whose factors are searched for.
+ * @param      wallMs set to the wall time of the run in milliseconds.
+ * @param      cpuMs set to the cpu time of the run in milliseconds.
+ *
+ * @return     true if the program ran, and exited with status 0; false
+ *   otherwise.
+ */
+bool run_once(const char* program,const char* backend,unsigned int workers,unsigned long chunkSize,unsigned long span,Subject* subject,double* wallMs,double* cpuMs)
+{
+    char workersArg[32];
+    char chunkSizeArg[32];
+    char spanArg[32];
+    snprintf(workersArg,sizeof(workersArg),"%u",workers);
+    snprintf(chunkSizeArg,sizeof(chunkSizeArg),"%lu",chunkSize);
+    snprintf(spanArg,sizeof(spanArg),"%lu",span);
+    char* subjectArg = mpz_get_str(0,10,subject->value.value);
+
+    timespec start;
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC,&start);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        int devNull = open("/dev/null",O_WRONLY);
+        dup2(devNull,STDOUT_FILENO);
+        dup2(devNull,STDERR_FILENO);
+        execl(program,program,"-b",backend,"--no-analysis","--chunk-size",chunkSizeArg,
+            "--range","1",spanArg,subjectArg,"/dev/null",workersArg,(char*) 0);
+        _exit(127);
+    }
+    free(subjectArg);
+    if (pid < 0)
+    {
+        return false;
+    }
+
+    int status;
+    rusage usage;
+    if (wait4(pid,&status,0,&usage) != pid)
+    {
+        return false;
+    }
+    clock_gettime(CLOCK_MONOTONIC,&end);
+
+    *wallMs = (end.tv_sec-start.tv_sec)*1000.0+(end.tv_nsec-start.tv_nsec)/1000000.0;
+    *cpuMs = (usage.ru_utime.tv_sec+usage.ru_stime.tv_sec)*1000.0+
+        (usage.ru_utime.tv_usec+usage.ru_stime.tv_usec)/1000.0;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/**
+ * reads the medians of a csv file written by an earlier run.
+ *
+ * @function   load_baseline
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       lines that cannot be parsed, like the header, are skipped.
+ *
+ * @signature  bool load_baseline(const char* path,
+ *   std::map<std::string,double>* baseline)
+ *
+ * @param      path path to the csv file.
+ * @param      baseline set to the median of each combination, keyed by
+ *   make_key.
+ *
+ * @return     true if the file was read; false otherwise, with errno set.
+ */
+bool load_baseline(const char* path,std::map<std::string,double>* baseline)
+{
+    FILE* in = fopen(path,"r");
+    if (in == 0)
+    {
+        return false;
+    }
+
+    char backend[16];
+    char kind[16];
+    unsigned int workers;
+    unsigned long chunkSize;
+    unsigned long limbs;
+    unsigned int repeats;
+    double medianMs;
+    char line[256];
+    while(fgets(line,sizeof(line),in) != 0)
+    {
+        if (sscanf(line,"%15[^,],%u,%lu,%lu,%15[^,],%u,%lf",backend,&workers,
+            &chunkSize,&limbs,kind,&repeats,&medianMs) == 7)
+        {
+            (*baseline)[make_key(backend,workers,chunkSize,limbs,kind)] = medianMs;
+        }
+    }
+    fclose(in);
+    return true;
+}
+
+/**
+ * makes the key of a combination; the first columns of its line in the csv
+ *   file, up to the number of repeats.
+ *
+ * @function   make_key
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the number of repeats is not part of the combination, so runs
+ *   with different repeats can be compared.
+ *
+ * @signature  std::string make_key(const char* backend,unsigned int workers,
+ *   unsigned long chunkSize,unsigned long limbs,const char* kind)
+ *
+ * @param      backend backend of the combination.
+ * @param      workers number of workers of the combination.
+ * @param      chunkSize chunk size of the combination.
+ * @param      limbs number of limbs of the subject.
+ * @param      kind kind of the subject.
+ *
+ * @return     the key of the combination.
+ */
+std::string make_key(const char* backend,unsigned int workers,unsigned long chunkSize,unsigned long limbs,const char* kind)
+{
+    char key[128];
+    snprintf(key,sizeof(key),"%s,%u,%lu,%lu,%s",backend,workers,chunkSize,limbs,kind);
+    return key;
+}
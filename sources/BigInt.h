@@ -0,0 +1,395 @@
+/**
+ * the BigInt class template; a fixed width integer of N limbs, with just the
+ *   operations the fixed width kernel of FindFactorsTask needs.
+ *
+ * @sourceFile BigInt.h
+ *
+ * @program    Threads-Main.out, Processes-Main.out
+ *
+ * @class      BigInt
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the number of limbs is a template parameter, so a BigInt lives on the stack,
+ *   or inline in a vector, and is never allocated, or resized. every operation
+ *   is spelled out limb by limb by the BigIntLimbs template, which recurses on
+ *   the number of limbs left, so the loops over the limbs are unrolled at
+ *   compile time, and there is no size to check, or dispatch on at run time.
+ *
+ * the limbs are stored least significant first, like GMP stores them, and a
+ *   BigInt is always non-negative; made from a negative number, it holds its
+ *   absolute value, which has the same divisors.
+ *
+ * mod_word divides by one limb at a time, most significant first, keeping the
+ *   remainder in the high half of the next two limb dividend, so every step is
+ *   a single divq instruction on x86-64. other targets use GMP's mpn_mod_1 for
+ *   each step instead.
+ */
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <gmp.h>
+
+#define BIGINT_MAX_LIMBS 8
+
+static inline mp_limb_t bigint_mod_limbs(mp_limb_t hi,mp_limb_t lo,mp_limb_t divisor);
+
+/**
+ * the operations of BigInt over the I least significant limbs of a number,
+ *   unrolled by recursing on I.
+ */
+template<unsigned int I>
+struct BigIntLimbs
+{
+    static inline int compare(const mp_limb_t* a,const mp_limb_t* b)
+    {
+        if (a[I-1] != b[I-1])
+        {
+            return a[I-1] < b[I-1] ? -1 : 1;
+        }
+        return BigIntLimbs<I-1>::compare(a,b);
+    }
+
+    static inline void increment(mp_limb_t* a)
+    {
+        if (++a[0] == 0)
+        {
+            BigIntLimbs<I-1>::increment(a+1);
+        }
+    }
+
+    static inline bool is_zero(const mp_limb_t* a)
+    {
+        return a[I-1] == 0 && BigIntLimbs<I-1>::is_zero(a);
+    }
+
+    static inline mp_limb_t mod_word(const mp_limb_t* a,mp_limb_t divisor,mp_limb_t remainder)
+    {
+        return BigIntLimbs<I-1>::mod_word(a,divisor,bigint_mod_limbs(remainder,a[I-1],divisor));
+    }
+};
+
+/**
+ * ends the recursion of BigIntLimbs.
+ */
+template<>
+struct BigIntLimbs<0>
+{
+    static inline int compare(const mp_limb_t*,const mp_limb_t*)
+    {
+        return 0;
+    }
+
+    static inline void increment(mp_limb_t*)
+    {
+    }
+
+    static inline bool is_zero(const mp_limb_t*)
+    {
+        return true;
+    }
+
+    static inline mp_limb_t mod_word(const mp_limb_t*,mp_limb_t,mp_limb_t remainder)
+    {
+        return remainder;
+    }
+};
+
+template<unsigned int N>
+class BigInt
+{
+public:
+
+    BigInt();
+    BigInt(const mpz_t _value);
+    int compare(const BigInt<N>& other) const;
+    void increment();
+    bool fits_word() const;
+    mp_limb_t get_word() const;
+    mp_limb_t mod_word(mp_limb_t divisor) const;
+    void get(mpz_t value) const;
+
+private:
+
+    mp_limb_t limbs[N];
+};
+
+/**
+ * divides a two limb number by a limb.
+ *
+ * @function   bigint_mod_limbs
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       hi must be smaller than the divisor, or the quotient would not
+ *   fit in a limb.
+ *
+ * @signature  mp_limb_t bigint_mod_limbs(mp_limb_t hi,mp_limb_t lo,
+ *   mp_limb_t divisor)
+ *
+ * @param      hi most significant limb of the number.
+ * @param      lo least significant limb of the number.
+ * @param      divisor number to divide by.
+ *
+ * @return     the remainder.
+ */
+static inline mp_limb_t bigint_mod_limbs(mp_limb_t hi,mp_limb_t lo,mp_limb_t divisor)
+{
+#if defined(__x86_64__) && GMP_LIMB_BITS == 64 && GMP_NAIL_BITS == 0
+    mp_limb_t quotient;
+    __asm__("divq %4" : "=a"(quotient),"=d"(hi) : "a"(lo),"d"(hi),"rm"(divisor) : "cc");
+    return hi;
+#else
+    mp_limb_t number[2] = {lo,hi};
+    return mpn_mod_1(number,2,divisor);
+#endif
+}
+
+/**
+ * instantiates a BigInt with the value 0.
+ *
+ * @class      BigInt
+ *
+ * @method     BigInt
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  BigInt<N>::BigInt()
+ *
+ * @return     an instance of a BigInt.
+ */
+template<unsigned int N>
+BigInt<N>::BigInt()
+{
+    for(register unsigned int i = 0; i < N; ++i)
+    {
+        limbs[i] = 0;
+    }
+}
+
+/**
+ * instantiates a BigInt with the value of a GMP number.
+ *
+ * @class      BigInt
+ *
+ * @method     BigInt
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the number must fit in N limbs; limbs past the Nth are dropped.
+ *   a negative number is stored as its absolute value.
+ *
+ * @signature  BigInt<N>::BigInt(const mpz_t _value)
+ *
+ * @param      _value number to copy.
+ *
+ * @return     an instance of a BigInt.
+ */
+template<unsigned int N>
+BigInt<N>::BigInt(const mpz_t _value)
+{
+    for(register unsigned int i = 0; i < N; ++i)
+    {
+        limbs[i] = mpz_getlimbn(_value,i);
+    }
+}
+
+/**
+ * compares this number with another.
+ *
+ * @class      BigInt
+ *
+ * @method     compare
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int BigInt<N>::compare(const BigInt<N>& other) const
+ *
+ * @param      other number to compare with.
+ *
+ * @return     a negative number, 0, or a positive number if this number is
+ *   smaller than, equal to, or larger than the other, like mpz_cmp.
+ */
+template<unsigned int N>
+int BigInt<N>::compare(const BigInt<N>& other) const
+{
+    return BigIntLimbs<N>::compare(limbs,other.limbs);
+}
+
+/**
+ * adds 1 to this number.
+ *
+ * @class      BigInt
+ *
+ * @method     increment
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the largest number of N limbs wraps around to 0.
+ *
+ * @signature  void BigInt<N>::increment()
+ */
+template<unsigned int N>
+void BigInt<N>::increment()
+{
+    BigIntLimbs<N>::increment(limbs);
+}
+
+/**
+ * tells whether this number fits in a single limb.
+ *
+ * @class      BigInt
+ *
+ * @method     fits_word
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool BigInt<N>::fits_word() const
+ *
+ * @return     true if every limb but the least significant one is 0.
+ */
+template<unsigned int N>
+bool BigInt<N>::fits_word() const
+{
+    return BigIntLimbs<N-1>::is_zero(limbs+1);
+}
+
+/**
+ * returns the least significant limb of this number.
+ *
+ * @class      BigInt
+ *
+ * @method     get_word
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       this is the whole number if fits_word is true.
+ *
+ * @signature  mp_limb_t BigInt<N>::get_word() const
+ *
+ * @return     the least significant limb of this number.
+ */
+template<unsigned int N>
+mp_limb_t BigInt<N>::get_word() const
+{
+    return limbs[0];
+}
+
+/**
+ * returns the remainder of this number divided by a limb.
+ *
+ * @class      BigInt
+ *
+ * @method     mod_word
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the divisor must not be 0.
+ *
+ * @signature  mp_limb_t BigInt<N>::mod_word(mp_limb_t divisor) const
+ *
+ * @param      divisor number to divide by.
+ *
+ * @return     the remainder; 0 if the divisor divides this number.
+ */
+template<unsigned int N>
+mp_limb_t BigInt<N>::mod_word(mp_limb_t divisor) const
+{
+    return BigIntLimbs<N>::mod_word(limbs,divisor,0);
+}
+
+/**
+ * copies this number into a GMP number.
+ *
+ * @class      BigInt
+ *
+ * @method     get
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void BigInt<N>::get(mpz_t value) const
+ *
+ * @param      value initialized number to set to this number.
+ */
+template<unsigned int N>
+void BigInt<N>::get(mpz_t value) const
+{
+    mp_limb_t* out = mpz_limbs_write(value,N);
+    for(register unsigned int i = 0; i < N; ++i)
+    {
+        out[i] = limbs[i];
+    }
+    mpz_limbs_finish(value,N);
+}
+
+#endif
@@ -0,0 +1,521 @@
+/**
+ * implementation of the Checkpoint class declared in Checkpoint.h
+ *
+ * @sourceFile Checkpoint.cpp
+ *
+ * @program    Threads-Main.out, Processes-Main.out
+ *
+ * @class      Checkpoint
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the checkpoint file starts with the 4 byte magic string "FFCK", the subject,
+ *   and the chunk size. it is followed by any number of records, each holding
+ *   the frontier at the time it was written, the number of factors in the
+ *   record, and the factors. all numbers are written with mpz_out_raw.
+ *
+ * each record only holds the factors that fell below the frontier since the
+ *   previous record, so the file only grows by the size of the results. a
+ *   record that was only partially written is ignored when resuming.
+ */
+#include "Checkpoint.h"
+#include "Lock.h"
+#include "Contention.h"
+#include <time.h>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+
+#define CHECKPOINT_MAGIC "FFCK"
+
+/**
+ * instantiates a Checkpoint instance.
+ *
+ * @class      Checkpoint
+ *
+ * @method     Checkpoint
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the checkpoint file is not touched until resume or start is
+ *   called.
+ *
+ * @signature  Checkpoint::Checkpoint(const char* _path,mpz_t _subject,
+ *   unsigned long _chunkSize)
+ *
+ * @param      _path path to the checkpoint file.
+ * @param      _subject number whose factors are being found.
+ * @param      _chunkSize number of candidates in each chunk of the range.
+ *
+ * @return     an instance of a Checkpoint.
+ */
+Checkpoint::Checkpoint(const char* _path,mpz_t _subject,unsigned long _chunkSize)
+    :path(_path)
+    ,chunkSize(_chunkSize)
+    ,frontier(0)
+    ,writtenFrontier(0)
+    ,access(false,1)
+    ,stopSem(false,0)
+    ,running(false)
+    ,file(0)
+{
+    mpz_set(subject.value,_subject);
+    contention_name(&access.sem,"Checkpoint::access");
+}
+
+/**
+ * destructor for the Checkpoint.
+ *
+ * @class      Checkpoint
+ *
+ * @method     ~Checkpoint
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       stops the background writer if it is still running, which
+ *   writes a final record.
+ *
+ * @signature  Checkpoint::~Checkpoint()
+ */
+Checkpoint::~Checkpoint()
+{
+    stop();
+
+    std::map<unsigned long,std::vector<Number*> >::iterator it;
+    for(it = pending.begin(); it != pending.end(); ++it)
+    {
+        for(register unsigned int i = 0; i < it->second.size(); ++i)
+        {
+            delete it->second[i];
+        }
+    }
+    for(register unsigned int i = 0; i < unwritten.size(); ++i)
+    {
+        delete unwritten[i];
+    }
+}
+
+/**
+ * reads the checkpoint file, and loads the frontier and the factors below it.
+ *
+ * @class      Checkpoint
+ *
+ * @method     resume
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * records are read until the end of the file, or until a record that was only
+ *   partially written. the factors that are read are appended to the passed
+ *   vector, and are also written again into the new checkpoint file when start
+ *   is called.
+ *
+ * @signature  bool Checkpoint::resume(std::vector<Number*>* results)
+ *
+ * @param      results vector to append the factors from the file to.
+ *
+ * @return     true if the file was read; false if it could not be opened, or
+ *   if it is not a checkpoint of the same subject and chunk size.
+ */
+bool Checkpoint::resume(std::vector<Number*>* results)
+{
+    FILE* in = fopen(path.c_str(),"r");
+    if (in == 0)
+    {
+        return false;
+    }
+
+    // verify the header
+    char magic[sizeof(CHECKPOINT_MAGIC)-1];
+    Number fileSubject;
+    Number fileChunkSize;
+    if (fread(magic,1,sizeof(magic),in) != sizeof(magic) ||
+        memcmp(magic,CHECKPOINT_MAGIC,sizeof(magic)) != 0 ||
+        !mpz_inp_raw(fileSubject.value,in) ||
+        !mpz_inp_raw(fileChunkSize.value,in) ||
+        mpz_cmp(fileSubject.value,subject.value) != 0 ||
+        mpz_cmp_ui(fileChunkSize.value,chunkSize) != 0)
+    {
+        fclose(in);
+        errno = EINVAL;
+        return false;
+    }
+
+    // read all complete records
+    Number recordFrontier;
+    Number count;
+    while(mpz_inp_raw(recordFrontier.value,in) && mpz_inp_raw(count.value,in))
+    {
+        std::vector<Number*> factors;
+        unsigned long numFactors = mpz_get_ui(count.value);
+        for(register unsigned long i = 0; i < numFactors; ++i)
+        {
+            Number* factor = new Number();
+            if (!mpz_inp_raw(factor->value,in))
+            {
+                delete factor;
+                break;
+            }
+            factors.push_back(factor);
+        }
+
+        if (factors.size() != numFactors)
+        {
+            for(register unsigned int i = 0; i < factors.size(); ++i)
+            {
+                delete factors[i];
+            }
+            break;
+        }
+
+        Lock scopelock(&access.sem);
+        for(register unsigned int i = 0; i < factors.size(); ++i)
+        {
+            Number* copy = new Number();
+            mpz_set(copy->value,factors[i]->value);
+            unwritten.push_back(copy);
+            results->push_back(factors[i]);
+        }
+        frontier = mpz_get_ui(recordFrontier.value);
+    }
+
+    fclose(in);
+    return true;
+}
+
+/**
+ * creates a new checkpoint file, and starts the background writer thread.
+ *
+ * @class      Checkpoint
+ *
+ * @method     start
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the new file is written next to the old one, and renamed over it once it
+ *   holds everything loaded by resume, so there is always a consistent
+ *   checkpoint on disk.
+ *
+ * the writer thread blocks all signals, so signal handlers of the program are
+ *   never run on it.
+ *
+ * @signature  bool Checkpoint::start()
+ *
+ * @return     true if the thread was started; false otherwise.
+ */
+bool Checkpoint::start()
+{
+    std::string tempPath = path+".tmp";
+    file = fopen(tempPath.c_str(),"w");
+    if (file == 0)
+    {
+        return false;
+    }
+
+    // write the header, and everything loaded by resume
+    Number fileChunkSize;
+    mpz_set_ui(fileChunkSize.value,chunkSize);
+    writtenFrontier = (unsigned long) -1;
+    if (fwrite(CHECKPOINT_MAGIC,1,sizeof(CHECKPOINT_MAGIC)-1,file) != sizeof(CHECKPOINT_MAGIC)-1 ||
+        !mpz_out_raw(file,subject.value) ||
+        !mpz_out_raw(file,fileChunkSize.value) ||
+        !write_record() ||
+        rename(tempPath.c_str(),path.c_str()) < 0)
+    {
+        if (file != 0)
+        {
+            fclose(file);
+            file = 0;
+        }
+        return false;
+    }
+
+    // start the writer thread with all signals blocked
+    sigset_t allSignals;
+    sigset_t oldSignals;
+    sigfillset(&allSignals);
+    pthread_sigmask(SIG_SETMASK,&allSignals,&oldSignals);
+    running = pthread_create(&writer,0,writer_routine,this) == 0;
+    pthread_sigmask(SIG_SETMASK,&oldSignals,0);
+
+    return running;
+}
+
+/**
+ * stops the background writer thread after it writes a final record.
+ *
+ * @class      Checkpoint
+ *
+ * @method     stop
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       does nothing if the writer thread is not running.
+ *
+ * @signature  void Checkpoint::stop()
+ */
+void Checkpoint::stop()
+{
+    if (running)
+    {
+        stopSem.post();
+        pthread_join(writer,0);
+        running = false;
+    }
+    if (file != 0)
+    {
+        fclose(file);
+        file = 0;
+    }
+}
+
+/**
+ * records the factors found in a completed chunk, and advances the frontier.
+ *
+ * @class      Checkpoint
+ *
+ * @method     chunk_done
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * chunks may be completed in any order. factors of chunks past the frontier
+ *   are held until all the chunks before them are completed. a chunk that was
+ *   already recorded is ignored.
+ *
+ * the factors are copied; the passed vector is not modified.
+ *
+ * @signature  void Checkpoint::chunk_done(unsigned long chunk,
+ *   std::vector<Number*>* factors)
+ *
+ * @param      chunk index of the completed chunk; the chunk that starts at
+ *   chunk*chunkSize+1.
+ * @param      factors factors found in the chunk.
+ */
+void Checkpoint::chunk_done(unsigned long chunk,std::vector<Number*>* factors)
+{
+    Lock scopelock(&access.sem);
+
+    if (chunk < frontier || pending.count(chunk))
+    {
+        return;
+    }
+
+    std::vector<Number*>& copies = pending[chunk];
+    for(register unsigned int i = 0; i < factors->size(); ++i)
+    {
+        Number* copy = new Number();
+        mpz_set(copy->value,factors->at(i)->value);
+        copies.push_back(copy);
+    }
+
+    // advance the frontier past all consecutive completed chunks
+    while(!pending.empty() && pending.begin()->first == frontier)
+    {
+        std::vector<Number*>& done = pending.begin()->second;
+        unwritten.insert(unwritten.end(),done.begin(),done.end());
+        pending.erase(pending.begin());
+        ++frontier;
+    }
+}
+
+/**
+ * returns the completed-chunk frontier.
+ *
+ * @class      Checkpoint
+ *
+ * @method     get_frontier
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  unsigned long Checkpoint::get_frontier()
+ *
+ * @return     number of chunks at the start of the range that have all been
+ *   completed.
+ */
+unsigned long Checkpoint::get_frontier()
+{
+    Lock scopelock(&access.sem);
+    return frontier;
+}
+
+/**
+ * routine executed by the background writer thread.
+ *
+ * @class      Checkpoint
+ *
+ * @method     writer_routine
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * writes a record every CHECKPOINT_INTERVAL_MS milliseconds, and a final one
+ *   when stop is called.
+ *
+ * @signature  void* Checkpoint::writer_routine(void* checkpoint)
+ *
+ * @param      checkpoint pointer to the Checkpoint that started the thread.
+ */
+void* Checkpoint::writer_routine(void* checkpoint)
+{
+    Checkpoint* self = (Checkpoint*) checkpoint;
+
+    bool stopping = false;
+    while(!stopping)
+    {
+        timespec timeout;
+        clock_gettime(CLOCK_REALTIME,&timeout);
+        timeout.tv_sec += CHECKPOINT_INTERVAL_MS/1000;
+        timeout.tv_nsec += (CHECKPOINT_INTERVAL_MS%1000)*1000*1000;
+        if (timeout.tv_nsec >= 1000*1000*1000)
+        {
+            timeout.tv_nsec -= 1000*1000*1000;
+            ++timeout.tv_sec;
+        }
+        stopping = sem_timedwait(&self->stopSem.sem,&timeout) == 0;
+
+        if (!self->write_record())
+        {
+            perror("failed to write checkpoint");
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * appends a record holding the frontier, and the factors that fell below it
+ *   since the last record to the checkpoint file, and flushes it to disk.
+ *
+ * @class      Checkpoint
+ *
+ * @method     write_record
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the lock is only held while taking the factors out of the unwritten vector;
+ *   chunk_done is never blocked on the disk.
+ *
+ * if a record fails to be written, the file is closed, and no more records
+ *   are written.
+ *
+ * @signature  bool Checkpoint::write_record()
+ *
+ * @return     true if the record was written, or there was nothing new to
+ *   write; false otherwise.
+ */
+bool Checkpoint::write_record()
+{
+    std::vector<Number*> factors;
+    unsigned long recordFrontier;
+    {
+        Lock scopelock(&access.sem);
+        factors.swap(unwritten);
+        recordFrontier = frontier;
+    }
+
+    // write the record. after a failed write, the file may end in a partial
+    // record, so nothing more is appended to it
+    bool success = true;
+    if (file != 0 && (!factors.empty() || recordFrontier != writtenFrontier))
+    {
+        Number recordHeader;
+        mpz_set_ui(recordHeader.value,recordFrontier);
+        success = mpz_out_raw(file,recordHeader.value) != 0;
+        mpz_set_ui(recordHeader.value,factors.size());
+        success = success && mpz_out_raw(file,recordHeader.value) != 0;
+        for(register unsigned int i = 0; i < factors.size(); ++i)
+        {
+            success = success && mpz_out_raw(file,factors[i]->value) != 0;
+        }
+        success = success && fflush(file) == 0 && fsync(fileno(file)) == 0;
+
+        if (success)
+        {
+            writtenFrontier = recordFrontier;
+        }
+        else
+        {
+            fclose(file);
+            file = 0;
+        }
+    }
+
+    for(register unsigned int i = 0; i < factors.size(); ++i)
+    {
+        delete factors[i];
+    }
+    return success;
+}
@@ -0,0 +1,67 @@
+/**
+ * header file for the Checkpoint class. implementation is in Checkpoint.cpp
+ *
+ * @sourceFile Checkpoint.h
+ *
+ * @program    Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * keeps track of the completed-chunk frontier of a run; the number of chunks
+ *   at the start of the range that have all been completed. the frontier, and
+ *   the factors found below it are periodically appended to a checkpoint file
+ *   by a background thread, so an interrupted run can be resumed from it.
+ */
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <pthread.h>
+#include "Number.h"
+#include "Semaphore.h"
+
+#define CHECKPOINT_INTERVAL_MS 5000
+
+class Checkpoint
+{
+public:
+
+    Checkpoint(const char* _path,mpz_t _subject,unsigned long _chunkSize);
+    ~Checkpoint();
+    bool resume(std::vector<Number*>* results);
+    bool start();
+    void stop();
+    void chunk_done(unsigned long chunk,std::vector<Number*>* factors);
+    unsigned long get_frontier();
+
+private:
+
+    static void* writer_routine(void*);
+    bool write_record();
+
+    std::string path;
+    Number subject;
+    unsigned long chunkSize;
+    unsigned long frontier;
+    unsigned long writtenFrontier;
+    std::map<unsigned long,std::vector<Number*> > pending;
+    std::vector<Number*> unwritten;
+    Semaphore access;
+    Semaphore stopSem;
+    pthread_t writer;
+    bool running;
+    FILE* file;
+};
+
+#endif
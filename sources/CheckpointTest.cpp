@@ -0,0 +1,104 @@
+/**
+ * contains a main function that uses the Checkpoint class. meant to be run
+ *   with debugging tools to make sure there are no memory leaks and other
+ *   problems.
+ *
+ * @sourceFile CheckpointTest.cpp
+ *
+ * @program    CheckpointTest.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ */
+#include <gmp.h>
+#include <stdio.h>
+#include <vector>
+#include "Checkpoint.h"
+#include "Number.h"
+
+/**
+ * uses the Checkpoint class. this program is meant to be run with debugging
+ *   tools like valgrind to verify that there are no memory leaks and other
+ *   issues.
+ *
+ * @function   main
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int main()
+ *
+ * @return     exit status.
+ */
+int main()
+{
+    // declare & initialize numbers
+    Number number;
+    mpz_set_ui(number.value,1000);
+
+    std::vector<Number*> chunk0;
+    std::vector<Number*> chunk2;
+    for(register unsigned int i = 1; i <= 10; ++i)
+    {
+        if (1000%i == 0)
+        {
+            chunk0.push_back(new Number());
+            mpz_set_ui(chunk0.back()->value,i);
+        }
+    }
+    chunk2.push_back(new Number());
+    mpz_set_ui(chunk2.back()->value,25);
+
+    // do test stuff... complete chunks 2 and 0 of 10 numbers each; chunk 1 is
+    // never completed, so only chunk 0 should be below the frontier
+    {
+        Checkpoint checkpoint("CheckpointTest.ck",number.value,10);
+        checkpoint.start();
+        checkpoint.chunk_done(2,&chunk2);
+        checkpoint.chunk_done(0,&chunk0);
+        checkpoint.chunk_done(0,&chunk0);
+        checkpoint.stop();
+    }
+
+    std::vector<Number*> results;
+    Checkpoint checkpoint("CheckpointTest.ck",number.value,10);
+    checkpoint.resume(&results);
+
+    // print the results
+    printf("%lu == 1\n",checkpoint.get_frontier());
+    for(register unsigned int i = 0; i < results.size(); ++i)
+    {
+        gmp_printf("%Zd\n",results[i]->value);
+    }
+
+    // deallocate numbers
+    for(register unsigned int i = 0; i < chunk0.size(); ++i)
+    {
+        delete chunk0[i];
+    }
+    for(register unsigned int i = 0; i < chunk2.size(); ++i)
+    {
+        delete chunk2[i];
+    }
+    for(register unsigned int i = 0; i < results.size(); ++i)
+    {
+        delete results[i];
+    }
+    remove("CheckpointTest.ck");
+
+    return 0;
+}
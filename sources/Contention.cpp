@@ -0,0 +1,406 @@
+/**
+ * implementation of the contention tracing functions declared in Contention.h
+ *
+ * @sourceFile Contention.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the table is open addressed by the address of the semaphore. a record is
+ *   claimed by swapping the address into it, and records are never removed,
+ *   so every thread, and process that looks for a semaphore finds the same
+ *   record. the counters are updated with atomic adds, so records can be
+ *   shared without a lock.
+ *
+ * an acquisition first tries the semaphore without blocking; only if that
+ *   fails is it counted as contended, and timed.
+ */
+#include "Contention.h"
+#include "SpinWait.h"
+#include <time.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <vector>
+#include <algorithm>
+
+/**
+ * what is recorded about a semaphore.
+ */
+struct ContentionRecord
+{
+    sem_t* sem;
+    char name[CONTENTION_NAME_SIZE];
+    unsigned long long acquisitions;
+    unsigned long long contended;
+    unsigned long long waitNs;
+    unsigned long long maxWaitNs;
+    unsigned long long holdNs;
+    unsigned long long holds;
+    unsigned long long waiters;
+    unsigned long long maxWaiters;
+};
+
+static ContentionRecord* find_record(sem_t* sem);
+static unsigned long long now();
+static void raise_to(unsigned long long* maximum,unsigned long long value);
+static bool waited_longer(ContentionRecord* first,ContentionRecord* second);
+#ifdef TRACE_CONTENTION
+static void report_at_exit();
+#endif
+
+/**
+ * table of records in shared memory, or 0 if nothing is recorded.
+ */
+static ContentionRecord* records = 0;
+
+#ifdef TRACE_CONTENTION
+/**
+ * process that mapped the table, and reports it at exit.
+ */
+static pid_t reporter = 0;
+
+/**
+ * maps the table before main runs, so it is mapped before any worker process
+ *   is forked.
+ */
+static struct ContentionTable
+{
+    ContentionTable()
+    {
+        void* table = mmap(0,CONTENTION_RECORDS*sizeof(ContentionRecord),PROT_READ|PROT_WRITE,
+            MAP_SHARED|MAP_ANONYMOUS,-1,0);
+        if (table != MAP_FAILED)
+        {
+            records = (ContentionRecord*) table;
+            reporter = getpid();
+            atexit(report_at_exit);
+        }
+    }
+} contentionTable;
+#endif
+
+/**
+ * names a semaphore in the report.
+ *
+ * @function   contention_name
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       semaphores that are not named are reported by their address.
+ *   names longer than CONTENTION_NAME_SIZE-1 are cut short.
+ *
+ * @signature  void contention_name(sem_t* sem,const char* name)
+ *
+ * @param      sem semaphore to name.
+ * @param      name name of the semaphore.
+ */
+void contention_name(sem_t* sem,const char* name)
+{
+    ContentionRecord* record = find_record(sem);
+    if (record != 0)
+    {
+        strncpy(record->name,name,CONTENTION_NAME_SIZE-1);
+    }
+}
+
+/**
+ * waits on a semaphore, and records the acquisition.
+ *
+ * @function   contention_wait
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       behaves like spin_wait if the semaphore cannot be recorded.
+ *
+ * @signature  unsigned long long contention_wait(sem_t* sem)
+ *
+ * @param      sem semaphore to wait on.
+ *
+ * @return     time it was acquired at in nanoseconds, to be passed to
+ *   contention_held once it is posted.
+ */
+unsigned long long contention_wait(sem_t* sem)
+{
+    ContentionRecord* record = find_record(sem);
+    if (record == 0)
+    {
+        spin_wait(sem);
+        return 0;
+    }
+    __sync_fetch_and_add(&record->acquisitions,1);
+    if (sem_trywait(sem) == 0)
+    {
+        return now();
+    }
+
+    // it has to be waited for
+    unsigned long long start = now();
+    raise_to(&record->maxWaiters,__sync_add_and_fetch(&record->waiters,1));
+    spin_wait(sem);
+    __sync_fetch_and_sub(&record->waiters,1);
+    unsigned long long acquired = now();
+
+    __sync_fetch_and_add(&record->contended,1);
+    __sync_fetch_and_add(&record->waitNs,acquired-start);
+    raise_to(&record->maxWaitNs,acquired-start);
+    return acquired;
+}
+
+/**
+ * records how long a semaphore was held.
+ *
+ * @function   contention_held
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       called just before the semaphore is posted.
+ *
+ * @signature  void contention_held(sem_t* sem,unsigned long long acquired)
+ *
+ * @param      sem semaphore that was held.
+ * @param      acquired time returned by contention_wait.
+ */
+void contention_held(sem_t* sem,unsigned long long acquired)
+{
+    ContentionRecord* record = find_record(sem);
+    if (record != 0 && acquired != 0)
+    {
+        __sync_fetch_and_add(&record->holdNs,now()-acquired);
+        __sync_fetch_and_add(&record->holds,1);
+    }
+}
+
+/**
+ * prints the semaphores that were waited for the longest.
+ *
+ * @function   contention_report
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       prints a line for each of the CONTENTION_REPORT_SIZE semaphores
+ *   with the longest total wait, longest first. semaphores that were never
+ *   acquired are left out.
+ *
+ * @signature  void contention_report(FILE* out)
+ *
+ * @param      out file to print to.
+ */
+void contention_report(FILE* out)
+{
+    if (records == 0)
+    {
+        return;
+    }
+
+    std::vector<ContentionRecord*> used;
+    for(register unsigned int i = 0; i < CONTENTION_RECORDS; ++i)
+    {
+        if (records[i].sem != 0 && records[i].acquisitions != 0)
+        {
+            used.push_back(&records[i]);
+        }
+    }
+    std::sort(used.begin(),used.end(),waited_longer);
+
+    fprintf(out,"contention: name, acquisitions, contended, total wait ms, max wait us, mean hold us, max waiters\n");
+    for(register unsigned int i = 0; i < used.size() && i < CONTENTION_REPORT_SIZE; ++i)
+    {
+        ContentionRecord* record = used[i];
+        char address[CONTENTION_NAME_SIZE];
+        snprintf(address,sizeof(address),"%p",(void*) record->sem);
+        fprintf(out,"contention: %s, %llu, %llu (%.1f%%), %.3f, %.1f, %.3f, %llu\n",
+            record->name[0] != '\0' ? record->name : address,
+            record->acquisitions,record->contended,record->contended*100.0/record->acquisitions,
+            record->waitNs/1e6,record->maxWaitNs/1e3,
+            record->holds != 0 ? record->holdNs/1e3/record->holds : 0.0,
+            record->maxWaiters);
+    }
+}
+
+/**
+ * returns the record of a semaphore, claiming one for it if it has none.
+ *
+ * @function   find_record
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       see the top of this file for how records are claimed.
+ *
+ * @signature  ContentionRecord* find_record(sem_t* sem)
+ *
+ * @param      sem semaphore to find the record of.
+ *
+ * @return     the record, or 0 if nothing is recorded, or the table is full.
+ */
+ContentionRecord* find_record(sem_t* sem)
+{
+    if (records == 0)
+    {
+        return 0;
+    }
+    unsigned long start = ((unsigned long) sem/sizeof(void*))%CONTENTION_RECORDS;
+    for(register unsigned int i = 0; i < CONTENTION_RECORDS; ++i)
+    {
+        ContentionRecord* record = &records[(start+i)%CONTENTION_RECORDS];
+        if (record->sem == sem ||
+            __sync_bool_compare_and_swap(&record->sem,(sem_t*) 0,sem) ||
+            record->sem == sem)
+        {
+            return record;
+        }
+    }
+    return 0;
+}
+
+/**
+ * returns the time of the monotonic clock.
+ *
+ * @function   now
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       never returns 0, which contention_held takes as not recorded.
+ *
+ * @signature  unsigned long long now()
+ *
+ * @return     time in nanoseconds.
+ */
+unsigned long long now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC,&time);
+    return time.tv_sec*1000000000ULL+time.tv_nsec+1;
+}
+
+/**
+ * raises a maximum shared with other threads, and processes to a value.
+ *
+ * @function   raise_to
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       does nothing if the maximum is already at least the value.
+ *
+ * @signature  void raise_to(unsigned long long* maximum,
+ *   unsigned long long value)
+ *
+ * @param      maximum maximum to raise.
+ * @param      value value to raise it to.
+ */
+void raise_to(unsigned long long* maximum,unsigned long long value)
+{
+    unsigned long long current = *maximum;
+    while(current < value && !__sync_bool_compare_and_swap(maximum,current,value))
+    {
+        current = *maximum;
+    }
+}
+
+/**
+ * orders records by their total wait, longest first.
+ *
+ * @function   waited_longer
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool waited_longer(ContentionRecord* first,
+ *   ContentionRecord* second)
+ *
+ * @param      first a record.
+ * @param      second another record.
+ *
+ * @return     true if the first record was waited for longer.
+ */
+bool waited_longer(ContentionRecord* first,ContentionRecord* second)
+{
+    return first->waitNs > second->waitNs;
+}
+
+#ifdef TRACE_CONTENTION
+/**
+ * prints the report to stderr when the process that mapped the table exits.
+ *
+ * @function   report_at_exit
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       worker processes inherit the handler, but do not report.
+ *
+ * @signature  void report_at_exit()
+ */
+void report_at_exit()
+{
+    if (getpid() == reporter)
+    {
+        contention_report(stderr);
+    }
+}
+#endif
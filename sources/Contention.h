@@ -0,0 +1,50 @@
+/**
+ * header file for contention tracing of semaphores. implementation is in
+ *   Contention.cpp
+ *
+ * @sourceFile Contention.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * when the program is built with TRACE_CONTENTION defined (make
+ *   TRACE_CONTENTION=1), Lock, and Semaphore::wait record every acquisition of
+ *   a semaphore here: how often it was acquired, how often it had to be
+ *   waited for, how long it was waited for, how long a Lock held it, and how
+ *   many waiters it had at once. without it, nothing is recorded, and these
+ *   functions do nothing.
+ *
+ * the records are kept in a table in shared memory, mapped before main runs,
+ *   so worker processes forked later record into the same table. a semaphore
+ *   is told apart by its address, which is the same in every process for the
+ *   semaphores mapped before the fork. the table holds CONTENTION_RECORDS
+ *   semaphores; any more are not recorded.
+ *
+ * the process that mapped the table prints the CONTENTION_REPORT_SIZE
+ *   semaphores that were waited for the longest to stderr when it exits.
+ */
+#ifndef CONTENTION_H
+#define CONTENTION_H
+
+#include <stdio.h>
+#include <semaphore.h>
+
+#define CONTENTION_RECORDS 256
+#define CONTENTION_REPORT_SIZE 10
+#define CONTENTION_NAME_SIZE 32
+
+void contention_name(sem_t* sem,const char* name);
+unsigned long long contention_wait(sem_t* sem);
+void contention_held(sem_t* sem,unsigned long long acquired);
+void contention_report(FILE* out);
+
+#endif
@@ -0,0 +1,525 @@
+/**
+ * the coordinator of the distributed version of the program.
+ *
+ * usage: ./Coordinator-Main [-c|--checkpoint file] [--resume]
+ *   [--chunk-size n] [integer] [log file] [port]
+ *
+ * finds all the factors of the passed integer, by handing out chunks of the
+ *   range to agents (Agent-Main.out) that connect to it over TCP.
+ *
+ * --chunk-size sets how many candidates are in each chunk handed to an agent;
+ *   the agents are told the size when they connect.
+ *
+ * the progress, and the factors are printed the same way as by
+ *   Factors-Main.out. anything that is printed to stdout is also printed to
+ *   the specified file.
+ *
+ * agents may connect and disconnect at any time. the chunks leased to an agent
+ *   that disconnects before posting their results are handed out again. to try
+ *   it on one machine, start the coordinator, and several agents connecting to
+ *   127.0.0.1.
+ *
+ * @sourceFile Coordinator-Main.cpp
+ *
+ * @program    Coordinator-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * all messages are numbers written with mpz_out_raw. once connected, an agent
+ *   sends the number of its worker threads, and the coordinator replies with
+ *   the subject, and the chunk size. after that, the coordinator sends chunk
+ *   indices, and the agent replies with a batch for each chunk; the chunk
+ *   index, the number of factors found in the chunk, then the factors. once
+ *   all chunks are done, the coordinator shuts down its side of each
+ *   connection, and agents terminate.
+ */
+#include <set>
+#include <deque>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <getopt.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "Number.h"
+#include "Engine.h"
+
+#define USAGE "usage: %s [-c|--checkpoint file] [--resume] [--chunk-size n] [integer] [path to log file] [port]\n"
+
+/**
+ * state kept by the coordinator for each connected agent.
+ */
+struct Agent
+{
+    int fd;
+    FILE* out;
+    std::string inbox;
+    bool greeted;
+    unsigned long credit;
+    std::set<unsigned long> leases;
+};
+
+int main(int,char**);
+bool read_agent(Agent* agent);
+void drop_agent(unsigned int index);
+
+/**
+ * options of the run; the number to find all the factors of, the number of
+ *   candidates in each chunk, which is sent to every agent, the checkpoint
+ *   file, and the log file.
+ */
+EngineOptions options;
+
+/**
+ * collects the results received from agents, as if they all came from one
+ *   worker, and records them in the checkpoint.
+ */
+ResultCollector collector(1,0);
+
+/**
+ * agents that are currently connected.
+ */
+std::vector<Agent*> agents;
+
+/**
+ * chunks that were leased by agents that disconnected, and need to be handed
+ *   out again.
+ */
+std::deque<unsigned long> requeuedChunks;
+
+/**
+ * number of chunks whose results have been received.
+ */
+unsigned long chunksDone = 0;
+
+/**
+ * entry point of the program.
+ *
+ * @function   main
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * listens for agents, hands out chunks to them as they have room for more,
+ *   receives results from them, re-issues the chunks of disconnected agents,
+ *   writes results to a file, and stdout.
+ *
+ * @signature  int main(int argc,char** argv)
+ *
+ * @param      argc number of command line arguments
+ * @param      argv array of c strings of command line arguments
+ *
+ * @return     status code.
+ */
+int main(int argc,char** argv)
+{
+    // parse command line options
+    static option longOptions[] =
+    {
+        {"checkpoint",required_argument,0,'c'},
+        {"resume",no_argument,0,'R'},
+        {"chunk-size",required_argument,0,'z'},
+        {0,0,0,0}
+    };
+    init_options(&options);
+    int opt;
+    char* end;
+    while((opt = getopt_long(argc,argv,"c:",longOptions,0)) != -1)
+    {
+        switch(opt)
+        {
+        case 'c':
+            options.checkpointPath = optarg;
+            break;
+        case 'R':
+            options.resume = true;
+            break;
+        case 'z':
+            options.chunkSize = strtoul(optarg,&end,10);
+            if (*optarg == '-' || end == optarg || *end != '\0' || options.chunkSize == 0)
+            {
+                fprintf(stderr,USAGE " invalid chunk size: %s\n",argv[0],optarg);
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr,USAGE,argv[0]);
+            return 1;
+        }
+    }
+    argc -= optind-1;
+    argv += optind-1;
+
+    // parse command line arguments
+    if (argc != 4)
+    {
+        fprintf(stderr,USAGE,argv[0]);
+        return 1;
+    }
+    if (mpz_set_str(options.prime.value,argv[1],10) == -1 ||
+        mpz_sgn(options.prime.value) <= 0)
+    {
+        fprintf(stderr,USAGE,argv[0]);
+        return 1;
+    }
+    int logfile = open(argv[2],O_CREAT|O_WRONLY|O_APPEND,0644);
+    if (logfile == -1)
+    {
+        fprintf(stderr,USAGE "error occurred: ",argv[0]);
+        perror(0);
+        return 1;
+    }
+    int port = atoi(argv[3]);
+    if (port <= 0 || port > 65535)
+    {
+        fprintf(stderr,USAGE,argv[0]);
+        return 1;
+    }
+    if (options.resume && options.checkpointPath == 0)
+    {
+        fprintf(stderr,USAGE " --resume requires a checkpoint file\n",argv[0]);
+        return 1;
+    }
+
+    // chunks are identified by their index in the range
+    Number totalChunks;
+    mpz_cdiv_q_ui(totalChunks.value,options.prime.value,options.chunkSize);
+    if (!mpz_fits_ulong_p(totalChunks.value))
+    {
+        fprintf(stderr,"integer is too large to be split into chunks\n");
+        return 1;
+    }
+    unsigned long numChunks = count_chunks(options.prime.value,options.chunkSize);
+    unsigned long firstChunk;
+
+    // load the checkpoint file, and start checkpointing
+    if (!open_checkpoint(&options,&collector,&firstChunk))
+    {
+        return 1;
+    }
+    collector.set_frontier(firstChunk);
+    unsigned long nextChunk = firstChunk;
+    chunksDone = firstChunk;
+
+    // listen for agents
+    signal(SIGPIPE,SIG_IGN);
+    int listener = socket(AF_INET,SOCK_STREAM,0);
+    int reuse = 1;
+    sockaddr_in address;
+    memset(&address,0,sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (listener < 0 ||
+        setsockopt(listener,SOL_SOCKET,SO_REUSEADDR,&reuse,sizeof(reuse)) < 0 ||
+        bind(listener,(sockaddr*) &address,sizeof(address)) < 0 ||
+        listen(listener,SOMAXCONN) < 0)
+    {
+        perror("failed to listen");
+        return 1;
+    }
+
+    options.logFileOut = fdopen(logfile,"w");
+    if (!options.logFileOut)
+    {
+        perror("failed on fdopen");
+        return 1;
+    }
+
+    // the results are printed the same way as by the other programs; through
+    // a writer to stdout, and the log file
+    TeeWriter writer(fileno(stdout),fileno(options.logFileOut));
+
+    // get start time, and start reporting progress
+    long startTime = current_timestamp();
+    Reporter reporter(&collector,stdout,options.logFileOut,firstChunk,numChunks,options.chunkSize);
+    if (!reporter.start())
+    {
+        perror("failed to start reporter");
+        return 1;
+    }
+
+    // hand out chunks to agents, and receive their results until all chunks
+    // are done
+    while(chunksDone < numChunks)
+    {
+        // hand out chunks to agents that have room for more, re-issuing the
+        // chunks of disconnected agents first
+        for(register unsigned int i = 0; i < agents.size(); ++i)
+        {
+            Agent* agent = agents[i];
+            bool sent = false;
+            while(agent->greeted && agent->credit > 0 &&
+                (!requeuedChunks.empty() || nextChunk < numChunks))
+            {
+                unsigned long chunk;
+                if (!requeuedChunks.empty())
+                {
+                    chunk = requeuedChunks.front();
+                    requeuedChunks.pop_front();
+                }
+                else
+                {
+                    chunk = nextChunk++;
+                }
+
+                Number message;
+                mpz_set_ui(message.value,chunk);
+                agent->leases.insert(chunk);
+                --agent->credit;
+                sent = true;
+                if (!mpz_out_raw(agent->out,message.value))
+                {
+                    break;
+                }
+            }
+            if (sent)
+            {
+                fflush(agent->out);
+            }
+        }
+
+        // wait for agents to connect, or post results
+        std::vector<pollfd> pollParams(agents.size()+1);
+        pollParams[0].fd = listener;
+        pollParams[0].events = POLLIN;
+        for(register unsigned int i = 0; i < agents.size(); ++i)
+        {
+            pollParams[i+1].fd = agents[i]->fd;
+            pollParams[i+1].events = POLLIN;
+        }
+        if (poll(&pollParams[0],pollParams.size(),1000) < 0)
+        {
+            if (errno == EINTR) continue;
+            perror("poll");
+            return 1;
+        }
+
+        // accept newly connected agents
+        if (pollParams[0].revents & POLLIN)
+        {
+            int fd = accept(listener,0,0);
+            if (fd >= 0)
+            {
+                Agent* agent = new Agent();
+                agent->fd = fd;
+                agent->out = fdopen(dup(fd),"w");
+                agent->greeted = false;
+                agent->credit = 0;
+                agents.push_back(agent);
+            }
+        }
+
+        // read results from agents, and drop the agents that disconnected
+        for(register unsigned int i = agents.size(); i > 0; --i)
+        {
+            if (pollParams[i].revents && !read_agent(agents[i-1]))
+            {
+                drop_agent(i-1);
+            }
+        }
+    }
+
+    // get end time
+    reporter.stop();
+    long endTime = current_timestamp();
+
+    // tell the agents that there are no more chunks, and disconnect them
+    while(!agents.empty())
+    {
+        shutdown(agents.back()->fd,SHUT_WR);
+        drop_agent(agents.size()-1);
+    }
+    close(listener);
+
+    // write the final checkpoint, and print out the results
+    collector.finish();
+    print_results(&options,&collector,0,&writer,false,endTime-startTime);
+
+    // release system resources
+    fclose(options.logFileOut);
+
+    return 0;
+}
+
+/**
+ * reads everything available from an agent's connection, and processes all
+ *   the complete messages received from it.
+ *
+ * @function   read_agent
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * a message that has only been partially received is left in the agent's
+ *   inbox until the rest of it arrives, so the coordinator never blocks on a
+ *   slow agent.
+ *
+ * each batch of results releases the agent's lease on the chunk, and gives it
+ *   room for another chunk.
+ *
+ * @signature  bool read_agent(Agent* agent)
+ *
+ * @param      agent the agent to read from.
+ *
+ * @return     true if the agent is still connected; false otherwise.
+ */
+bool read_agent(Agent* agent)
+{
+    char buffer[4096];
+    ssize_t bytesRead = read(agent->fd,buffer,sizeof(buffer));
+    if (bytesRead <= 0)
+    {
+        return bytesRead < 0 && errno == EINTR;
+    }
+    agent->inbox.append(buffer,bytesRead);
+
+    // the first message of an agent is the number of its worker threads
+    size_t offset = 0;
+    if (!agent->greeted)
+    {
+        Number numWorkers;
+        if (!parse_raw(agent->inbox,&offset,numWorkers.value))
+        {
+            return true;
+        }
+        agent->inbox.erase(0,offset);
+        offset = 0;
+        agent->greeted = true;
+        agent->credit = mpz_get_ui(numWorkers.value)*MAX_PENDING_TASKS_PER_WORKER;
+
+        Number message;
+        mpz_set_ui(message.value,options.chunkSize);
+        if (!mpz_out_raw(agent->out,options.prime.value) ||
+            !mpz_out_raw(agent->out,message.value) ||
+            fflush(agent->out) != 0)
+        {
+            return false;
+        }
+    }
+
+    // process all complete batches
+    while(true)
+    {
+        Number chunk;
+        Number count;
+        if (!parse_raw(agent->inbox,&offset,chunk.value) ||
+            !parse_raw(agent->inbox,&offset,count.value))
+        {
+            break;
+        }
+
+        std::vector<Number*> factors;
+        unsigned long numFactors = mpz_get_ui(count.value);
+        for(register unsigned long i = 0; i < numFactors; ++i)
+        {
+            Number* factor = new Number();
+            if (!parse_raw(agent->inbox,&offset,factor->value))
+            {
+                delete factor;
+                break;
+            }
+            factors.push_back(factor);
+        }
+        if (factors.size() != numFactors)
+        {
+            for(register unsigned int i = 0; i < factors.size(); ++i)
+            {
+                delete factors[i];
+            }
+            break;
+        }
+
+        // the batch is complete; remove it from the inbox, and release the
+        // agent's lease on the chunk
+        agent->inbox.erase(0,offset);
+        offset = 0;
+        if (agent->leases.erase(mpz_get_ui(chunk.value)) == 0)
+        {
+            for(register unsigned int i = 0; i < factors.size(); ++i)
+            {
+                delete factors[i];
+            }
+            continue;
+        }
+        ++agent->credit;
+        ++chunksDone;
+        collector.chunk_done(0,mpz_get_ui(chunk.value),&factors);
+    }
+
+    return true;
+}
+
+/**
+ * disconnects an agent, and re-issues the chunks leased to it.
+ *
+ * @function   drop_agent
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the batches the agent already sent, which are waiting on the
+ *   connection, are read before it is disconnected; it is not waited for, so
+ *   the chunks of batches it has yet to send are re-issued.
+ *
+ * @signature  void drop_agent(unsigned int index)
+ *
+ * @param      index index of the agent in the agents vector.
+ */
+void drop_agent(unsigned int index)
+{
+    Agent* agent = agents[index];
+
+    // read the batches the agent has already sent, without waiting for more;
+    // an agent that stopped sending must not stall the other agents
+    pollfd pollParams;
+    pollParams.fd = agent->fd;
+    pollParams.events = POLLIN;
+    while(!agent->leases.empty() && poll(&pollParams,1,0) > 0 &&
+        (pollParams.revents & POLLIN) && read_agent(agent));
+
+    if (!agent->leases.empty())
+    {
+        fprintf(stderr,"agent disconnected; re-issuing %lu chunks\n",
+            (unsigned long) agent->leases.size());
+        requeuedChunks.insert(requeuedChunks.end(),agent->leases.begin(),agent->leases.end());
+    }
+
+    fclose(agent->out);
+    close(agent->fd);
+    delete agent;
+    agents.erase(agents.begin()+index);
+}
@@ -0,0 +1,219 @@
+/**
+ * implementation of the Deadline class declared in Deadline.h
+ *
+ * @sourceFile Deadline.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @class      Deadline
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the time limit is measured from when start is called.
+ */
+#include "Deadline.h"
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+
+/**
+ * instantiates a Deadline instance.
+ *
+ * @class      Deadline
+ *
+ * @method     Deadline
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the time limit does not start until start is called.
+ *
+ * @signature  Deadline::Deadline(volatile int* _cancelFlag,long _timeLimit)
+ *
+ * @param      _cancelFlag flag that is set to 1 once the time limit is up.
+ * @param      _timeLimit time limit in milliseconds.
+ *
+ * @return     an instance of a Deadline.
+ */
+Deadline::Deadline(volatile int* _cancelFlag,long _timeLimit)
+    :cancelFlag(_cancelFlag)
+    ,timeLimit(_timeLimit)
+    ,hasExpired(false)
+    ,stopSem(false,0)
+    ,running(false)
+{
+}
+
+/**
+ * destructor for the Deadline.
+ *
+ * @class      Deadline
+ *
+ * @method     ~Deadline
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       stops the timer thread if it is still running.
+ *
+ * @signature  Deadline::~Deadline()
+ */
+Deadline::~Deadline()
+{
+    stop();
+}
+
+/**
+ * starts the timer thread.
+ *
+ * @class      Deadline
+ *
+ * @method     start
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the timer thread blocks all signals, so signal handlers of the
+ *   program are never run on it.
+ *
+ * @signature  bool Deadline::start()
+ *
+ * @return     true if the thread was started; false otherwise.
+ */
+bool Deadline::start()
+{
+    // start the timer thread with all signals blocked
+    sigset_t allSignals;
+    sigset_t oldSignals;
+    sigfillset(&allSignals);
+    pthread_sigmask(SIG_SETMASK,&allSignals,&oldSignals);
+    running = pthread_create(&timer,0,deadline_routine,this) == 0;
+    pthread_sigmask(SIG_SETMASK,&oldSignals,0);
+
+    return running;
+}
+
+/**
+ * stops the timer thread before the time limit is up.
+ *
+ * @class      Deadline
+ *
+ * @method     stop
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       does nothing if the timer thread is not running.
+ *
+ * @signature  void Deadline::stop()
+ */
+void Deadline::stop()
+{
+    if (running)
+    {
+        stopSem.post();
+        pthread_join(timer,0);
+        running = false;
+    }
+}
+
+/**
+ * returns true if the time limit was up before the timer thread was stopped.
+ *
+ * @class      Deadline
+ *
+ * @method     expired
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool Deadline::expired()
+ *
+ * @return     true if the cancellation flag was set by the deadline; false
+ *   otherwise.
+ */
+bool Deadline::expired()
+{
+    return hasExpired;
+}
+
+/**
+ * routine executed by the timer thread.
+ *
+ * @class      Deadline
+ *
+ * @method     deadline_routine
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       waits for stop to be called until the time limit is up, then
+ *   sets the cancellation flag.
+ *
+ * @signature  void* Deadline::deadline_routine(void* deadline)
+ *
+ * @param      deadline pointer to the Deadline that started the thread.
+ */
+void* Deadline::deadline_routine(void* deadline)
+{
+    Deadline* self = (Deadline*) deadline;
+
+    timespec timeout;
+    clock_gettime(CLOCK_REALTIME,&timeout);
+    timeout.tv_sec += self->timeLimit/1000;
+    timeout.tv_nsec += (self->timeLimit%1000)*1000*1000;
+    if (timeout.tv_nsec >= 1000*1000*1000)
+    {
+        timeout.tv_nsec -= 1000*1000*1000;
+        ++timeout.tv_sec;
+    }
+
+    // sem_timedwait may be interrupted before the time limit is up
+    int status;
+    while((status = sem_timedwait(&self->stopSem.sem,&timeout)) != 0 && errno == EINTR);
+    if (status != 0)
+    {
+        self->hasExpired = true;
+        *self->cancelFlag = 1;
+    }
+
+    return 0;
+}
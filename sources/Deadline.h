@@ -0,0 +1,51 @@
+/**
+ * header file for the Deadline class. implementation is in Deadline.cpp
+ *
+ * @sourceFile Deadline.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * cancels a run once it has gone on for longer than its time limit. a
+ *   background thread sleeps until the limit is up, unless it is stopped
+ *   first, then sets the cancellation flag of the transport, so the workers
+ *   stop at their next candidate.
+ */
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <pthread.h>
+#include "Semaphore.h"
+
+class Deadline
+{
+public:
+
+    Deadline(volatile int* _cancelFlag,long _timeLimit);
+    ~Deadline();
+    bool start();
+    void stop();
+    bool expired();
+
+private:
+
+    static void* deadline_routine(void* deadline);
+
+    volatile int* cancelFlag;
+    long timeLimit;
+    volatile bool hasExpired;
+    Semaphore stopSem;
+    pthread_t timer;
+    bool running;
+};
+
+#endif
@@ -0,0 +1,1049 @@
+/**
+ * implementation of the non-template parts of the engine declared in Engine.h
+ *
+ * @sourceFile Engine.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   Coordinator-Main.out, Agent-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ */
+#include "Engine.h"
+#include <fcntl.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <sys/time.h>
+#include "Checkpoint.h"
+#include "GmpArena.h"
+#include "Footprint.h"
+#include "SpinWait.h"
+
+static bool parse_size(const char* str,size_t* size);
+static bool is_negative_integer(const char* arg);
+static void print_usage(const char* program,const char* backend);
+
+#define USAGE "usage: %s [-b|--backend threads|processes] [-r|--respawn] [-u|--uring] [-s|--stream] [-m|--memory-budget bytes[k|m|g]] [-c|--checkpoint file] [--resume] [--cache file] [--no-analysis] [--count] [--sigma] [--range a b] [--first-factor] [--deadline ms] [--chunk-size n] [--metrics file] [--trace file] [--footprint] [--gmp-arena] [--spin] [integer] [path to log file] [num workers]\n" \
+    "       %s [-b|--backend threads] [-m|--memory-budget bytes[k|m|g]] [--cache file] [--no-analysis] [--chunk-size n] [--metrics file] [--trace file] [--footprint] [--gmp-arena] [--spin] --batch file|- [path to log file] [num workers]\n"
+#define THREADS_USAGE "usage: %s [-s|--stream] [-m|--memory-budget bytes[k|m|g]] [-c|--checkpoint file] [--resume] [--cache file] [--no-analysis] [--count] [--sigma] [--range a b] [--first-factor] [--deadline ms] [--chunk-size n] [--metrics file] [--trace file] [--footprint] [--gmp-arena] [--spin] [integer] [path to log file] [num workers]\n" \
+    "       %s [-m|--memory-budget bytes[k|m|g]] [--cache file] [--no-analysis] [--chunk-size n] [--metrics file] [--trace file] [--footprint] [--gmp-arena] [--spin] --batch file|- [path to log file] [num workers]\n"
+#define PROCESSES_USAGE "usage: %s [-r|--respawn] [-u|--uring] [-s|--stream] [-m|--memory-budget bytes[k|m|g]] [-c|--checkpoint file] [--resume] [--cache file] [--no-analysis] [--count] [--sigma] [--range a b] [--first-factor] [--deadline ms] [--chunk-size n] [--metrics file] [--trace file] [--footprint] [--gmp-arena] [--spin] [integer] [path to log file] [num workers]\n"
+
+/**
+ * sets the passed options to their defaults; the ones a run gets when nothing
+ *   is passed on the command line.
+ *
+ * @function   init_options
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the log file is left closed, and one worker is used. the agent
+ *   uses it for the options of its pool, which it gets from the coordinator
+ *   instead of the command line.
+ *
+ * @signature  void init_options(EngineOptions* options)
+ *
+ * @param      options set to the default options.
+ */
+void init_options(EngineOptions* options)
+{
+    options->backend = "threads";
+    options->checkpointPath = 0;
+    options->batchPath = 0;
+    options->cachePath = 0;
+    options->metricsPath = 0;
+    options->tracePath = 0;
+    options->footprint = false;
+    options->gmpArena = false;
+    options->spin = false;
+    options->resume = false;
+    options->respawn = false;
+    options->uring = false;
+    options->stream = false;
+    options->analyze = true;
+    options->countFactors = false;
+    options->sumFactors = false;
+    options->range = false;
+    options->firstFactor = false;
+    options->deadline = 0;
+    options->chunkSize = MAX_NUMBERS_PER_TASK;
+    options->memoryBudget = 0;
+    options->logFileOut = 0;
+    options->numWorkers = 1;
+}
+
+/**
+ * parses the command line into the passed options, and opens the log file.
+ *
+ * @function   parse_options
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * -r, and -u only apply to the processes backend. -m has no effect with -s,
+ *   because streamed factors are not kept. with --batch, the integer is left
+ *   out of the command line. --range is followed by both ends of the range.
+ *   --deadline is followed by a time limit in milliseconds. --chunk-size sets
+ *   the number of candidates in a chunk; MAX_NUMBERS_PER_TASK if it is left
+ *   out. --metrics is followed by the file the metrics of the workers are
+ *   dumped to. --trace is followed by the file the timeline of the run is
+ *   written to. --footprint starts measuring the memory the run takes up, and
+ *   --gmp-arena makes GMP allocate from the arena in GmpArena.h; both are
+ *   started once the options are parsed, before the workers exist, with the
+ *   footprint counting what GMP asks the arena for. --spin makes locks, and
+ *   semaphores spin for a while before they sleep; they only sleep in sem_wait
+ *   without it. prints the usage to stderr if the command line is not valid; a
+ *   program that always uses the same backend only shows the options that
+ *   apply to it.
+ *
+ * options must come before the integer, the log file, and the number of
+ *   workers. parsing stops at the first of them, or at anything that looks
+ *   like a negative integer, so a negative integer gets the error of the
+ *   argument it is taken for, and is not taken for an unknown option.
+ *
+ * @signature  bool parse_options(int argc,char** argv,const char* backend,
+ *   EngineOptions* options)
+ *
+ * @param      argc number of command line arguments
+ * @param      argv array of c strings of command line arguments
+ * @param      backend backend that the program always uses, or 0 to let -b
+ *   choose it; threads is used if it is not chosen.
+ * @param      options set to the parsed options.
+ *
+ * @return     true if the command line is valid; false otherwise.
+ */
+bool parse_options(int argc,char** argv,const char* backend,EngineOptions* options)
+{
+    // parse command line options
+    static option longOptions[] =
+    {
+        {"backend",required_argument,0,'b'},
+        {"respawn",no_argument,0,'r'},
+        {"uring",no_argument,0,'u'},
+        {"stream",no_argument,0,'s'},
+        {"memory-budget",required_argument,0,'m'},
+        {"checkpoint",required_argument,0,'c'},
+        {"resume",no_argument,0,'R'},
+        {"batch",required_argument,0,'B'},
+        {"cache",required_argument,0,'C'},
+        {"no-analysis",no_argument,0,'A'},
+        {"count",no_argument,0,'n'},
+        {"sigma",no_argument,0,'S'},
+        {"range",required_argument,0,'g'},
+        {"first-factor",no_argument,0,'F'},
+        {"deadline",required_argument,0,'D'},
+        {"chunk-size",required_argument,0,'z'},
+        {"metrics",required_argument,0,'M'},
+        {"trace",required_argument,0,'T'},
+        {"footprint",no_argument,0,'f'},
+        {"gmp-arena",no_argument,0,'a'},
+        {"spin",no_argument,0,'p'},
+        {0,0,0,0}
+    };
+    const char* program = argv[0];
+    init_options(options);
+    if (backend != 0)
+    {
+        options->backend = backend;
+    }
+    int opt;
+    char* end;
+    while(optind < argc && !is_negative_integer(argv[optind]) &&
+        (opt = getopt_long(argc,argv,"+b:rusm:c:",longOptions,0)) != -1)
+    {
+        switch(opt)
+        {
+        case 'b':
+            if (backend != 0)
+            {
+                fprintf(stderr,"%s always uses the %s backend\n",program,backend);
+                return false;
+            }
+            options->backend = optarg;
+            break;
+        case 'r':
+            options->respawn = true;
+            break;
+        case 'u':
+            options->uring = true;
+            break;
+        case 's':
+            options->stream = true;
+            break;
+        case 'm':
+            if (!parse_size(optarg,&options->memoryBudget))
+            {
+                print_usage(program,backend);
+                fprintf(stderr," invalid memory budget: %s\n",optarg);
+                return false;
+            }
+            break;
+        case 'c':
+            options->checkpointPath = optarg;
+            break;
+        case 'R':
+            options->resume = true;
+            break;
+        case 'B':
+            options->batchPath = optarg;
+            break;
+        case 'C':
+            options->cachePath = optarg;
+            break;
+        case 'A':
+            options->analyze = false;
+            break;
+        case 'n':
+            options->countFactors = true;
+            break;
+        case 'S':
+            options->sumFactors = true;
+            break;
+        case 'g':
+            // the range takes two arguments; the second one is taken from
+            // argv here
+            options->range = true;
+            if (optind >= argc ||
+                mpz_set_str(options->rangeLo.value,optarg,10) == -1 ||
+                mpz_set_str(options->rangeHi.value,argv[optind++],10) == -1 ||
+                mpz_sgn(options->rangeLo.value) <= 0 ||
+                mpz_cmp(options->rangeLo.value,options->rangeHi.value) > 0)
+            {
+                print_usage(program,backend);
+                fprintf(stderr," --range takes two integers a, and b, with 1 <= a <= b\n");
+                return false;
+            }
+            break;
+        case 'F':
+            options->firstFactor = true;
+            break;
+        case 'z':
+            options->chunkSize = strtoul(optarg,&end,10);
+            if (*optarg == '-' || end == optarg || *end != '\0' || options->chunkSize == 0)
+            {
+                print_usage(program,backend);
+                fprintf(stderr," invalid chunk size: %s\n",optarg);
+                return false;
+            }
+            break;
+        case 'M':
+            options->metricsPath = optarg;
+            break;
+        case 'T':
+            options->tracePath = optarg;
+            break;
+        case 'f':
+            options->footprint = true;
+            break;
+        case 'a':
+            options->gmpArena = true;
+            break;
+        case 'p':
+            options->spin = true;
+            break;
+        case 'D':
+            options->deadline = atol(optarg);
+            if (options->deadline <= 0)
+            {
+                print_usage(program,backend);
+                fprintf(stderr," invalid deadline: %s\n",optarg);
+                return false;
+            }
+            break;
+        default:
+            print_usage(program,backend);
+            return false;
+        }
+    }
+    argc -= optind-1;
+    argv += optind-1;
+
+    // the memory functions of GMP are swapped before any worker exists. the
+    // footprint wraps the arena, so it counts what GMP asks for
+    if (options->gmpArena && !gmp_arena_enable())
+    {
+        perror("failed to enable the gmp arena");
+        options->gmpArena = false;
+    }
+    if (options->footprint && !footprint_enable())
+    {
+        perror("failed to measure memory footprint");
+        options->footprint = false;
+    }
+    spin_enable(options->spin);
+
+    // validate the options
+    if (strcmp(options->backend,"threads") != 0 &&
+        strcmp(options->backend,"processes") != 0)
+    {
+        print_usage(program,backend);
+        fprintf(stderr," unknown backend: %s\n",options->backend);
+        return false;
+    }
+    if ((options->respawn || options->uring) &&
+        strcmp(options->backend,"processes") != 0)
+    {
+        print_usage(program,backend);
+        fprintf(stderr," -r and -u only apply to the processes backend\n");
+        return false;
+    }
+    if (options->resume && options->checkpointPath == 0)
+    {
+        print_usage(program,backend);
+        fprintf(stderr," --resume requires a checkpoint file\n");
+        return false;
+    }
+
+    if ((options->countFactors || options->sumFactors) &&
+        (options->stream || options->checkpointPath != 0))
+    {
+        print_usage(program,backend);
+        fprintf(stderr," --count, and --sigma do not apply with -s, or -c\n");
+        return false;
+    }
+    if (options->range && options->checkpointPath != 0)
+    {
+        print_usage(program,backend);
+        fprintf(stderr," --range does not apply with -c\n");
+        return false;
+    }
+    if (options->firstFactor &&
+        (options->stream || options->checkpointPath != 0 ||
+        options->countFactors || options->sumFactors || options->range))
+    {
+        print_usage(program,backend);
+        fprintf(stderr," --first-factor does not apply with -s, -c, or another query\n");
+        return false;
+    }
+    if (options->deadline != 0 && (options->countFactors || options->sumFactors))
+    {
+        print_usage(program,backend);
+        fprintf(stderr," --deadline does not apply with --count, or --sigma\n");
+        return false;
+    }
+    if (options->batchPath != 0 &&
+        (strcmp(options->backend,"threads") != 0 || options->stream || options->checkpointPath != 0 ||
+        options->countFactors || options->sumFactors || options->range ||
+        options->firstFactor || options->deadline != 0))
+    {
+        print_usage(program,backend);
+        fprintf(stderr," --batch only applies to the threads backend, without -s, -c, a query, or --deadline\n");
+        return false;
+    }
+
+    // parse command line arguments. in batch mode, the integers are read from
+    // the batch file instead
+    if (options->batchPath != 0)
+    {
+        --argv;
+        ++argc;
+    }
+    if (argc != 4)
+    {
+        print_usage(program,backend);
+        return false;
+    }
+    if (options->batchPath == 0 && mpz_set_str(options->prime.value,argv[1],10) == -1)
+    {
+        print_usage(program,backend);
+        return false;
+    }
+    if (options->batchPath == 0 && mpz_sgn(options->prime.value) <= 0)
+    {
+        print_usage(program,backend);
+        fprintf(stderr," integer must be larger than or equal to 1\n");
+        return false;
+    }
+    if (atoi(argv[3]) <= 0)
+    {
+        print_usage(program,backend);
+        fprintf(stderr," num workers must be larger than or equal to 1\n");
+        return false;
+    }
+    options->numWorkers = atoi(argv[3]);
+    int logfile = open(argv[2],O_CREAT|O_WRONLY|O_APPEND,0644);
+    options->logFileOut = logfile < 0 ? 0 : fdopen(logfile,"w");
+    if (options->logFileOut == 0)
+    {
+        print_usage(program,backend);
+        fprintf(stderr,"error occurred: ");
+        perror(0);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * instantiates a Job instance.
+ *
+ * @class      Job
+ *
+ * @method     Job
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the subject, and chunksLeft are set by the caller.
+ *
+ * @signature  Job::Job(ResultCollector* _collector)
+ *
+ * @param      _collector collector that the results of the job go to.
+ *
+ * @return     an instance of a Job.
+ */
+Job::Job(ResultCollector* _collector)
+    :collector(_collector)
+    ,chunksLeft(0)
+    ,endTime(0)
+    ,doneSem(false,0)
+{
+}
+
+/**
+ * parses a number of bytes, optionally followed by a k, m, or g suffix.
+ *
+ * @function   parse_size
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the suffixes are powers of 1024, and are not case sensitive.
+ *
+ * @signature  bool parse_size(const char* str,size_t* size)
+ *
+ * @param      str c string to parse.
+ * @param      size set to the parsed number of bytes.
+ *
+ * @return     true if str is a valid size larger than 0; false otherwise.
+ */
+static bool parse_size(const char* str,size_t* size)
+{
+    char* end;
+    errno = 0;
+    unsigned long long value = strtoull(str,&end,10);
+    if (errno != 0 || end == str || *str == '-')
+    {
+        return false;
+    }
+    switch(*end)
+    {
+    case 'g': case 'G':
+        value *= 1024;
+        // fall through
+    case 'm': case 'M':
+        value *= 1024;
+        // fall through
+    case 'k': case 'K':
+        value *= 1024;
+        ++end;
+        break;
+    }
+    *size = value;
+    return *end == '\0' && value != 0;
+}
+
+/**
+ * prints the usage of a program to stderr.
+ *
+ * @function   print_usage
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a program that always uses the same backend is only shown the
+ *   options that apply to it.
+ *
+ * @signature  void print_usage(const char* program,const char* backend)
+ *
+ * @param      program name the program was run as.
+ * @param      backend backend that the program always uses, or 0 if -b
+ *   chooses it.
+ */
+static void print_usage(const char* program,const char* backend)
+{
+    if (backend == 0)
+    {
+        fprintf(stderr,USAGE,program,program);
+    }
+    else if (strcmp(backend,"processes") == 0)
+    {
+        fprintf(stderr,PROCESSES_USAGE,program);
+    }
+    else
+    {
+        fprintf(stderr,THREADS_USAGE,program,program);
+    }
+}
+
+/**
+ * returns true if a command line argument is a negative integer, which
+ *   getopt would otherwise take for a group of short options.
+ *
+ * @function   is_negative_integer
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool is_negative_integer(const char* arg)
+ *
+ * @param      arg c string to check.
+ *
+ * @return     true if arg is a minus sign followed by digits; false otherwise.
+ */
+static bool is_negative_integer(const char* arg)
+{
+    if (arg[0] != '-' || arg[1] == '\0')
+    {
+        return false;
+    }
+    for(register unsigned int i = 1; arg[i] != '\0'; ++i)
+    {
+        if (!isdigit(arg[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * loads the checkpoint file into the collector, and starts checkpointing if a
+ *   checkpoint file was passed on the command line.
+ *
+ * @function   open_checkpoint
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a missing checkpoint file is not an error, so --resume can also
+ *   be used on the first run. errors are printed to stderr.
+ *
+ * @signature  bool open_checkpoint(EngineOptions* options,
+ *   ResultCollector* collector,unsigned long* firstChunk)
+ *
+ * @param      options options of the run.
+ * @param      collector collector to load the saved factors into.
+ * @param      firstChunk set to the first chunk that is not in the checkpoint.
+ *
+ * @return     true on success; false otherwise.
+ */
+bool open_checkpoint(EngineOptions* options,ResultCollector* collector,unsigned long* firstChunk)
+{
+    *firstChunk = 0;
+    if (options->checkpointPath == 0)
+    {
+        return true;
+    }
+
+    Checkpoint* checkpoint = new Checkpoint(options->checkpointPath,options->prime.value,options->chunkSize);
+    if (options->resume && !checkpoint->resume(collector->get_results()) && errno != ENOENT)
+    {
+        fprintf(stderr,"failed to resume from %s: ",options->checkpointPath);
+        perror(0);
+        delete checkpoint;
+        return false;
+    }
+    if (!checkpoint->start())
+    {
+        fprintf(stderr,"failed to create %s: ",options->checkpointPath);
+        perror(0);
+        delete checkpoint;
+        return false;
+    }
+    *firstChunk = checkpoint->get_frontier();
+    collector->set_checkpoint(checkpoint);
+    return true;
+}
+
+/**
+ * opens the cache file if one was passed on the command line.
+ *
+ * @function   open_cache
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a cache file that cannot be opened is not an error; the run goes
+ *   on without it. errors are printed to stderr.
+ *
+ * @signature  bool open_cache(EngineOptions* options,FactorCache* cache)
+ *
+ * @param      options options of the run.
+ * @param      cache cache to open.
+ *
+ * @return     true if the cache is open; false otherwise.
+ */
+bool open_cache(EngineOptions* options,FactorCache* cache)
+{
+    if (options->cachePath == 0)
+    {
+        return false;
+    }
+    if (!cache->open(options->cachePath))
+    {
+        fprintf(stderr,"failed to open %s, running without it: ",options->cachePath);
+        perror(0);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * returns the number of chunks in the range from 1 to the number whose factors
+ *   are being found.
+ *
+ * @function   count_chunks
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       chunk i holds the candidates from i*chunkSize+1 to
+ *   (i+1)*chunkSize; the last chunk may hold fewer.
+ *
+ * @signature  unsigned long count_chunks(mpz_t number,
+ *   unsigned long chunkSize)
+ *
+ * @param      number number whose factors are being found.
+ * @param      chunkSize number of candidates in a chunk.
+ *
+ * @return     number of chunks in the range.
+ */
+unsigned long count_chunks(mpz_t number,unsigned long chunkSize)
+{
+    if (mpz_sgn(number) <= 0)
+    {
+        return 0;
+    }
+
+    Number numChunks;
+    mpz_sub_ui(numChunks.value,number,1);
+    mpz_tdiv_q_ui(numChunks.value,numChunks.value,chunkSize);
+    mpz_add_ui(numChunks.value,numChunks.value,1);
+    return mpz_get_ui(numChunks.value);
+}
+
+/**
+ * narrows the chunks to post down to the ones that overlap the range passed
+ *   with --range.
+ *
+ * @function   clip_chunks
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       does nothing without --range. if the range is above the number,
+ *   no chunks are left.
+ *
+ * @signature  void clip_chunks(EngineOptions* options,
+ *   unsigned long* firstChunk,unsigned long* numChunks)
+ *
+ * @param      options options of the run.
+ * @param      firstChunk first chunk to post; raised to the chunk holding the
+ *   start of the range.
+ * @param      numChunks one past the last chunk to post; lowered to one past
+ *   the chunk holding the end of the range.
+ */
+void clip_chunks(EngineOptions* options,unsigned long* firstChunk,unsigned long* numChunks)
+{
+    if (!options->range)
+    {
+        return;
+    }
+
+    Number chunk;
+    mpz_sub_ui(chunk.value,options->rangeLo.value,1);
+    mpz_tdiv_q_ui(chunk.value,chunk.value,options->chunkSize);
+    if (mpz_cmp_ui(chunk.value,*numChunks) >= 0)
+    {
+        *firstChunk = *numChunks;
+        return;
+    }
+    if (mpz_get_ui(chunk.value) > *firstChunk)
+    {
+        *firstChunk = mpz_get_ui(chunk.value);
+    }
+
+    mpz_sub_ui(chunk.value,options->rangeHi.value,1);
+    mpz_tdiv_q_ui(chunk.value,chunk.value,options->chunkSize);
+    if (mpz_cmp_ui(chunk.value,*numChunks) < 0)
+    {
+        *numChunks = mpz_get_ui(chunk.value)+1;
+    }
+}
+
+/**
+ * passes every factor made from the primes of a complete factorization to a
+ *   collector.
+ *
+ * @function   collect_divisors
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * with -m, the factors are made one at a time, and passed to the collector
+ *   DIVISORS_PER_CHUNK at a time as chunks of their own, so they are spilled
+ *   like the factors found by a search, and never all held in memory at once.
+ *
+ * otherwise, they are made all at once, and passed as a single chunk in
+ *   ascending order, which is what streaming them needs.
+ *
+ * @signature  void collect_divisors(EngineOptions* options,
+ *   Factorization* factorization,ResultCollector* collector)
+ *
+ * @param      options options of the run.
+ * @param      factorization complete factorization to make the factors from.
+ * @param      collector collector to pass the factors to; its frontier must
+ *   be at chunk 0.
+ */
+void collect_divisors(EngineOptions* options,Factorization* factorization,ResultCollector* collector)
+{
+    std::vector<Number*> factors;
+    if (options->memoryBudget == 0 || options->stream)
+    {
+        factorization->get_divisors(&factors);
+        collector->chunk_done(0,0,&factors);
+        return;
+    }
+
+    std::vector<unsigned long> powers;
+    Number divisor;
+    unsigned long chunk = 0;
+    factorization->first_divisor(&powers,divisor.value);
+    do
+    {
+        factors.push_back(new Number());
+        mpz_set(factors.back()->value,divisor.value);
+        if (factors.size() == DIVISORS_PER_CHUNK)
+        {
+            collector->chunk_done(0,chunk++,&factors);
+            factors.clear();
+        }
+    }
+    while(factorization->next_divisor(&powers,divisor.value));
+    collector->chunk_done(0,chunk,&factors);
+}
+
+/**
+ * completes the factorization of a number from the factors of the part of it
+ *   that was left over from the pre-analysis, and collects all of its factors.
+ *
+ * @function   join_factorization
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the primes of the left over part are all larger than the ones
+ *   found by the pre-analysis, so they are added after them in ascending
+ *   order. the factors of the number are collected with collect_divisors, so
+ *   they are kept under the memory budget.
+ *
+ * @signature  void join_factorization(EngineOptions* options,
+ *   ResultCollector* collector,Factorization* leftOver,
+ *   Factorization* factorization,ResultCollector* joined)
+ *
+ * @param      options options of the run.
+ * @param      collector finished collector holding the factors of the left
+ *   over part; leftOver must be set as its factorization.
+ * @param      leftOver empty factorization of the left over part.
+ * @param      factorization factorization of the number from the
+ *   pre-analysis.
+ * @param      joined collector to put the factors of the number in; it is
+ *   finished on return.
+ */
+void join_factorization(EngineOptions* options,ResultCollector* collector,Factorization* leftOver,Factorization* factorization,ResultCollector* joined)
+{
+    // the collector passes every factor to the left over factorization
+    Number factor;
+    while(collector->next_result(factor.value));
+
+    std::vector<Number*>* primes = leftOver->get_primes();
+    std::vector<unsigned long>* exponents = leftOver->get_exponents();
+    for(register unsigned int i = 0; i < primes->size(); ++i)
+    {
+        factorization->add_prime(primes->at(i)->value,exponents->at(i));
+    }
+    collect_divisors(options,factorization,joined);
+    joined->finish();
+}
+
+/**
+ * appends the collected factors to the writer, separated by commas.
+ *
+ * @function   append_factors
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the collector must be finished.
+ *
+ * @signature  void append_factors(ResultCollector* collector,
+ *   TeeWriter* writer)
+ *
+ * @param      collector collector to get the sorted factors from.
+ * @param      writer writer to append the factors to.
+ */
+void append_factors(ResultCollector* collector,TeeWriter* writer)
+{
+    Number factor;
+    for(register unsigned int i = 0; collector->next_result(factor.value); ++i)
+    {
+        if (i != 0)
+        {
+            writer->append(", ");
+        }
+        writer->append_number(factor.value);
+    }
+}
+
+/**
+ * prints the collected factors, and the runtime to stdout, and the log file.
+ *
+ * @function   print_results
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       in streaming mode, the factors were already written while the
+ *   run was going, so only the runtime is printed. with --count, or --sigma,
+ *   the number of factors, or their sum is printed instead of the factors.
+ *   with --first-factor, only the smallest factor above 1 is printed. if the
+ *   deadline was up, the factors found so far are printed, followed by how far
+ *   the search got.
+ *
+ * @signature  void print_results(EngineOptions* options,
+ *   ResultCollector* collector,Factorization* known,TeeWriter* writer,
+ *   bool expired,long runtime)
+ *
+ * @param      options options of the run.
+ * @param      collector collector to get the sorted factors, or their count,
+ *   and sum from.
+ * @param      known primes of the number that the collected factors are not
+ *   made from; the count, and sum of the collected factors are multiplied by
+ *   the ones of these primes. 0 if there are none.
+ * @param      writer writer to stdout, and the log file.
+ * @param      expired true if the run was cut short by the deadline.
+ * @param      runtime runtime of the run in milliseconds.
+ */
+void print_results(EngineOptions* options,ResultCollector* collector,Factorization* known,TeeWriter* writer,bool expired,long runtime)
+{
+    // every factor up to the bound was searched for; the whole number unless
+    // the deadline was up
+    Number bound;
+    mpz_set(bound.value,options->prime.value);
+    if (expired)
+    {
+        mpz_set_ui(bound.value,collector->get_frontier());
+        mpz_mul_ui(bound.value,bound.value,options->chunkSize);
+        if (mpz_cmp(bound.value,options->prime.value) > 0)
+        {
+            mpz_set(bound.value,options->prime.value);
+        }
+    }
+
+    if (options->firstFactor)
+    {
+        // a factor above the bound may not be the smallest one
+        Number factor;
+        writer->append("first factor: ");
+        if (collector->get_first_factor(factor.value) && mpz_cmp(factor.value,bound.value) <= 0)
+        {
+            writer->append_number(factor.value);
+        }
+        else
+        {
+            writer->append("none");
+        }
+        writer->append("\n");
+    }
+    else if (options->countFactors || options->sumFactors)
+    {
+        Number count;
+        Number sum;
+        collector->get_reduction(count.value,sum.value);
+        if (known != 0)
+        {
+            Number knownValue;
+            known->count_divisors(knownValue.value);
+            mpz_mul(count.value,count.value,knownValue.value);
+            known->sum_divisors(knownValue.value);
+            mpz_mul(sum.value,sum.value,knownValue.value);
+        }
+        if (options->countFactors)
+        {
+            writer->append("number of factors: ");
+            writer->append_number(count.value);
+            writer->append("\n");
+        }
+        if (options->sumFactors)
+        {
+            writer->append("sum of factors: ");
+            writer->append_number(sum.value);
+            writer->append("\n");
+        }
+    }
+    else if (!options->stream)
+    {
+        writer->append("factors: ");
+        append_factors(collector,writer);
+        writer->append("\n");
+    }
+    if (expired)
+    {
+        writer->append("deadline reached; searched up to ");
+        writer->append_number(bound.value);
+        writer->append("\n");
+    }
+
+    // print out execution results
+    char line[64];
+    snprintf(line,sizeof(line),"total runtime: %lums\n",runtime);
+    writer->append(line);
+    writer->flush();
+}
+
+/**
+ * prints the memory footprint of the run.
+ *
+ * @function   print_footprint
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       see Footprint.h for what is measured. the line is flushed whole,
+ *   like the progress lines.
+ *
+ * @signature  void print_footprint(FILE* out,FILE* logFileOut,
+ *   size_t resultBytes)
+ *
+ * @param      out file to print to.
+ * @param      logFileOut log file to print to.
+ * @param      resultBytes bytes of the factors held by the collector.
+ */
+void print_footprint(FILE* out,FILE* logFileOut,size_t resultBytes)
+{
+    char line[FOOTPRINT_LINE_SIZE];
+    footprint_format(line,sizeof(line),resultBytes);
+    fputs(line,out);
+    fputs(line,logFileOut);
+    fflush(out);
+    fflush(logFileOut);
+}
+
+/**
+ * returns the current system time in milliseconds.
+ *
+ * @function   current_timestamp
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  long current_timestamp()
+ *
+ * @return     current system time in milliseconds.
+ */
+long current_timestamp()
+{
+    struct timeval te;
+    gettimeofday(&te,0);
+    return te.tv_sec*1000L + te.tv_usec/1000;
+}
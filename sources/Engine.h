@@ -0,0 +1,375 @@
+/**
+ * header file for the engine shared by every backend. the non-template parts
+ *   are implemented in Engine.cpp
+ *
+ * @sourceFile Engine.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   Coordinator-Main.out, Agent-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the engine loads the checkpoint, produces a task for every chunk of the
+ *   range, and prints the results. how tasks reach the workers, and how their
+ *   results come back is up to a transport, which is passed to run_engine as a
+ *   template parameter, so calls into it are resolved at compile time.
+ *
+ * a transport is a class with these members:
+ *
+ *   Transport(EngineOptions* options,ResultCollector* collector)
+ *   bool start()  spawns the workers.
+ *   bool post(unsigned long chunk)  hands a chunk to the workers; blocks while
+ *     they have no room for more.
+ *   bool finish()  waits until the results of every posted chunk have been
+ *     passed to the collector, and the workers have terminated.
+ *   volatile int* get_cancel_flag()  returns a flag that cancels the workers
+ *     once it is set to non-zero; the chunks they were on, or had not started
+ *     are never passed to the collector, and finish returns early.
+ *   WorkerMetrics* get_metrics()  returns the counters of the workers, which
+ *     may be read while they are running.
+ *   Timeline* get_timeline()  returns the spans recorded by the workers, and
+ *     the producer; they are only recorded with --trace.
+ *
+ * members that return false set errno.
+ */
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "Number.h"
+#include "Reporter.h"
+#include "Deadline.h"
+#include "Semaphore.h"
+#include "TeeWriter.h"
+#include "ResultCollector.h"
+#include "FactorCache.h"
+
+#define MAX_PENDING_TASKS_PER_WORKER 10
+#define MAX_NUMBERS_PER_TASK 10000
+#define DIVISORS_PER_CHUNK 4096
+
+/**
+ * options of a run, parsed from the command line by parse_options.
+ */
+struct EngineOptions
+{
+    const char* backend;
+    const char* checkpointPath;
+    const char* batchPath;
+    const char* cachePath;
+    const char* metricsPath;
+    const char* tracePath;
+    bool footprint;
+    bool gmpArena;
+    bool spin;
+    bool resume;
+    bool respawn;
+    bool uring;
+    bool stream;
+    bool analyze;
+    bool countFactors;
+    bool sumFactors;
+    bool range;
+    Number rangeLo;
+    Number rangeHi;
+    bool firstFactor;
+    long deadline;
+    unsigned long chunkSize;
+    size_t memoryBudget;
+    Number prime;
+    FILE* logFileOut;
+    unsigned int numWorkers;
+};
+
+/**
+ * a number whose factors are being found. tasks refer to the job they are
+ *   part of, so the workers of a pool can work on more than one number at a
+ *   time. the results of every chunk of the job go to its collector.
+ *
+ * chunksLeft is decremented by the workers as they complete chunks of the
+ *   job. the worker that completes the last one sets endTime, and posts
+ *   doneSem.
+ */
+struct Job
+{
+    Job(ResultCollector* _collector);
+    Number subject;
+    ResultCollector* collector;
+    unsigned long chunksLeft;
+    long endTime;
+    Semaphore doneSem;
+};
+
+void init_options(EngineOptions* options);
+bool parse_options(int argc,char** argv,const char* backend,EngineOptions* options);
+bool open_checkpoint(EngineOptions* options,ResultCollector* collector,unsigned long* firstChunk);
+bool open_cache(EngineOptions* options,FactorCache* cache);
+unsigned long count_chunks(mpz_t number,unsigned long chunkSize);
+void clip_chunks(EngineOptions* options,unsigned long* firstChunk,unsigned long* numChunks);
+void collect_divisors(EngineOptions* options,Factorization* factorization,ResultCollector* collector);
+void join_factorization(EngineOptions* options,ResultCollector* collector,Factorization* leftOver,Factorization* factorization,ResultCollector* joined);
+void append_factors(ResultCollector* collector,TeeWriter* writer);
+void print_results(EngineOptions* options,ResultCollector* collector,Factorization* known,TeeWriter* writer,bool expired,long runtime);
+void print_footprint(FILE* out,FILE* logFileOut,size_t resultBytes);
+long current_timestamp();
+
+/**
+ * runs the engine with the passed transport.
+ *
+ * @function   run_engine
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * starts the workers, posts every chunk of the range that is not already in
+ *   the checkpoint, waits for the workers to finish, and prints the results.
+ *
+ * progress is reported by a Reporter on its own thread, so posting a chunk
+ *   costs nothing more than handing it to the transport. with -s, factors are
+ *   streamed out in ascending order while the run is going, and progress goes
+ *   to stderr instead of stdout, so stdout only holds factors. with -m, the
+ *   factors are spilled to temporary files once they take up more memory than
+ *   the budget, and merged back when they are printed; so are the factors made
+ *   from the primes when the search is skipped, or only covers what is left
+ *   over from the pre-analysis.
+ *
+ * with --cache, the number is looked up in the cache file before any workers
+ *   are started. if it is there, its factors are made from the cached primes,
+ *   and nothing is run; otherwise, its primes are picked out of the factors as
+ *   they are printed, and added to the cache at the end.
+ *
+ * unless --no-analysis is passed, the small primes of the number are divided
+ *   out, and what is left is checked for being a prime, or a prime power
+ *   before any workers are started. if that completes the factorization,
+ *   nothing is run. otherwise, without -s, only what is left is searched, and
+ *   the factors of the number are made from its primes, and the small ones.
+ *   with -s, the whole range is searched, so the factors stream in order.
+ *
+ * with --range, only the chunks that overlap the range are posted, and the
+ *   factors outside of it are dropped. with --count, or --sigma, the collector
+ *   only counts, and sums the factors. the number of factors, and their sum are
+ *   multiplicative, so when only what is left over from the pre-analysis is
+ *   searched, its count, and sum are multiplied by the ones of the primes
+ *   found by the pre-analysis.
+ *
+ * with --first-factor, the collector only keeps the smallest factor above 1,
+ *   and cancels the workers once every chunk below it is complete. if the
+ *   cache, or the pre-analysis found any primes, the smallest one is the
+ *   answer, and nothing is run. with --deadline, the workers are cancelled once
+ *   the time limit is up, no more chunks are posted, and whatever factors were
+ *   found are printed with the frontier below which the search is complete.
+ *   the whole number is searched, so the frontier is in terms of the number.
+ *
+ * with --metrics, the metrics of the workers are dumped by the reporter every
+ *   time it reports, and once more after the workers are done. with --trace,
+ *   the reporter records its reports on the timeline of the transport, which
+ *   is written once the workers are done. with --footprint, the memory the
+ *   run takes up is printed with every report, and once more after the
+ *   workers are done.
+ *
+ * @signature  template<class Transport> int run_engine(EngineOptions* options)
+ *
+ * @param      options options of the run.
+ *
+ * @return     status code.
+ */
+template<class Transport>
+int run_engine(EngineOptions* options)
+{
+    ResultCollector collector(options->numWorkers,options->memoryBudget);
+
+    // look the number up in the cache, then try to factor it without a search
+    FactorCache cache;
+    Factorization factorization(options->prime.value);
+    bool useCache = open_cache(options,&cache);
+    bool cached = useCache && cache.lookup(options->prime.value,&factorization);
+    bool searching = !cached && !(options->analyze && factorization.pre_analyze()) &&
+        !(options->firstFactor && !factorization.get_primes()->empty());
+
+    // without -s, --range, or --deadline, only the part of the number that is
+    // left over from the pre-analysis is searched. the workers search
+    // options->prime, so it is swapped with what is left over until the search
+    // is done
+    bool query = options->countFactors || options->sumFactors;
+    Factorization leftOver(factorization.get_cofactor()->value);
+    bool shrunk = searching && !options->stream && !options->range && options->deadline == 0 &&
+        mpz_cmp(factorization.get_cofactor()->value,options->prime.value) != 0;
+    if (shrunk)
+    {
+        mpz_swap(options->prime.value,factorization.get_cofactor()->value);
+    }
+
+    unsigned long numChunks = count_chunks(options->prime.value,options->chunkSize);
+    unsigned long firstChunk = 0;
+    if (searching)
+    {
+        collector.set_factorization(shrunk ? &leftOver : &factorization);
+        if (!open_checkpoint(options,&collector,&firstChunk))
+        {
+            return 1;
+        }
+        clip_chunks(options,&firstChunk,&numChunks);
+    }
+    if (options->range)
+    {
+        collector.set_range(options->rangeLo.value,options->rangeHi.value);
+    }
+    collector.set_frontier(firstChunk);
+    if (query)
+    {
+        collector.start_reduction();
+    }
+    if (options->firstFactor)
+    {
+        collector.start_first_factor();
+    }
+
+    // everything printed to stdout, and the log file from here on goes
+    // through the writer
+    fflush(stdout);
+    fflush(options->logFileOut);
+    TeeWriter writer(fileno(stdout),fileno(options->logFileOut));
+    if (options->stream)
+    {
+        collector.start_stream(&writer,firstChunk);
+    }
+
+    // without a search, the factors are made from the primes, and reported as
+    // a single chunk. a count, or sum over all the factors only needs the
+    // primes, so only the factor of what is left over, 1, is reported. the
+    // first factor is the smallest prime
+    bool split = shrunk || (!searching && query && !options->range);
+    if (!searching && !split && !options->firstFactor)
+    {
+        collect_divisors(options,&factorization,&collector);
+    }
+    else if (!searching)
+    {
+        std::vector<Number*> factors;
+        factors.push_back(new Number());
+        mpz_set_ui(factors.back()->value,1);
+        if (options->firstFactor && !factorization.get_primes()->empty())
+        {
+            factors.push_back(new Number());
+            mpz_set(factors.back()->value,factorization.get_primes()->at(0)->value);
+        }
+        collector.chunk_done(0,0,&factors);
+    }
+
+    // get start time
+    long startTime = current_timestamp();
+    bool expired = false;
+
+    if (searching)
+    {
+        // create the workers, and start reporting their progress. the workers
+        // stop early once the collector has the first factor, or the deadline
+        // is up
+        Transport transport(options,&collector);
+        if (!transport.start())
+        {
+            perror("failed to start workers");
+            return 1;
+        }
+        volatile int* cancelFlag = transport.get_cancel_flag();
+        collector.set_cancel_flag(cancelFlag);
+        Deadline deadline(cancelFlag,options->deadline);
+        if (options->deadline != 0 && !deadline.start())
+        {
+            perror("failed to start deadline");
+            return 1;
+        }
+        Reporter reporter(&collector,options->stream ? stderr : stdout,options->logFileOut,firstChunk,numChunks,options->chunkSize);
+        if (options->metricsPath != 0)
+        {
+            reporter.set_metrics(transport.get_metrics(),options->metricsPath);
+        }
+        if (options->tracePath != 0)
+        {
+            reporter.set_timeline(transport.get_timeline());
+        }
+        if (!reporter.start())
+        {
+            perror("failed to start reporter");
+        }
+
+        // create a task for every chunk, and hand it to the workers
+        for(unsigned long chunk = firstChunk; chunk < numChunks && *cancelFlag == 0; ++chunk)
+        {
+            if (!transport.post(chunk))
+            {
+                perror("failed to post task");
+                return 1;
+            }
+        }
+
+        // wait for the workers to complete every chunk
+        if (!transport.finish())
+        {
+            perror("failed to wait for workers");
+            return 1;
+        }
+        reporter.stop();
+        deadline.stop();
+        expired = deadline.expired();
+        if (options->metricsPath != 0 && !transport.get_metrics()->dump(options->metricsPath))
+        {
+            perror("failed to dump metrics");
+        }
+        if (options->tracePath != 0 && !transport.get_timeline()->write(options->tracePath))
+        {
+            perror("failed to write trace");
+        }
+        if (options->footprint)
+        {
+            print_footprint(options->stream ? stderr : stdout,options->logFileOut,collector.get_memory_used());
+        }
+    }
+
+    // get end time
+    long endTime = current_timestamp();
+
+    collector.finish();
+    if (shrunk)
+    {
+        mpz_swap(options->prime.value,factorization.get_cofactor()->value);
+    }
+    if (shrunk && !query)
+    {
+        ResultCollector joined(options->numWorkers,options->memoryBudget);
+        join_factorization(options,&collector,&leftOver,&factorization,&joined);
+        print_results(options,&joined,0,&writer,expired,endTime-startTime);
+    }
+    else
+    {
+        print_results(options,&collector,split ? &factorization : 0,&writer,expired,endTime-startTime);
+    }
+
+    // the primes were picked out of the factors as they were printed. a run
+    // that was cut short may have missed some of them
+    if (useCache && !cached && !expired && factorization.is_complete() &&
+        !cache.store(options->prime.value,&factorization))
+    {
+        perror("failed to add the factorization to the cache");
+    }
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,403 @@
+/**
+ * implementation of the FactorCache class declared in FactorCache.h
+ *
+ * @sourceFile FactorCache.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @class      FactorCache
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the numbers are hashed with 64-bit FNV-1a over their raw
+ *   format.
+ */
+#include "FactorCache.h"
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static uint64_t hash_key(std::string& key);
+
+/**
+ * instantiates a FactorCache instance.
+ *
+ * @class      FactorCache
+ *
+ * @method     FactorCache
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       no file is opened until open is called.
+ *
+ * @signature  FactorCache::FactorCache()
+ *
+ * @return     an instance of a FactorCache.
+ */
+FactorCache::FactorCache()
+    :fd(-1)
+    ,header((FactorCacheHeader*) MAP_FAILED)
+    ,slots(0)
+    ,mappedSize(sizeof(FactorCacheHeader)+FACTOR_CACHE_SLOTS*sizeof(FactorCacheSlot))
+{
+}
+
+/**
+ * destructor for the FactorCache; unmaps the index, and closes the file.
+ *
+ * @class      FactorCache
+ *
+ * @method     ~FactorCache
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  FactorCache::~FactorCache()
+ */
+FactorCache::~FactorCache()
+{
+    release();
+}
+
+/**
+ * opens the cache file, creating it if it does not exist, and maps its index
+ *   into memory.
+ *
+ * @class      FactorCache
+ *
+ * @method     open
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the file is created, and its header written under the lock, so
+ *   processes opening it at the same time never see it half made.
+ *
+ * @signature  bool FactorCache::open(const char* path)
+ *
+ * @param      path path to the cache file.
+ *
+ * @return     true on success; false otherwise, with errno set. EINVAL if the
+ *   file is not a cache file.
+ */
+bool FactorCache::open(const char* path)
+{
+    fd = ::open(path,O_RDWR|O_CREAT,0644);
+    if (fd < 0 || flock(fd,LOCK_EX) != 0)
+    {
+        release();
+        return false;
+    }
+
+    // set up a new file, or check that an existing one is a cache file
+    struct stat info;
+    FactorCacheHeader newHeader;
+    bool valid = fstat(fd,&info) == 0;
+    if (valid && info.st_size == 0)
+    {
+        memcpy(newHeader.magic,FACTOR_CACHE_MAGIC,sizeof(newHeader.magic));
+        newHeader.numSlots = FACTOR_CACHE_SLOTS;
+        newHeader.dataEnd = mappedSize;
+        valid = ftruncate(fd,mappedSize) == 0 &&
+            pwrite(fd,&newHeader,sizeof(newHeader),0) == sizeof(newHeader);
+    }
+    else if (valid)
+    {
+        ssize_t length = pread(fd,&newHeader,sizeof(newHeader),0);
+        valid = length == sizeof(newHeader) &&
+            memcmp(newHeader.magic,FACTOR_CACHE_MAGIC,sizeof(newHeader.magic)) == 0 &&
+            newHeader.numSlots == FACTOR_CACHE_SLOTS && (off_t) mappedSize <= info.st_size;
+        if (!valid && length >= 0)
+        {
+            errno = EINVAL;
+        }
+    }
+    if (valid)
+    {
+        header = (FactorCacheHeader*) mmap(0,mappedSize,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+        valid = header != MAP_FAILED;
+    }
+
+    int error = errno;
+    flock(fd,LOCK_UN);
+    if (!valid)
+    {
+        release();
+        errno = error;
+        return false;
+    }
+    slots = (FactorCacheSlot*) (header+1);
+    return true;
+}
+
+/**
+ * looks up the factorization of a number.
+ *
+ * @class      FactorCache
+ *
+ * @method     lookup
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       takes no lock; costs a probe of the mapped index, and a single
+ *   read of the record.
+ *
+ * @signature  bool FactorCache::lookup(mpz_t subject,
+ *   Factorization* factorization)
+ *
+ * @param      subject number to look up.
+ * @param      factorization empty factorization of the number; the primes of
+ *   the number are added to it if it is found.
+ *
+ * @return     true if the complete factorization was found; false otherwise.
+ */
+bool FactorCache::lookup(mpz_t subject,Factorization* factorization)
+{
+    std::string key;
+    append_raw(key,subject);
+    uint64_t hash = hash_key(key);
+
+    for(register uint64_t i = 0; i < FACTOR_CACHE_SLOTS; ++i)
+    {
+        FactorCacheSlot* slot = &slots[(hash+i)%FACTOR_CACHE_SLOTS];
+        uint64_t offset = __atomic_load_n(&slot->offset,__ATOMIC_ACQUIRE);
+        if (offset == 0)
+        {
+            return false;
+        }
+        if (slot->hash != hash || slot->length < key.size())
+        {
+            continue;
+        }
+
+        // read the record, and make sure it is for the same number
+        std::string record(slot->length,'\0');
+        if (pread(fd,&record[0],record.size(),offset) != (ssize_t) record.size())
+        {
+            return false;
+        }
+        if (record.compare(0,key.size(),key) != 0)
+        {
+            continue;
+        }
+
+        size_t position = key.size();
+        Number count;
+        Number prime;
+        Number exponent;
+        if (!parse_raw(record,&position,count.value))
+        {
+            return false;
+        }
+        for(register unsigned long j = mpz_get_ui(count.value); j > 0; --j)
+        {
+            if (!parse_raw(record,&position,prime.value) ||
+                !parse_raw(record,&position,exponent.value) ||
+                !factorization->add_prime(prime.value,mpz_get_ui(exponent.value)))
+            {
+                return false;
+            }
+        }
+        return factorization->is_complete();
+    }
+    return false;
+}
+
+/**
+ * adds the factorization of a number to the cache.
+ *
+ * @class      FactorCache
+ *
+ * @method     store
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       appends the record, and fills in a slot while holding the lock.
+ *   a number that is already in the cache is not added again.
+ *
+ * @signature  bool FactorCache::store(mpz_t subject,
+ *   Factorization* factorization)
+ *
+ * @param      subject number that was factored.
+ * @param      factorization complete factorization of the number.
+ *
+ * @return     true if the number is in the cache; false otherwise, with errno
+ *   set. ENOSPC if the index is full.
+ */
+bool FactorCache::store(mpz_t subject,Factorization* factorization)
+{
+    if (!factorization->is_complete())
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    // make the record
+    std::string record;
+    append_raw(record,subject);
+    size_t keySize = record.size();
+    uint64_t hash = hash_key(record);
+    std::vector<Number*>* primes = factorization->get_primes();
+    std::vector<unsigned long>* exponents = factorization->get_exponents();
+    Number number;
+    mpz_set_ui(number.value,primes->size());
+    append_raw(record,number.value);
+    for(register unsigned int i = 0; i < primes->size(); ++i)
+    {
+        append_raw(record,primes->at(i)->value);
+        mpz_set_ui(number.value,exponents->at(i));
+        append_raw(record,number.value);
+    }
+
+    if (flock(fd,LOCK_EX) != 0)
+    {
+        return false;
+    }
+
+    // find the slot of the number, or an empty one
+    FactorCacheSlot* slot = 0;
+    bool found = false;
+    for(register uint64_t i = 0; i < FACTOR_CACHE_SLOTS && slot == 0; ++i)
+    {
+        FactorCacheSlot* candidate = &slots[(hash+i)%FACTOR_CACHE_SLOTS];
+        if (candidate->offset == 0)
+        {
+            slot = candidate;
+        }
+        else if (candidate->hash == hash && candidate->length == record.size())
+        {
+            std::string existing(keySize,'\0');
+            found = pread(fd,&existing[0],keySize,candidate->offset) == (ssize_t) keySize &&
+                existing.compare(0,keySize,record,0,keySize) == 0;
+            slot = found ? candidate : 0;
+        }
+    }
+
+    // append the record, and publish it in the slot
+    bool success = found;
+    errno = ENOSPC;
+    if (slot != 0 && !found)
+    {
+        uint64_t offset = header->dataEnd;
+        success = pwrite(fd,record.data(),record.size(),offset) == (ssize_t) record.size();
+        if (success)
+        {
+            header->dataEnd = offset+record.size();
+            slot->hash = hash;
+            slot->length = record.size();
+            __atomic_store_n(&slot->offset,offset,__ATOMIC_RELEASE);
+        }
+    }
+
+    int error = errno;
+    flock(fd,LOCK_UN);
+    errno = error;
+    return success;
+}
+
+/**
+ * unmaps the index, and closes the file if they are open.
+ *
+ * @class      FactorCache
+ *
+ * @method     release
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void FactorCache::release()
+ */
+void FactorCache::release()
+{
+    if (header != MAP_FAILED)
+    {
+        munmap(header,mappedSize);
+        header = (FactorCacheHeader*) MAP_FAILED;
+        slots = 0;
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * hashes the raw format of a number.
+ *
+ * @function   hash_key
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       64-bit FNV-1a.
+ *
+ * @signature  uint64_t hash_key(std::string& key)
+ *
+ * @param      key raw format of the number.
+ *
+ * @return     hash of the number.
+ */
+static uint64_t hash_key(std::string& key)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for(register size_t i = 0; i < key.size(); ++i)
+    {
+        hash ^= (unsigned char) key[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
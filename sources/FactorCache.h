@@ -0,0 +1,86 @@
+/**
+ * header file for the FactorCache class. implementation is in
+ *   FactorCache.cpp
+ *
+ * @sourceFile FactorCache.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * an on-disk cache of prime factorizations, keyed by the number that was
+ *   factored, and shared by every process on the host that opens the same
+ *   file. the file starts with a header, and a hash index of FACTOR_CACHE_SLOTS
+ *   slots, which is mapped into memory, followed by the records, which are
+ *   only ever appended.
+ *
+ * a record holds the number, the count of its primes, then each prime
+ *   followed by its exponent, all in the format written by mpz_out_raw. a slot
+ *   holds the hash of the number, and the offset, and length of its record; 0
+ *   for the offset if the slot is empty. collisions are resolved by probing the
+ *   next slots.
+ *
+ * writers hold an exclusive flock on the file while they append a record, and
+ *   fill in its slot. the offset of the slot is set last, with a release store,
+ *   so readers never need the lock; once they see the offset, the rest of the
+ *   slot, and the record are already written. once the index is full, new
+ *   factorizations are not cached.
+ */
+#ifndef FACTORCACHE_H
+#define FACTORCACHE_H
+
+#include <stdint.h>
+#include "Factorization.h"
+
+#define FACTOR_CACHE_SLOTS 65536
+#define FACTOR_CACHE_MAGIC "FCACHE01"
+
+/**
+ * the start of the cache file.
+ */
+struct FactorCacheHeader
+{
+    char magic[8];
+    uint64_t numSlots;
+    uint64_t dataEnd;
+};
+
+/**
+ * a slot of the hash index.
+ */
+struct FactorCacheSlot
+{
+    uint64_t hash;
+    uint64_t length;
+    uint64_t offset;
+};
+
+class FactorCache
+{
+public:
+
+    FactorCache();
+    ~FactorCache();
+    bool open(const char* path);
+    bool lookup(mpz_t subject,Factorization* factorization);
+    bool store(mpz_t subject,Factorization* factorization);
+
+private:
+
+    void release();
+
+    int fd;
+    FactorCacheHeader* header;
+    FactorCacheSlot* slots;
+    size_t mappedSize;
+};
+
+#endif
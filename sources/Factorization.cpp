@@ -0,0 +1,559 @@
+/**
+ * implementation of the Factorization class declared in Factorization.h
+ *
+ * @sourceFile Factorization.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @class      Factorization
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ */
+#include "Factorization.h"
+#include <algorithm>
+
+/**
+ * instantiates a Factorization instance with no primes.
+ *
+ * @class      Factorization
+ *
+ * @method     Factorization
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the factorization of 1 is complete from the start.
+ *
+ * @signature  Factorization::Factorization(mpz_t _subject)
+ *
+ * @param      _subject number that is factored.
+ *
+ * @return     an instance of a Factorization.
+ */
+Factorization::Factorization(mpz_t _subject)
+{
+    mpz_set(cofactor.value,_subject);
+}
+
+/**
+ * destructor for the Factorization. deletes the primes.
+ *
+ * @class      Factorization
+ *
+ * @method     ~Factorization
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  Factorization::~Factorization()
+ */
+Factorization::~Factorization()
+{
+    for(register unsigned int i = 0; i < primes.size(); ++i)
+    {
+        delete primes[i];
+    }
+}
+
+/**
+ * adds the next factor of the number in ascending order.
+ *
+ * @class      Factorization
+ *
+ * @method     add_divisor
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       factors that are not prime are skipped. see Factorization.h for
+ *   how they are told apart. does nothing once the factorization is complete.
+ *
+ * @signature  void Factorization::add_divisor(mpz_t divisor)
+ *
+ * @param      divisor next factor of the number.
+ */
+void Factorization::add_divisor(mpz_t divisor)
+{
+    if (mpz_cmp_ui(divisor,1) <= 0 || mpz_cmp_ui(cofactor.value,1) <= 0 ||
+        !mpz_divisible_p(cofactor.value,divisor))
+    {
+        return;
+    }
+
+    unsigned long exponent = 0;
+    while(mpz_divisible_p(cofactor.value,divisor))
+    {
+        mpz_divexact(cofactor.value,cofactor.value,divisor);
+        ++exponent;
+    }
+    primes.push_back(new Number());
+    mpz_set(primes.back()->value,divisor);
+    exponents.push_back(exponent);
+}
+
+/**
+ * adds a prime, and its exponent to the factorization.
+ *
+ * @class      Factorization
+ *
+ * @method     add_prime
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       primes must be added in ascending order. the prime is not
+ *   checked for primality; it is only checked that its power divides what is
+ *   left of the number.
+ *
+ * @signature  bool Factorization::add_prime(mpz_t prime,
+ *   unsigned long exponent)
+ *
+ * @param      prime prime factor of the number.
+ * @param      exponent number of times the prime divides the number.
+ *
+ * @return     true if the power of the prime divides what is left of the
+ *   number; false otherwise, and the prime is not added.
+ */
+bool Factorization::add_prime(mpz_t prime,unsigned long exponent)
+{
+    Number power;
+    mpz_pow_ui(power.value,prime,exponent);
+    if (mpz_cmp_ui(prime,1) <= 0 || exponent == 0 ||
+        mpz_sgn(cofactor.value) == 0 || !mpz_divisible_p(cofactor.value,power.value))
+    {
+        return false;
+    }
+
+    mpz_divexact(cofactor.value,cofactor.value,power.value);
+    primes.push_back(new Number());
+    mpz_set(primes.back()->value,prime);
+    exponents.push_back(exponent);
+    return true;
+}
+
+/**
+ * finds as many primes of the number as it can without searching for its
+ *   factors.
+ *
+ * @class      Factorization
+ *
+ * @method     pre_analyze
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * must be called before any primes are added. the primes below
+ *   PRE_ANALYSIS_BOUND are divided out first; trial division stops early once
+ *   the square of the divisor is larger than what is left, because what is
+ *   left is then 1, or a prime.
+ *
+ * what is left after that has no prime factors below PRE_ANALYSIS_BOUND. it is
+ *   added as a prime if it is one; if it is a perfect power, it is replaced by
+ *   its smallest root, and the root is added if it is a prime.
+ *
+ * @signature  bool Factorization::pre_analyze()
+ *
+ * @return     true if the factorization is complete; false otherwise, and the
+ *   factors of the cofactor still have to be searched for.
+ */
+bool Factorization::pre_analyze()
+{
+    if (mpz_sgn(cofactor.value) <= 0)
+    {
+        return false;
+    }
+
+    // divide out the small primes. composite divisors never divide what is
+    // left, because their prime factors are already divided out
+    for(register unsigned long i = 2; i < PRE_ANALYSIS_BOUND; i += (i == 2 ? 1 : 2))
+    {
+        if (mpz_cmp_ui(cofactor.value,i*i) < 0)
+        {
+            break;
+        }
+        if (mpz_divisible_ui_p(cofactor.value,i))
+        {
+            unsigned long exponent = 0;
+            while(mpz_divisible_ui_p(cofactor.value,i))
+            {
+                mpz_divexact_ui(cofactor.value,cofactor.value,i);
+                ++exponent;
+            }
+            primes.push_back(new Number());
+            mpz_set_ui(primes.back()->value,i);
+            exponents.push_back(exponent);
+        }
+    }
+    if (mpz_cmp_ui(cofactor.value,1) == 0)
+    {
+        return true;
+    }
+
+    // check if what is left is a prime, or a power of one
+    Number root;
+    Number divisor;
+    mpz_set(root.value,cofactor.value);
+    unsigned long exponent = 1;
+    if (mpz_perfect_power_p(root.value))
+    {
+        unsigned long maxExponent = mpz_sizeinbase(root.value,2);
+        for(register unsigned long i = 2; i <= maxExponent; ++i)
+        {
+            while(mpz_root(divisor.value,root.value,i) != 0)
+            {
+                mpz_set(root.value,divisor.value);
+                exponent *= i;
+                maxExponent = mpz_sizeinbase(root.value,2);
+            }
+        }
+    }
+    if (mpz_probab_prime_p(root.value,PRE_ANALYSIS_REPS) != 0)
+    {
+        add_prime(root.value,exponent);
+    }
+    return is_complete();
+}
+
+/**
+ * returns true if the primes multiply up to the number.
+ *
+ * @class      Factorization
+ *
+ * @method     is_complete
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the factorization of a number below 1 is never complete.
+ *
+ * @signature  bool Factorization::is_complete()
+ *
+ * @return     true if the factorization is complete; false otherwise.
+ */
+bool Factorization::is_complete()
+{
+    return mpz_cmp_ui(cofactor.value,1) == 0;
+}
+
+/**
+ * returns what is left of the number once its known primes are divided out.
+ *
+ * @class      Factorization
+ *
+ * @method     get_cofactor
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  Number* Factorization::get_cofactor()
+ *
+ * @return     pointer to the cofactor.
+ */
+Number* Factorization::get_cofactor()
+{
+    return &cofactor;
+}
+
+/**
+ * appends every factor of the number to the passed vector in ascending
+ *   order.
+ *
+ * @class      Factorization
+ *
+ * @method     get_divisors
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the factors are every product of the powers of the primes. the
+ *   caller takes ownership of them. the factorization must be complete.
+ *
+ * @signature  void Factorization::get_divisors(
+ *   std::vector<Number*>* divisors)
+ *
+ * @param      divisors vector to append the factors to.
+ */
+void Factorization::get_divisors(std::vector<Number*>* divisors)
+{
+    size_t first = divisors->size();
+    divisors->push_back(new Number());
+    mpz_set_ui(divisors->back()->value,1);
+
+    for(register unsigned int i = 0; i < primes.size(); ++i)
+    {
+        // multiply every factor found so far by each power of the prime
+        size_t last = divisors->size();
+        for(register size_t j = first; j < last; ++j)
+        {
+            Number* divisor = divisors->at(j);
+            for(register unsigned long k = 0; k < exponents[i]; ++k)
+            {
+                Number* multiple = new Number();
+                mpz_mul(multiple->value,divisor->value,primes[i]->value);
+                divisors->push_back(multiple);
+                divisor = multiple;
+            }
+        }
+    }
+
+    std::sort(divisors->begin()+first,divisors->end(),[](Number* i,Number* j)
+    {
+        return mpz_cmp(i->value,j->value) < 0;
+    });
+}
+
+/**
+ * starts making the factors of the number one at a time.
+ *
+ * @class      Factorization
+ *
+ * @method     first_divisor
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the first factor is 1. the factorization must be complete.
+ *
+ * @signature  void Factorization::first_divisor(
+ *   std::vector<unsigned long>* powers,mpz_t divisor)
+ *
+ * @param      powers set to the power of each prime in the factor; pass it to
+ *   next_divisor unchanged.
+ * @param      divisor set to the first factor.
+ */
+void Factorization::first_divisor(std::vector<unsigned long>* powers,mpz_t divisor)
+{
+    powers->assign(primes.size(),0);
+    mpz_set_ui(divisor,1);
+}
+
+/**
+ * makes the next factor of the number.
+ *
+ * @class      Factorization
+ *
+ * @method     next_divisor
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the powers are counted up like the digits of an odometer, each
+ *   one wrapping around past the exponent of its prime, so every factor comes
+ *   up once. the factor is multiplied by the prime whose power goes up, and
+ *   divided by the full power of every prime that wraps around.
+ *
+ * @signature  bool Factorization::next_divisor(
+ *   std::vector<unsigned long>* powers,mpz_t divisor)
+ *
+ * @param      powers powers of the primes in the previous factor, from
+ *   first_divisor, or the last call.
+ * @param      divisor previous factor; set to the next one.
+ *
+ * @return     true if there was a next factor; false once every factor was
+ *   made.
+ */
+bool Factorization::next_divisor(std::vector<unsigned long>* powers,mpz_t divisor)
+{
+    for(register unsigned int i = 0; i < primes.size(); ++i)
+    {
+        if (powers->at(i) < exponents[i])
+        {
+            ++powers->at(i);
+            mpz_mul(divisor,divisor,primes[i]->value);
+            return true;
+        }
+
+        // wrap the power of this prime back to 0, and carry into the next one
+        Number power;
+        mpz_pow_ui(power.value,primes[i]->value,exponents[i]);
+        mpz_divexact(divisor,divisor,power.value);
+        powers->at(i) = 0;
+    }
+    return false;
+}
+
+/**
+ * calculates the number of factors made from the primes of the factorization.
+ *
+ * @class      Factorization
+ *
+ * @method     count_divisors
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the product of one more than each exponent. the cofactor is left
+ *   out, so this is the number of factors of the number only if the
+ *   factorization is complete.
+ *
+ * @signature  void Factorization::count_divisors(mpz_t count)
+ *
+ * @param      count set to the number of factors.
+ */
+void Factorization::count_divisors(mpz_t count)
+{
+    mpz_set_ui(count,1);
+    for(register unsigned int i = 0; i < exponents.size(); ++i)
+    {
+        mpz_mul_ui(count,count,exponents[i]+1);
+    }
+}
+
+/**
+ * calculates the sum of the factors made from the primes of the
+ *   factorization.
+ *
+ * @class      Factorization
+ *
+ * @method     sum_divisors
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the product of (p^(e+1)-1)/(p-1) for each prime p, and its
+ *   exponent e. the cofactor is left out, as with count_divisors.
+ *
+ * @signature  void Factorization::sum_divisors(mpz_t sum)
+ *
+ * @param      sum set to the sum of the factors.
+ */
+void Factorization::sum_divisors(mpz_t sum)
+{
+    Number term;
+    Number prime;
+    mpz_set_ui(sum,1);
+    for(register unsigned int i = 0; i < primes.size(); ++i)
+    {
+        mpz_pow_ui(term.value,primes[i]->value,exponents[i]+1);
+        mpz_sub_ui(term.value,term.value,1);
+        mpz_sub_ui(prime.value,primes[i]->value,1);
+        mpz_divexact(term.value,term.value,prime.value);
+        mpz_mul(sum,sum,term.value);
+    }
+}
+
+/**
+ * returns the primes of the factorization in ascending order.
+ *
+ * @class      Factorization
+ *
+ * @method     get_primes
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  std::vector<Number*>* Factorization::get_primes()
+ *
+ * @return     pointer to the vector of primes.
+ */
+std::vector<Number*>* Factorization::get_primes()
+{
+    return &primes;
+}
+
+/**
+ * returns the exponents of the primes of the factorization.
+ *
+ * @class      Factorization
+ *
+ * @method     get_exponents
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the exponent of each prime is at the same index as the prime.
+ *
+ * @signature  std::vector<unsigned long>* Factorization::get_exponents()
+ *
+ * @return     pointer to the vector of exponents.
+ */
+std::vector<unsigned long>* Factorization::get_exponents()
+{
+    return &exponents;
+}
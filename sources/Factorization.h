@@ -0,0 +1,72 @@
+/**
+ * header file for the Factorization class. implementation is in
+ *   Factorization.cpp
+ *
+ * @sourceFile Factorization.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the prime factorization of a number. it is either built from all the
+ *   factors of the number passed to add_divisor in ascending order, or from
+ *   its primes passed to add_prime, and can list all the factors of the
+ *   number again with get_divisors. first_divisor, and next_divisor make them
+ *   one at a time instead, in no particular order, so they never all have to
+ *   be in memory.
+ *
+ * when the factors are passed in ascending order, the smallest one above 1 is
+ *   prime. it is divided out of the number as many times as it can be, and
+ *   every later factor that still divides what is left of the number is prime
+ *   too, because all of its smaller prime factors were already divided out.
+ *
+ * pre_analyze finds what it can of the factorization without a search. it
+ *   divides out the primes below PRE_ANALYSIS_BOUND, then checks if what is
+ *   left of the number is a prime, or a power of a prime. primes are found with
+ *   mpz_probab_prime_p, so a composite could be taken for a prime with a
+ *   probability well below 4^-PRE_ANALYSIS_REPS.
+ */
+#ifndef FACTORIZATION_H
+#define FACTORIZATION_H
+
+#include <vector>
+#include "Number.h"
+
+#define PRE_ANALYSIS_BOUND 10000
+#define PRE_ANALYSIS_REPS 25
+
+class Factorization
+{
+public:
+
+    Factorization(mpz_t _subject);
+    ~Factorization();
+    void add_divisor(mpz_t divisor);
+    bool add_prime(mpz_t prime,unsigned long exponent);
+    bool pre_analyze();
+    bool is_complete();
+    Number* get_cofactor();
+    void get_divisors(std::vector<Number*>* divisors);
+    void first_divisor(std::vector<unsigned long>* powers,mpz_t divisor);
+    bool next_divisor(std::vector<unsigned long>* powers,mpz_t divisor);
+    void count_divisors(mpz_t count);
+    void sum_divisors(mpz_t sum);
+    std::vector<Number*>* get_primes();
+    std::vector<unsigned long>* get_exponents();
+
+private:
+
+    Number cofactor;
+    std::vector<Number*> primes;
+    std::vector<unsigned long> exponents;
+};
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * the program with a selectable backend.
+ *
+ * usage: ./Factors-Main [-b|--backend threads|processes] [-r|--respawn]
+ *   [-u|--uring] [-s|--stream] [-m|--memory-budget bytes[k|m|g]]
+ *   [-c|--checkpoint file] [--resume] [--cache file] [--no-analysis]
+ *   [--count] [--sigma] [--range a b] [--first-factor] [--deadline ms]
+ *   [--chunk-size n] [--metrics file] [--trace file] [--footprint]
+ *   [--gmp-arena] [--spin] [integer] [log file] [num workers]
+ *        ./Factors-Main [-b|--backend threads] [-m|--memory-budget bytes[k|m|g]]
+ *   [--cache file] [--no-analysis] [--chunk-size n] [--metrics file]
+ *   [--trace file] [--footprint] [--gmp-arena] [--spin] --batch file|-
+ *   [log file] [num workers]
+ *
+ * finds all the factors of the passed integer, using worker threads, or worker
+ *   processes as chosen by -b. threads are used by default.
+ *
+ * if a worker process dies while working on a chunk of the range, the chunk is
+ *   issued again to another worker. with -r, the dead worker is also replaced.
+ *   with -u, the parent writes tasks and reads results through io_uring, if it
+ *   is available. -r, and -u only apply to the processes backend.
+ *
+ * with -c, progress is periodically saved to the checkpoint file. with
+ *   --resume, the run continues from the progress saved in the checkpoint file.
+ *
+ * with -s, each factor is printed on a line of its own as soon as all the
+ *   factors below it are known, instead of all together at the end. progress
+ *   is printed to stderr instead of stdout.
+ *
+ * with -m, once the factors found take up more memory than the budget, they
+ *   are spilled to temporary files, and merged back when they are printed.
+ *
+ * with --batch, the factors of every integer in the file, one per line, are
+ *   found using the same worker threads, and printed in the order of the file,
+ *   each with its runtime. - reads the integers from stdin. only the threads
+ *   backend can run batches. an integer may be followed by a priority from 1
+ *   to 16; while integers share the workers, each gets a share of them in
+ *   proportion to its priority.
+ *
+ * with --cache, the factorization of the integer is looked up in the cache
+ *   file first, and the workers are only started if it is not there; it is
+ *   added to the cache once its factors are found. the cache file can be
+ *   shared by any number of runs at the same time.
+ *
+ * the small primes of the integer are divided out, and what is left is
+ *   checked for being a prime, or a prime power first; if that finds all of
+ *   its primes, no workers are started. --no-analysis turns this off.
+ *
+ * with --count, or --sigma, only the number of factors, or their sum is
+ *   printed; the factors are not kept. with --range, only the factors from a
+ *   to b are found. they can be used together, and cannot be used with -c.
+ *
+ * with --first-factor, only the smallest factor above 1 is printed, and the
+ *   workers stop as soon as it is known. with --deadline, the workers stop once
+ *   the time limit in milliseconds is up, and the factors found so far are
+ *   printed, with how far the search got.
+ *
+ * --chunk-size sets how many candidates are in each task handed to a worker.
+ *
+ * with --metrics, the counters of every worker, and a histogram of its task
+ *   latencies are dumped to the file at exit, and every second while a single
+ *   integer is searched; as json if the file name ends in .json, or as
+ *   OpenMetrics text otherwise.
+ *
+ * with --trace, what every worker, the thread that posts the tasks, and the
+ *   progress reporter spent their time on is written to the file at exit as a
+ *   Chrome trace, which can be opened in chrome://tracing, or
+ *   ui.perfetto.dev.
+ *
+ * with --footprint, every progress line is followed by the memory the run
+ *   takes up, which is printed once more at exit: the resident, and
+ *   proportional set size of the program, and of its worker processes, the
+ *   bytes allocated by GMP, the bytes of the factors held in memory, and how
+ *   full the task queue, or pipes are.
+ *
+ * with --gmp-arena, GMP allocates its numbers from pools kept by every worker
+ *   thread, or process, instead of from malloc, and the pools are trimmed
+ *   between tasks.
+ *
+ * with --spin, the locks, and semaphores shared by the workers are spun on for
+ *   a while before sleeping on them, instead of only sleeping; see SpinWait.h.
+ *
+ * anything that is printed to stdout is also printed to the specified file.
+ *
+ * @sourceFile Factors-Main.cpp
+ *
+ * @program    Factors-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       see Engine.h for how the backends plug into the engine.
+ */
+#include <string.h>
+#include "Engine.h"
+#include "BatchRunner.h"
+#include "ThreadTransport.h"
+#include "ProcessTransport.h"
+
+/**
+ * entry point of the program.
+ *
+ * @function   main
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int main(int argc,char** argv)
+ *
+ * @param      argc number of command line arguments
+ * @param      argv array of c strings of command line arguments
+ *
+ * @return     status code.
+ */
+int main(int argc,char** argv)
+{
+    EngineOptions options;
+    if (!parse_options(argc,argv,0,&options))
+    {
+        return 1;
+    }
+
+    int status;
+    if (options.batchPath != 0)
+    {
+        BatchRunner runner(&options);
+        status = runner.run();
+    }
+    else if (strcmp(options.backend,"processes") == 0)
+    {
+        status = run_engine<ProcessTransport>(&options);
+    }
+    else
+    {
+        status = run_engine<ThreadTransport>(&options);
+    }
+
+    fclose(options.logFileOut);
+    return status;
+}
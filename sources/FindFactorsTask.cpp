@@ -25,9 +25,49 @@
  *
  * when this object is destroyed, all the objects in its results vector are also
  *   destroyed.
+ *
+ * a task with a few small numbers tests every candidate in the range with a
+ *   division. a task with many, or large numbers uses product, and remainder
+ *   trees instead, so the numbers share most of the work:
+ *
+ *   1. the candidates are multiplied together in a product tree; the product
+ *      of every candidate in the range is at its root. the leaves are the
+ *      products of blocks of REMAINDER_TREE_LEAF_SIZE consecutive candidates.
+ *   2. the numbers are multiplied together in another product tree, and the
+ *      product of the candidates is pushed down it as a remainder tree, which
+ *      leaves the product of the candidates mod each number at the leaves.
+ *      the gcd of that, and the number is the part of the number made of
+ *      factors shared with the candidates.
+ *   3. for each number, the gcd is pushed down the product tree of the
+ *      candidates, taking its gcd with every node. a candidate divides the
+ *      number only if it divides the gcd at every node above it, so a subtree
+ *      is skipped once the gcd is smaller than its smallest candidate. at a
+ *      leaf, each candidate of the block that divides the gcd divides the
+ *      number.
+ *
+ * most of the work is in a few large multiplications, and divisions, which
+ *   gmp does a lot faster than as many small ones.
+ *
+ * a task that does trial division divides the limbs of its numbers by batches
+ *   of candidates at once, with inverses of the candidates worked out once per
+ *   batch; see MultiModulus.h. nothing is allocated per candidate, and the
+ *   limbs of a number are read once per batch, rather than once per candidate.
+ *
+ * the fixed width kernel, forced with set_kernel, does its trial division
+ *   with BigInt instead of mpz_t. every number is held by a BigInt as wide as
+ *   the longest of them, and the candidate by another, and a candidate that
+ *   fits in a limb is tested by dividing a limb at a time. the width is a
+ *   template parameter; the instantiation is picked from the longest number
+ *   when the task runs.
  */
 #include "FindFactorsTask.h"
+#include "BigInt.h"
+#include "MultiModulus.h"
 #include <stdlib.h>
+#include <algorithm>
+
+static void build_product_tree(std::vector<std::vector<mpz_t*> >* tree);
+static void clear_numbers(std::vector<mpz_t*>* numbers);
 
 /**
  * constructor for the FindFactorsTask class.
@@ -55,10 +95,59 @@
  * @return     an instance of FindFactorsTask.
  */
 FindFactorsTask::FindFactorsTask(mpz_t _testSubject,mpz_t _upperBound,mpz_t _lowerBound)
+    :results(1)
+    ,cancelFlag(0)
+    ,kernel(KERNEL_AUTO)
+{
+    mpz_init_set(upperBound,_upperBound);
+    mpz_init_set(lowerBound,_lowerBound);
+
+    mpz_t* testSubject = (mpz_t*) malloc(sizeof(mpz_t));
+    mpz_init_set(*testSubject,_testSubject);
+    testSubjects.push_back(testSubject);
+}
+
+/**
+ * constructor for the FindFactorsTask class, for finding the factors of more
+ *   than one number at a time.
+ *
+ * @class      FindFactorsTask
+ *
+ * @method     FindFactorsTask
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the numbers are copied, and must be larger than 0.
+ *
+ * @signature  FindFactorsTask::FindFactorsTask(
+ *   std::vector<mpz_t*>* _testSubjects,mpz_t _upperBound,mpz_t _lowerBound)
+ *
+ * @param      _testSubjects numbers to find factors for.
+ * @param      _upperBound upper bound of the range to check for factors.
+ * @param      _lowerBound lower bound of the range to check for factors.
+ *
+ * @return     an instance of FindFactorsTask.
+ */
+FindFactorsTask::FindFactorsTask(std::vector<mpz_t*>* _testSubjects,mpz_t _upperBound,mpz_t _lowerBound)
+    :results(_testSubjects->size())
+    ,cancelFlag(0)
+    ,kernel(KERNEL_AUTO)
 {
     mpz_init_set(upperBound,_upperBound);
     mpz_init_set(lowerBound,_lowerBound);
-    mpz_init_set(testSubject,_testSubject);
+
+    for(register unsigned int i = 0; i < _testSubjects->size(); ++i)
+    {
+        mpz_t* testSubject = (mpz_t*) malloc(sizeof(mpz_t));
+        mpz_init_set(*testSubject,*_testSubjects->at(i));
+        testSubjects.push_back(testSubject);
+    }
 }
 
 /**
@@ -87,15 +176,70 @@ FindFactorsTask::~FindFactorsTask()
 {
     mpz_clear(upperBound);
     mpz_clear(lowerBound);
-    mpz_clear(testSubject);
 
+    clear_numbers(&testSubjects);
     for(register unsigned int i = 0; i < results.size(); ++i)
     {
-        mpz_clear(*results[i]);
-        free(results[i]);
+        clear_numbers(&results[i]);
     }
 }
 
+/**
+ * sets the flag that is checked between candidates to stop the task early.
+ *
+ * @class      FindFactorsTask
+ *
+ * @method     set_cancel_flag
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the flag may be set from another thread, or process at any time.
+ *   the task does not take ownership of it.
+ *
+ * @signature  void FindFactorsTask::set_cancel_flag(
+ *   volatile int* _cancelFlag)
+ *
+ * @param      _cancelFlag flag that is set to non-zero to cancel the task.
+ */
+void FindFactorsTask::set_cancel_flag(volatile int* _cancelFlag)
+{
+    cancelFlag = _cancelFlag;
+}
+
+/**
+ * forces the kernel that execute uses to search the range.
+ *
+ * @class      FindFactorsTask
+ *
+ * @method     set_kernel
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       meant for measuring the kernels against each other; both find
+ *   the same factors, at a different cost.
+ *
+ * @signature  void FindFactorsTask::set_kernel(int _kernel)
+ *
+ * @param      _kernel KERNEL_TRIAL_DIVISION, KERNEL_REMAINDER_TREE, or
+ *   KERNEL_AUTO to let execute pick one.
+ */
+void FindFactorsTask::set_kernel(int _kernel)
+{
+    kernel = _kernel;
+}
+
 /**
  * computes all the factors for the number in this range, and places them into
  *   its internal results vector which may be accessed through the get_results
@@ -119,9 +263,74 @@ FindFactorsTask::~FindFactorsTask()
  *   after the execute method returns, the results of this object will be
  *   populated with factors of the passed number in the range it was to check.
  *
- * @signature  void FindFactorsTask::execute()
+ * building the product tree of a range costs about as much as dividing a few
+ *   small numbers by every candidate, so the remainder tree is only used once
+ *   there are at least REMAINDER_TREE_MIN_SUBJECTS numbers, or they are at
+ *   least REMAINDER_TREE_MIN_LIMBS limbs long altogether. trial division by
+ *   batches of candidates is used otherwise. set_kernel overrides this choice,
+ *   except that KERNEL_FIXED_WIDTH falls back on plain trial division for
+ *   numbers longer than BIGINT_MAX_LIMBS limbs, or 0.
+ *
+ * @signature  bool FindFactorsTask::execute()
+ *
+ * @return     true if the task ran to completion; false if it was cancelled,
+ *   and its results are incomplete.
  */
-void FindFactorsTask::execute()
+bool FindFactorsTask::execute()
+{
+    size_t limbs = 0;
+    size_t maxLimbs = 0;
+    bool hasZero = false;
+    for(register unsigned int i = 0; i < testSubjects.size(); ++i)
+    {
+        limbs += mpz_size(*testSubjects[i]);
+        maxLimbs = std::max(maxLimbs,mpz_size(*testSubjects[i]));
+        hasZero = hasZero || mpz_sgn(*testSubjects[i]) == 0;
+    }
+
+    if (kernel == KERNEL_REMAINDER_TREE ||
+        (kernel == KERNEL_AUTO && testSubjects.size() > 1 &&
+        (testSubjects.size() >= REMAINDER_TREE_MIN_SUBJECTS ||
+        limbs >= REMAINDER_TREE_MIN_LIMBS)))
+    {
+        execute_remainder_tree();
+    }
+    else if (kernel == KERNEL_FIXED_WIDTH && maxLimbs > 0 && maxLimbs <= BIGINT_MAX_LIMBS && !hasZero)
+    {
+        execute_fixed_width(maxLimbs);
+    }
+    else if (kernel == KERNEL_AUTO || kernel == KERNEL_MULTI_MODULUS)
+    {
+        execute_multi_modulus();
+    }
+    else
+    {
+        execute_trial_division();
+    }
+    return cancelFlag == 0 || *cancelFlag == 0;
+}
+
+/**
+ * finds the factors of the numbers of the task by dividing each of them by
+ *   every candidate in the range.
+ *
+ * @class      FindFactorsTask
+ *
+ * @method     execute_trial_division
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       stops at the next candidate once the cancellation flag is set.
+ *
+ * @signature  void FindFactorsTask::execute_trial_division()
+ */
+void FindFactorsTask::execute_trial_division()
 {
     // declare, allocate and initialize variables
     mpz_t factor;
@@ -130,21 +339,24 @@ void FindFactorsTask::execute()
     mpz_init_set(factor,lowerBound);
     mpz_init_set_ui(zero,0);
 
-    // iterate through range and find all factors of testSubject within range
-    // and put them into results.
+    // iterate through range and find all factors of each test subject within
+    // range and put them into its results.
     for(mpz_set(factor,lowerBound);
-        mpz_cmp(factor,upperBound) <= 0;
+        mpz_cmp(factor,upperBound) <= 0 && (cancelFlag == 0 || *cancelFlag == 0);
         mpz_add_ui(factor,factor,1))
     {
         mpz_t surplus;
         mpz_init(surplus);
 
-        mpz_mod(surplus,testSubject,factor);
-        if(mpz_cmp(surplus,zero) == 0)
+        for(register unsigned int i = 0; i < testSubjects.size(); ++i)
         {
-            mpz_t* mallocedFactor = (mpz_t*) malloc(sizeof(mpz_t));
-            mpz_init_set(*mallocedFactor,factor);
-            results.push_back(mallocedFactor);
+            mpz_mod(surplus,*testSubjects[i],factor);
+            if(mpz_cmp(surplus,zero) == 0)
+            {
+                mpz_t* mallocedFactor = (mpz_t*) malloc(sizeof(mpz_t));
+                mpz_init_set(*mallocedFactor,factor);
+                results[i].push_back(mallocedFactor);
+            }
         }
 
         mpz_clear(surplus);
@@ -155,6 +367,431 @@ void FindFactorsTask::execute()
     mpz_clear(zero);
 }
 
+/**
+ * finds the factors of the numbers of the task by trial division with fixed
+ *   width integers as wide as the longest of them.
+ *
+ * @class      FindFactorsTask
+ *
+ * @method     execute_fixed_width
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       numbers longer than BIGINT_MAX_LIMBS limbs are searched with
+ *   execute_trial_division instead.
+ *
+ * @signature  void FindFactorsTask::execute_fixed_width(size_t limbs)
+ *
+ * @param      limbs number of limbs of the longest number of the task.
+ */
+void FindFactorsTask::execute_fixed_width(size_t limbs)
+{
+    switch(limbs)
+    {
+    case 1:
+        search_fixed_width<1>();
+        break;
+    case 2:
+        search_fixed_width<2>();
+        break;
+    case 3:
+        search_fixed_width<3>();
+        break;
+    case 4:
+        search_fixed_width<4>();
+        break;
+    case 5:
+        search_fixed_width<5>();
+        break;
+    case 6:
+        search_fixed_width<6>();
+        break;
+    case 7:
+        search_fixed_width<7>();
+        break;
+    case 8:
+        search_fixed_width<8>();
+        break;
+    default:
+        execute_trial_division();
+        break;
+    }
+}
+
+/**
+ * finds the factors of the numbers of the task by dividing each of them by
+ *   every candidate in the range, as N limb integers.
+ *
+ * @class      FindFactorsTask
+ *
+ * @method     search_fixed_width
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * every number must fit in N limbs, and not be 0. a candidate larger than the
+ *   largest number can not divide any of them, so the search stops there, which
+ *   also keeps the candidates within N limbs. it starts from 1 if the lower
+ *   bound is smaller.
+ *
+ * a candidate that fits in a limb is tested with BigInt::mod_word. one that
+ *   does not, which only happens for numbers larger than a limb with a range
+ *   that reaches past one, is tested with mpz_divisible_p.
+ *
+ * stops at the next candidate once the cancellation flag is set.
+ *
+ * @signature  template<unsigned int N>
+ *   void FindFactorsTask::search_fixed_width()
+ */
+template<unsigned int N>
+void FindFactorsTask::search_fixed_width()
+{
+    // copy the numbers, and work out the range of candidates that can divide
+    // any of them
+    std::vector<BigInt<N> > subjects;
+    mpz_t* largest = testSubjects[0];
+    for(register unsigned int i = 0; i < testSubjects.size(); ++i)
+    {
+        subjects.push_back(BigInt<N>(*testSubjects[i]));
+        if (mpz_cmpabs(*testSubjects[i],*largest) > 0)
+        {
+            largest = testSubjects[i];
+        }
+    }
+    mpz_t bound;
+    mpz_init(bound);
+    mpz_abs(bound,*largest);
+    if (mpz_cmp(bound,lowerBound) < 0)
+    {
+        mpz_clear(bound);
+        return;
+    }
+    if (mpz_cmp(upperBound,bound) < 0)
+    {
+        mpz_set(bound,upperBound);
+    }
+    BigInt<N> last(bound);
+    mpz_set_ui(bound,1);
+    BigInt<N> factor(mpz_cmp(lowerBound,bound) < 0 ? bound : lowerBound);
+
+    // iterate through range and find all factors of each test subject within
+    // range. the last candidate is checked for before incrementing, as the
+    // largest number of N limbs wraps around to 0.
+    for(bool more = factor.compare(last) <= 0;
+        more && (cancelFlag == 0 || *cancelFlag == 0);
+        more = factor.compare(last) < 0, factor.increment())
+    {
+        if (factor.fits_word())
+        {
+            mp_limb_t divisor = factor.get_word();
+            for(register unsigned int i = 0; i < subjects.size(); ++i)
+            {
+                if (subjects[i].mod_word(divisor) == 0)
+                {
+                    mpz_t* mallocedFactor = (mpz_t*) malloc(sizeof(mpz_t));
+                    mpz_init(*mallocedFactor);
+                    factor.get(*mallocedFactor);
+                    results[i].push_back(mallocedFactor);
+                }
+            }
+        }
+        else
+        {
+            factor.get(bound);
+            for(register unsigned int i = 0; i < subjects.size(); ++i)
+            {
+                if (mpz_divisible_p(*testSubjects[i],bound))
+                {
+                    mpz_t* mallocedFactor = (mpz_t*) malloc(sizeof(mpz_t));
+                    mpz_init_set(*mallocedFactor,bound);
+                    results[i].push_back(mallocedFactor);
+                }
+            }
+        }
+    }
+
+    // delete variables
+    mpz_clear(bound);
+}
+
+/**
+ * finds the factors of the numbers of the task by dividing the limbs of each
+ *   of them by batches of candidates at once.
+ *
+ * @class      FindFactorsTask
+ *
+ * @method     execute_multi_modulus
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the candidates that fit in a limb are taken MULTI_MODULUS_BATCH at a time.
+ *   the inverses of a batch are worked out once, and used for every number,
+ *   whose limbs are read straight out of it, once per batch. the remainders go
+ *   to a buffer on the stack, and a candidate whose remainder is 0 divides the
+ *   number. it starts from 1 if the lower bound is smaller, as 0 divides
+ *   nothing.
+ *
+ * the candidates past a limb are left to execute_trial_division, by moving the
+ *   lower bound past the ones that were searched.
+ *
+ * stops at the next batch once the cancellation flag is set.
+ *
+ * @signature  void FindFactorsTask::execute_multi_modulus()
+ */
+void FindFactorsTask::execute_multi_modulus()
+{
+    // work out the range of candidates that fit in a limb
+    mpz_t bound;
+    mpz_init_set_ui(bound,1);
+    mpz_mul_2exp(bound,bound,GMP_NUMB_BITS);
+    mp_limb_t first = mpz_sgn(lowerBound) <= 0 ? 0 : mpz_getlimbn(lowerBound,0);
+    mp_limb_t last = mpz_cmp(upperBound,bound) >= 0 ? GMP_NUMB_MAX : mpz_getlimbn(upperBound,0);
+    first = std::max(first,(mp_limb_t) 1);
+    bool more = mpz_cmp(lowerBound,bound) < 0 && mpz_sgn(upperBound) > 0 && first <= last;
+
+    WordModulus moduli[MULTI_MODULUS_BATCH];
+    mp_limb_t residues[MULTI_MODULUS_BATCH];
+    mp_limb_t candidate = first;
+    while(more && (cancelFlag == 0 || *cancelFlag == 0))
+    {
+        // make the next batch; the last candidate is checked for before
+        // incrementing, as the largest limb wraps around to 0
+        unsigned int count = 0;
+        for(; more && count < MULTI_MODULUS_BATCH; ++count)
+        {
+            word_modulus_init(&moduli[count],candidate);
+            more = candidate < last;
+            ++candidate;
+        }
+
+        // divide every number by the batch
+        for(register unsigned int i = 0; i < testSubjects.size(); ++i)
+        {
+            multi_modulus_residues(mpz_limbs_read(*testSubjects[i]),mpz_size(*testSubjects[i]),
+                moduli,count,residues);
+            for(register unsigned int k = 0; k < count; ++k)
+            {
+                if (residues[k] == 0)
+                {
+                    mpz_t* mallocedFactor = (mpz_t*) malloc(sizeof(mpz_t));
+                    mpz_init(*mallocedFactor);
+                    *mpz_limbs_write(*mallocedFactor,1) = moduli[k].divisor;
+                    mpz_limbs_finish(*mallocedFactor,1);
+                    results[i].push_back(mallocedFactor);
+                }
+            }
+        }
+    }
+
+    // search the rest of the range the plain way
+    if (mpz_cmp(upperBound,bound) >= 0 && (cancelFlag == 0 || *cancelFlag == 0))
+    {
+        if (mpz_cmp(lowerBound,bound) < 0)
+        {
+            mpz_set(lowerBound,bound);
+        }
+        execute_trial_division();
+    }
+
+    // delete variables
+    mpz_clear(bound);
+}
+
+/**
+ * finds the factors of all the numbers of the task at once, using product,
+ *   and remainder trees.
+ *
+ * @class      FindFactorsTask
+ *
+ * @method     execute_remainder_tree
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       see the top of this file for how it works.
+ *
+ * @signature  void FindFactorsTask::execute_remainder_tree()
+ */
+void FindFactorsTask::execute_remainder_tree()
+{
+    if (mpz_cmp(lowerBound,upperBound) > 0)
+    {
+        return;
+    }
+
+    // build the product tree of the candidates in the range. each leaf is the
+    // product of a block of consecutive candidates
+    std::vector<std::vector<mpz_t*> > candidateTree(1);
+    mpz_t factor;
+    for(mpz_init_set(factor,lowerBound);
+        mpz_cmp(factor,upperBound) <= 0;
+        mpz_add_ui(factor,factor,1))
+    {
+        mpz_t* block = (mpz_t*) malloc(sizeof(mpz_t));
+        mpz_init_set(*block,factor);
+        for(register unsigned int i = 1; i < REMAINDER_TREE_LEAF_SIZE && mpz_cmp(factor,upperBound) < 0; ++i)
+        {
+            mpz_add_ui(factor,factor,1);
+            mpz_mul(*block,*block,factor);
+        }
+        candidateTree[0].push_back(block);
+    }
+    mpz_clear(factor);
+    build_product_tree(&candidateTree);
+
+    // build the product tree of the numbers
+    std::vector<std::vector<mpz_t*> > subjectTree(1);
+    for(register unsigned int i = 0; i < testSubjects.size(); ++i)
+    {
+        mpz_t* testSubject = (mpz_t*) malloc(sizeof(mpz_t));
+        mpz_init_set(*testSubject,*testSubjects[i]);
+        subjectTree[0].push_back(testSubject);
+    }
+    build_product_tree(&subjectTree);
+
+    // push the product of the candidates down the remainder tree of the
+    // numbers
+    std::vector<mpz_t*> residues;
+    residues.push_back((mpz_t*) malloc(sizeof(mpz_t)));
+    mpz_init(*residues[0]);
+    mpz_mod(*residues[0],*candidateTree.back()[0],*subjectTree.back()[0]);
+    for(register int level = subjectTree.size()-2; level >= 0; --level)
+    {
+        std::vector<mpz_t*> childResidues;
+        for(register unsigned int i = 0; i < subjectTree[level].size(); ++i)
+        {
+            mpz_t* residue = (mpz_t*) malloc(sizeof(mpz_t));
+            mpz_init(*residue);
+            mpz_mod(*residue,*residues[i/2],*subjectTree[level][i]);
+            childResidues.push_back(residue);
+        }
+        clear_numbers(&residues);
+        residues.swap(childResidues);
+    }
+
+    // push the common part of each number down the product tree of the
+    // candidates
+    mpz_t common;
+    mpz_init(common);
+    for(register unsigned int i = 0; i < testSubjects.size() && (cancelFlag == 0 || *cancelFlag == 0); ++i)
+    {
+        mpz_gcd(common,*residues[i],*testSubjects[i]);
+        descend(&candidateTree,candidateTree.size()-1,0,common,i);
+    }
+    mpz_clear(common);
+
+    // delete variables
+    clear_numbers(&residues);
+    for(register unsigned int i = 0; i < candidateTree.size(); ++i)
+    {
+        clear_numbers(&candidateTree[i]);
+    }
+    for(register unsigned int i = 0; i < subjectTree.size(); ++i)
+    {
+        clear_numbers(&subjectTree[i]);
+    }
+}
+
+/**
+ * finds the candidates under a node of the product tree of the candidates
+ *   that divide a number.
+ *
+ * @class      FindFactorsTask
+ *
+ * @method     descend
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       node i of a level covers the blocks of candidates from
+ *   i<<level up to, but not including (i+1)<<level. the candidates that divide
+ *   the number are appended to its results in ascending order.
+ *
+ * @signature  void FindFactorsTask::descend(
+ *   std::vector<std::vector<mpz_t*> >* tree,unsigned int level,
+ *   unsigned long index,mpz_t common,unsigned int subject)
+ *
+ * @param      tree product tree of the candidates.
+ * @param      level level of the node in the tree; 0 for the blocks of
+ *   candidates.
+ * @param      index index of the node in its level.
+ * @param      common gcd of the number, and the product of the node.
+ * @param      subject index of the number.
+ */
+void FindFactorsTask::descend(std::vector<std::vector<mpz_t*> >* tree,unsigned int level,
+    unsigned long index,mpz_t common,unsigned int subject)
+{
+    // a candidate that divides the number also divides common, so it can not
+    // be larger than it
+    mpz_t smallest;
+    mpz_init(smallest);
+    mpz_add_ui(smallest,lowerBound,(index << level)*REMAINDER_TREE_LEAF_SIZE);
+    if (mpz_cmp(common,smallest) < 0)
+    {
+        mpz_clear(smallest);
+        return;
+    }
+
+    if (level == 0)
+    {
+        // check every candidate of the block
+        for(register unsigned int i = 0; i < REMAINDER_TREE_LEAF_SIZE &&
+            mpz_cmp(smallest,upperBound) <= 0 && mpz_cmp(smallest,common) <= 0; ++i)
+        {
+            if (mpz_divisible_p(common,smallest))
+            {
+                mpz_t* mallocedFactor = (mpz_t*) malloc(sizeof(mpz_t));
+                mpz_init_set(*mallocedFactor,smallest);
+                results[subject].push_back(mallocedFactor);
+            }
+            mpz_add_ui(smallest,smallest,1);
+        }
+        mpz_clear(smallest);
+        return;
+    }
+    mpz_clear(smallest);
+
+    mpz_t childCommon;
+    mpz_init(childCommon);
+    for(register unsigned long child = index*2; child <= index*2+1 && child < tree->at(level-1).size(); ++child)
+    {
+        mpz_gcd(childCommon,common,*tree->at(level-1)[child]);
+        descend(tree,level-1,child,childCommon,subject);
+    }
+    mpz_clear(childCommon);
+}
+
 /**
  * returns the results vector of this task object.
  *
@@ -186,5 +823,106 @@ void FindFactorsTask::execute()
  */
 std::vector<mpz_t*>* FindFactorsTask::get_results()
 {
-    return &results;
+    return &results[0];
+}
+
+/**
+ * returns the results vector of one of the numbers of this task object.
+ *
+ * @class      FindFactorsTask
+ *
+ * @method     get_results
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       same as get_results for the first number.
+ *
+ * @signature  std::vector<mpz_t*>* FindFactorsTask::get_results(
+ *   unsigned int subject)
+ *
+ * @param      subject index of the number, in the order they were passed to
+ *   the constructor.
+ *
+ * @return     the results vector of the number.
+ */
+std::vector<mpz_t*>* FindFactorsTask::get_results(unsigned int subject)
+{
+    return &results[subject];
+}
+
+/**
+ * builds a product tree on top of its leaves.
+ *
+ * @function   build_product_tree
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       each node is the product of the two nodes below it; a node
+ *   without a sibling is carried up as is. the root is the only node of the
+ *   last level.
+ *
+ * @signature  void build_product_tree(std::vector<std::vector<mpz_t*> >* tree)
+ *
+ * @param      tree vector with the leaves as its only level. the levels above
+ *   it are appended to it.
+ */
+static void build_product_tree(std::vector<std::vector<mpz_t*> >* tree)
+{
+    while(tree->back().size() > 1)
+    {
+        std::vector<mpz_t*> level;
+        std::vector<mpz_t*>& below = tree->back();
+        for(register unsigned int i = 0; i < below.size(); i += 2)
+        {
+            mpz_t* product = (mpz_t*) malloc(sizeof(mpz_t));
+            mpz_init_set(*product,*below[i]);
+            if (i+1 < below.size())
+            {
+                mpz_mul(*product,*product,*below[i+1]);
+            }
+            level.push_back(product);
+        }
+        tree->push_back(level);
+    }
+}
+
+/**
+ * clears, and frees the numbers in a vector, and empties it.
+ *
+ * @function   clear_numbers
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void clear_numbers(std::vector<mpz_t*>* numbers)
+ *
+ * @param      numbers numbers allocated with malloc, and initialized.
+ */
+static void clear_numbers(std::vector<mpz_t*>* numbers)
+{
+    for(register unsigned int i = 0; i < numbers->size(); ++i)
+    {
+        mpz_clear(*numbers->at(i));
+        free(numbers->at(i));
+    }
+    numbers->clear();
 }
@@ -18,6 +18,20 @@
  *
  * @note       this class encapsulates a long-running task, or sub-task that
  *   should be executed on a worker thread or process.
+ *
+ * a task may check the range for the factors of more than one number at a
+ *   time. the results of each number are kept apart, in the order the numbers
+ *   were passed in.
+ *
+ * the kernel that searches the range is picked by execute from the number, and
+ *   size of the numbers, unless one is forced with set_kernel. trial division
+ *   divides the limbs of the numbers by batches of candidates at once, with
+ *   MultiModulus.h; it can also be forced to use mpz_t, or the fixed width
+ *   integers of BigInt.h.
+ *
+ * a task may be given a cancellation flag shared with other workers. once the
+ *   flag is set, the task stops at the next candidate, or batch of candidates,
+ *   and its results are incomplete.
  */
 #ifndef FINDFACTORSTASK_H
 #define FINDFACTORSTASK_H
@@ -25,21 +39,45 @@
 #include <gmp.h>
 #include <vector>
 
+#define REMAINDER_TREE_LEAF_SIZE 16
+#define REMAINDER_TREE_MIN_SUBJECTS 8
+#define REMAINDER_TREE_MIN_LIMBS 64
+
+#define KERNEL_AUTO 0
+#define KERNEL_TRIAL_DIVISION 1
+#define KERNEL_REMAINDER_TREE 2
+#define KERNEL_FIXED_WIDTH 3
+#define KERNEL_MULTI_MODULUS 4
+
 class FindFactorsTask
 {
 public:
 
     FindFactorsTask(mpz_t,mpz_t,mpz_t);
+    FindFactorsTask(std::vector<mpz_t*>*,mpz_t,mpz_t);
     ~FindFactorsTask();
-    void execute();
+    void set_cancel_flag(volatile int* _cancelFlag);
+    void set_kernel(int _kernel);
+    bool execute();
     std::vector<mpz_t*>* get_results();
+    std::vector<mpz_t*>* get_results(unsigned int subject);
 
 private:
 
+    void execute_trial_division();
+    void execute_remainder_tree();
+    void execute_fixed_width(size_t limbs);
+    void execute_multi_modulus();
+    template<unsigned int N> void search_fixed_width();
+    void descend(std::vector<std::vector<mpz_t*> >* tree,unsigned int level,
+        unsigned long index,mpz_t common,unsigned int subject);
+
     mpz_t upperBound;
     mpz_t lowerBound;
-    mpz_t testSubject;
-    std::vector<mpz_t*> results;
+    std::vector<mpz_t*> testSubjects;
+    std::vector<std::vector<mpz_t*> > results;
+    volatile int* cancelFlag;
+    int kernel;
 };
 
 
@@ -0,0 +1,405 @@
+/**
+ * microbenchmark of the kernels of the FindFactorsTask class.
+ *
+ * usage: ./FindFactorsTaskBenchmark [--repeats n] [--warmup n] [--subjects n]
+ *   [--start n]
+ *
+ * runs FindFactorsTask::execute over every combination of kernel, subject
+ *   size, and chunk size, and prints the cost of a candidate in nanoseconds,
+ *   and cpu cycles as csv, one line per combination.
+ *
+ * the kernels are trial division, the remainder tree, trial division with
+ *   fixed width integers, and with batches of candidates at once. each task is
+ *   given --subjects random numbers (REMAINDER_TREE_MIN_SUBJECTS by default)
+ *   of 1, 2, 4, and 8 limbs, and searches a chunk of 1000, 10000, and 100000
+ *   candidates from --start (1 by default). a candidate is counted once per
+ *   subject, so the costs of the kernels can be compared directly.
+ *
+ * each combination is run --warmup times (3 by default) without being
+ *   measured, then --repeats times (15 by default). its line holds the median,
+ *   mean, standard deviation, and minimum of the cost in nanoseconds, and the
+ *   median cost in cycles.
+ *
+ * @sourceFile FindFactorsTaskBenchmark.cpp
+ *
+ * @program    FindFactorsTaskBenchmark.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * only execute is timed; building the task, and freeing its results are not.
+ *   the subjects are made from a fixed seed, so every run measures the same
+ *   numbers.
+ *
+ * cycles are read from the cpu cycle counter of perf_event_open if the kernel
+ *   allows it, or else from the time stamp counter, which ticks at a fixed
+ *   rate rather than the clock of the core. the source is printed to stderr;
+ *   the cycles column is left empty if neither is available.
+ *
+ * the kernels should find the same factors; the benchmark fails if they do
+ *   not find as many.
+ *
+ * the output has these columns:
+ *
+ *   kernel,limbs,subjects,chunk_size,repeats,median_ns,mean_ns,stddev_ns,
+ *   min_ns,median_cycles
+ */
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <algorithm>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "FindFactorsTask.h"
+#include "Number.h"
+
+#define USAGE "usage: %s [--repeats n] [--warmup n] [--subjects n] [--start n]\n"
+
+#define DEFAULT_REPEATS 15
+#define DEFAULT_WARMUP 3
+#define SUBJECT_SEED 8005
+
+int main(int,char**);
+bool run_once(std::vector<mpz_t*>* subjects,int kernel,mpz_t lowerBound,mpz_t upperBound,double* ns,double* cycles,unsigned long* numResults);
+const char* open_cycle_counter();
+bool read_cycles(unsigned long long* cycles);
+
+/**
+ * file descriptor of the perf cycle counter, or -1 if it could not be opened.
+ */
+static int cycleCounter = -1;
+
+/**
+ * true if cycles are read from the time stamp counter.
+ */
+static bool useTimestampCounter = false;
+
+/**
+ * entry point of the program.
+ *
+ * @function   main
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the number of results found by each run of a combination is
+ *   compared to the first run of trial division on the same subjects, and
+ *   range.
+ *
+ * @signature  int main(int argc,char** argv)
+ *
+ * @param      argc number of command line arguments
+ * @param      argv array of c strings of command line arguments
+ *
+ * @return     status code.
+ */
+int main(int argc,char** argv)
+{
+    // parse command line options
+    static option longOptions[] =
+    {
+        {"repeats",required_argument,0,'r'},
+        {"warmup",required_argument,0,'w'},
+        {"subjects",required_argument,0,'n'},
+        {"start",required_argument,0,'s'},
+        {0,0,0,0}
+    };
+    int repeats = DEFAULT_REPEATS;
+    int warmup = DEFAULT_WARMUP;
+    int numSubjects = REMAINDER_TREE_MIN_SUBJECTS;
+    long start = 1;
+    int opt;
+    while((opt = getopt_long(argc,argv,"",longOptions,0)) != -1)
+    {
+        switch(opt)
+        {
+        case 'r':
+            repeats = atoi(optarg);
+            break;
+        case 'w':
+            warmup = atoi(optarg);
+            break;
+        case 'n':
+            numSubjects = atoi(optarg);
+            break;
+        case 's':
+            start = atol(optarg);
+            break;
+        default:
+            fprintf(stderr,USAGE,argv[0]);
+            return 1;
+        }
+    }
+    if (argc-optind != 0 || repeats <= 0 || warmup < 0 || numSubjects <= 0 || start <= 0)
+    {
+        fprintf(stderr,USAGE,argv[0]);
+        return 1;
+    }
+
+    const char* cycleSource = open_cycle_counter();
+    fprintf(stderr,"cycles counted by: %s\n",cycleSource != 0 ? cycleSource : "nothing");
+    printf("kernel,limbs,subjects,chunk_size,repeats,median_ns,mean_ns,stddev_ns,min_ns,median_cycles\n");
+
+    // the dimensions of the sweep
+    const char* kernelNames[] = {"trial-division","remainder-tree","fixed-width","multi-modulus"};
+    int kernels[] = {KERNEL_TRIAL_DIVISION,KERNEL_REMAINDER_TREE,KERNEL_FIXED_WIDTH,KERNEL_MULTI_MODULUS};
+    unsigned long sizes[] = {1,2,4,8};
+    unsigned long chunkSizes[] = {1000,10000,100000};
+
+    gmp_randstate_t random;
+    gmp_randinit_default(random);
+    gmp_randseed_ui(random,SUBJECT_SEED);
+
+    int status = 0;
+    for(register unsigned int s = 0; s < sizeof(sizes)/sizeof(*sizes) && status == 0; ++s)
+    {
+        // make random subjects that are exactly the size long
+        std::vector<Number*> subjectNumbers;
+        std::vector<mpz_t*> subjects;
+        for(register int i = 0; i < numSubjects; ++i)
+        {
+            Number* subject = new Number();
+            mpz_urandomb(subject->value,random,sizes[s]*GMP_NUMB_BITS);
+            mpz_setbit(subject->value,sizes[s]*GMP_NUMB_BITS-1);
+            subjectNumbers.push_back(subject);
+            subjects.push_back(&subject->value);
+        }
+
+        for(register unsigned int c = 0; c < sizeof(chunkSizes)/sizeof(*chunkSizes) && status == 0; ++c)
+        {
+            Number lowerBound;
+            Number upperBound;
+            mpz_set_ui(lowerBound.value,start);
+            mpz_set_ui(upperBound.value,start+chunkSizes[c]-1);
+            double candidates = (double) chunkSizes[c]*numSubjects;
+            unsigned long expectedResults = 0;
+
+            for(register unsigned int k = 0; k < sizeof(kernels)/sizeof(*kernels) && status == 0; ++k)
+            {
+                std::vector<double> nsPerCandidate;
+                std::vector<double> cyclesPerCandidate;
+                for(register int i = 0; i < warmup+repeats; ++i)
+                {
+                    double ns;
+                    double cycles;
+                    unsigned long numResults;
+                    run_once(&subjects,kernels[k],lowerBound.value,upperBound.value,&ns,&cycles,&numResults);
+                    if (k == 0 && i == 0)
+                    {
+                        expectedResults = numResults;
+                    }
+                    else if (numResults != expectedResults)
+                    {
+                        fprintf(stderr,"%s found %lu factors instead of %lu\n",kernelNames[k],numResults,expectedResults);
+                        status = 1;
+                        break;
+                    }
+                    if (i >= warmup)
+                    {
+                        nsPerCandidate.push_back(ns/candidates);
+                        cyclesPerCandidate.push_back(cycles/candidates);
+                    }
+                }
+                if (status != 0)
+                {
+                    break;
+                }
+
+                // work out the statistics of the measured runs
+                std::sort(nsPerCandidate.begin(),nsPerCandidate.end());
+                std::sort(cyclesPerCandidate.begin(),cyclesPerCandidate.end());
+                double mean = 0;
+                for(register unsigned int i = 0; i < nsPerCandidate.size(); ++i)
+                {
+                    mean += nsPerCandidate[i];
+                }
+                mean /= nsPerCandidate.size();
+                double variance = 0;
+                for(register unsigned int i = 0; i < nsPerCandidate.size(); ++i)
+                {
+                    variance += (nsPerCandidate[i]-mean)*(nsPerCandidate[i]-mean);
+                }
+                if (nsPerCandidate.size() > 1)
+                {
+                    variance /= nsPerCandidate.size()-1;
+                }
+
+                char cycles[32] = "";
+                if (cycleSource != 0)
+                {
+                    snprintf(cycles,sizeof(cycles),"%.2f",cyclesPerCandidate[cyclesPerCandidate.size()/2]);
+                }
+                printf("%s,%lu,%d,%lu,%d,%.3f,%.3f,%.3f,%.3f,%s\n",kernelNames[k],sizes[s],
+                    numSubjects,chunkSizes[c],repeats,nsPerCandidate[nsPerCandidate.size()/2],
+                    mean,sqrt(variance),nsPerCandidate[0],cycles);
+                fflush(stdout);
+            }
+        }
+
+        for(register unsigned int i = 0; i < subjectNumbers.size(); ++i)
+        {
+            delete subjectNumbers[i];
+        }
+    }
+
+    gmp_randclear(random);
+    if (cycleCounter >= 0)
+    {
+        close(cycleCounter);
+    }
+    return status;
+}
+
+/**
+ * runs a task once, and measures how long its execute method takes.
+ *
+ * @function   run_once
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       cycles is set to 0 if they cannot be counted.
+ *
+ * @signature  bool run_once(std::vector<mpz_t*>* subjects,int kernel,
+ *   mpz_t lowerBound,mpz_t upperBound,double* ns,double* cycles,
+ *   unsigned long* numResults)
+ *
+ * @param      subjects numbers to find the factors of.
+ * @param      kernel kernel passed to FindFactorsTask::set_kernel.
+ * @param      lowerBound first candidate of the range.
+ * @param      upperBound last candidate of the range.
+ * @param      ns set to the time execute took in nanoseconds.
+ * @param      cycles set to the cycles execute took.
+ * @param      numResults set to the number of factors found for all the
+ *   subjects together.
+ *
+ * @return     true if the task ran to completion; false otherwise.
+ */
+bool run_once(std::vector<mpz_t*>* subjects,int kernel,mpz_t lowerBound,mpz_t upperBound,double* ns,double* cycles,unsigned long* numResults)
+{
+    FindFactorsTask task(subjects,upperBound,lowerBound);
+    task.set_kernel(kernel);
+
+    timespec startTime;
+    timespec endTime;
+    unsigned long long startCycles = 0;
+    unsigned long long endCycles = 0;
+    read_cycles(&startCycles);
+    clock_gettime(CLOCK_MONOTONIC,&startTime);
+    bool completed = task.execute();
+    clock_gettime(CLOCK_MONOTONIC,&endTime);
+    read_cycles(&endCycles);
+
+    *ns = (endTime.tv_sec-startTime.tv_sec)*1e9+(endTime.tv_nsec-startTime.tv_nsec);
+    *cycles = (double) (endCycles-startCycles);
+    *numResults = 0;
+    for(register unsigned int i = 0; i < subjects->size(); ++i)
+    {
+        *numResults += task.get_results(i)->size();
+    }
+    return completed;
+}
+
+/**
+ * opens the counter that cycles are read from.
+ *
+ * @function   open_cycle_counter
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the perf counter only counts the cycles of this thread in user
+ *   space. the time stamp counter is only used on x86.
+ *
+ * @signature  const char* open_cycle_counter()
+ *
+ * @return     name of the counter, or 0 if cycles cannot be counted.
+ */
+const char* open_cycle_counter()
+{
+    perf_event_attr attributes;
+    memset(&attributes,0,sizeof(attributes));
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.size = sizeof(attributes);
+    attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    cycleCounter = syscall(__NR_perf_event_open,&attributes,0,-1,-1,0);
+    if (cycleCounter >= 0)
+    {
+        return "perf cpu cycles";
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    useTimestampCounter = true;
+    return "time stamp counter";
+#else
+    return 0;
+#endif
+}
+
+/**
+ * reads the counter opened by open_cycle_counter.
+ *
+ * @function   read_cycles
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool read_cycles(unsigned long long* cycles)
+ *
+ * @param      cycles set to the value of the counter.
+ *
+ * @return     true if the counter was read; false otherwise.
+ */
+bool read_cycles(unsigned long long* cycles)
+{
+    if (cycleCounter >= 0)
+    {
+        return read(cycleCounter,cycles,sizeof(*cycles)) == sizeof(*cycles);
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    if (useTimestampCounter)
+    {
+        *cycles = __rdtsc();
+        return true;
+    }
+#endif
+    return false;
+}
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <vector>
 #include "FindFactorsTask.h"
+#include "BigInt.h"
 #include "Number.h"
 #include <stdlib.h>
 
@@ -67,5 +68,128 @@ int main()
         gmp_printf("%Zd\n",results->at(i));
     }
 
+    // find the factors of enough numbers at once to use the remainder tree;
+    // each should match the factors found for it alone
+    Number subjectNumbers[REMAINDER_TREE_MIN_SUBJECTS];
+    std::vector<mpz_t*> subjects;
+    mpz_set_ui(subjectNumbers[0].value,1000);
+    mpz_set_ui(subjectNumbers[1].value,997);
+    mpz_set_ui(subjectNumbers[2].value,720);
+    mpz_set_ui(subjectNumbers[3].value,30);
+    for(register unsigned int i = 4; i < REMAINDER_TREE_MIN_SUBJECTS; ++i)
+    {
+        mpz_set_ui(subjectNumbers[i].value,1);
+        mpz_mul_2exp(subjectNumbers[i].value,subjectNumbers[i].value,64*i);
+        mpz_sub_ui(subjectNumbers[i].value,subjectNumbers[i].value,i);
+    }
+    for(register unsigned int i = 0; i < REMAINDER_TREE_MIN_SUBJECTS; ++i)
+    {
+        subjects.push_back(&subjectNumbers[i].value);
+    }
+    FindFactorsTask batchTask(&subjects,hiMark.value,loMark.value);
+    batchTask.execute();
+    for(register unsigned int i = 0; i < subjects.size(); ++i)
+    {
+        FindFactorsTask singleTask(*subjects[i],hiMark.value,loMark.value);
+        singleTask.execute();
+        std::vector<mpz_t*>* batchResults = batchTask.get_results(i);
+        std::vector<mpz_t*>* singleResults = singleTask.get_results();
+
+        bool same = batchResults->size() == singleResults->size();
+        for(register unsigned int j = 0; same && j < batchResults->size(); ++j)
+        {
+            same = mpz_cmp(*batchResults->at(j),*singleResults->at(j)) == 0;
+        }
+        gmp_printf("%Zd: %lu factors, %s\n",*subjects[i],batchResults->size(),same ? "same" : "DIFFERENT");
+    }
+
+    // find the factors of numbers of 1 to BIGINT_MAX_LIMBS limbs with fixed
+    // width integers, over a range that crosses from one limb to two; each
+    // should match the factors found by plain trial division
+    Number fixedLoMark;
+    Number fixedHiMark;
+    mpz_set_ui(fixedLoMark.value,1);
+    mpz_mul_2exp(fixedLoMark.value,fixedLoMark.value,64);
+    mpz_sub_ui(fixedLoMark.value,fixedLoMark.value,500);
+    mpz_add_ui(fixedHiMark.value,fixedLoMark.value,1000);
+    for(register unsigned int limbs = 1; limbs <= BIGINT_MAX_LIMBS; ++limbs)
+    {
+        // 720720 times a power of 2, times 2^64+1 if it is longer than a limb,
+        // so it has factors on both sides of 2^64
+        Number subject;
+        mpz_set_ui(subject.value,720720);
+        if (limbs == 1)
+        {
+            mpz_mul_2exp(subject.value,subject.value,32);
+        }
+        else
+        {
+            Number shifted;
+            mpz_mul_2exp(subject.value,subject.value,64*(limbs-2)+8);
+            mpz_mul_2exp(shifted.value,subject.value,64);
+            mpz_add(subject.value,subject.value,shifted.value);
+        }
+
+        FindFactorsTask fixedTask(subject.value,fixedHiMark.value,fixedLoMark.value);
+        FindFactorsTask trialTask(subject.value,fixedHiMark.value,fixedLoMark.value);
+        fixedTask.set_kernel(KERNEL_FIXED_WIDTH);
+        trialTask.set_kernel(KERNEL_TRIAL_DIVISION);
+        fixedTask.execute();
+        trialTask.execute();
+        std::vector<mpz_t*>* fixedResults = fixedTask.get_results();
+        std::vector<mpz_t*>* trialResults = trialTask.get_results();
+
+        bool same = fixedResults->size() == trialResults->size();
+        for(register unsigned int j = 0; same && j < fixedResults->size(); ++j)
+        {
+            same = mpz_cmp(*fixedResults->at(j),*trialResults->at(j)) == 0;
+        }
+        printf("%u limbs: %lu factors, %s\n",limbs,fixedResults->size(),same ? "same" : "DIFFERENT");
+    }
+
+    // find the factors of numbers of 1 to 2*BIGINT_MAX_LIMBS limbs a batch of
+    // candidates at a time, over the small candidates, where the candidates
+    // need shifting, and over the range that crosses into two limbs; each
+    // should match the factors found by plain trial division
+    Number smallLoMark;
+    Number smallHiMark;
+    mpz_set_ui(smallLoMark.value,1);
+    mpz_set_ui(smallHiMark.value,2000);
+    mpz_t* loMarks[] = {&smallLoMark.value,&fixedLoMark.value};
+    mpz_t* hiMarks[] = {&smallHiMark.value,&fixedHiMark.value};
+    for(register unsigned int limbs = 1; limbs <= 2*BIGINT_MAX_LIMBS; ++limbs)
+    {
+        // 720720 times a power of 2, times 2^64+1 if it is longer than a limb,
+        // so it has factors all over both ranges
+        Number subject;
+        Number shifted;
+        mpz_set_ui(subject.value,720720);
+        mpz_mul_2exp(subject.value,subject.value,limbs > 2 ? 64*(limbs-2)+8 : 0);
+        if (limbs > 1)
+        {
+            mpz_mul_2exp(shifted.value,subject.value,64);
+            mpz_add(subject.value,subject.value,shifted.value);
+        }
+
+        for(register unsigned int r = 0; r < sizeof(loMarks)/sizeof(*loMarks); ++r)
+        {
+            FindFactorsTask multiTask(subject.value,*hiMarks[r],*loMarks[r]);
+            FindFactorsTask trialTask(subject.value,*hiMarks[r],*loMarks[r]);
+            multiTask.set_kernel(KERNEL_MULTI_MODULUS);
+            trialTask.set_kernel(KERNEL_TRIAL_DIVISION);
+            multiTask.execute();
+            trialTask.execute();
+            std::vector<mpz_t*>* multiResults = multiTask.get_results();
+            std::vector<mpz_t*>* trialResults = trialTask.get_results();
+
+            bool same = multiResults->size() == trialResults->size();
+            for(register unsigned int j = 0; same && j < multiResults->size(); ++j)
+            {
+                same = mpz_cmp(*multiResults->at(j),*trialResults->at(j)) == 0;
+            }
+            printf("%u limbs, range %u: %lu factors, %s\n",limbs,r,multiResults->size(),same ? "same" : "DIFFERENT");
+        }
+    }
+
     return 0;
 }
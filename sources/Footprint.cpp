@@ -0,0 +1,509 @@
+/**
+ * implementation of the memory footprint functions declared in Footprint.h
+ *
+ * @sourceFile Footprint.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the sizes of the processes are read from /proc. the workers are found
+ *   through the children files of the threads of the program, so any child
+ *   still alive is counted, whichever thread forked it. the peak resident set
+ *   size of the workers is the largest of any of them, including those that
+ *   were already reaped.
+ *
+ * GMP passes the size of a block to its free, and reallocate functions, so
+ *   the count is kept without looking inside the blocks. it is updated with
+ *   atomic adds, so every thread, and process can share it.
+ */
+#include "Footprint.h"
+#include <gmp.h>
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+
+/**
+ * bytes GMP has allocated, and the most it ever had allocated at once.
+ */
+struct GmpCounters
+{
+    long long bytes;
+    long long peak;
+};
+
+/**
+ * a queue, or pipe whose occupancy is reported.
+ */
+struct Watch
+{
+    const char* name;
+    sem_t* notFullSem;
+    unsigned int capacity;
+    int fd;
+};
+
+static void* count_allocate(size_t size);
+static void* count_reallocate(void* block,size_t oldSize,size_t newSize);
+static void count_free(void* block,size_t size);
+static void add_gmp_bytes(long long amount);
+static long read_kib(const char* path,const char* field);
+static void measure_workers(long* pss,long* peak);
+
+/**
+ * counters in shared memory, or 0 if the footprint is not measured.
+ */
+static GmpCounters* gmpCounters = 0;
+
+/**
+ * memory functions GMP had before they were wrapped.
+ */
+static void* (*allocate)(size_t);
+static void* (*reallocate)(void*,size_t,size_t);
+static void (*release)(void*,size_t);
+
+/**
+ * queues, and pipes that are reported.
+ */
+static Watch watches[FOOTPRINT_WATCHES];
+static unsigned int numWatches = 0;
+
+/**
+ * starts counting the bytes GMP allocates.
+ *
+ * @function   footprint_enable
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       does nothing if it was already called.
+ *
+ * @signature  bool footprint_enable()
+ *
+ * @return     true if the footprint is measured; false otherwise, with errno
+ *   set.
+ */
+bool footprint_enable()
+{
+    if (gmpCounters != 0)
+    {
+        return true;
+    }
+    void* counters = mmap(0,sizeof(GmpCounters),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    if (counters == MAP_FAILED)
+    {
+        return false;
+    }
+    gmpCounters = (GmpCounters*) counters;
+    mp_get_memory_functions(&allocate,&reallocate,&release);
+    mp_set_memory_functions(count_allocate,count_reallocate,count_free);
+    return true;
+}
+
+/**
+ * returns whether the footprint is measured.
+ *
+ * @function   footprint_enabled
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool footprint_enabled()
+ *
+ * @return     true if footprint_enable was called, and succeeded.
+ */
+bool footprint_enabled()
+{
+    return gmpCounters != 0;
+}
+
+/**
+ * reports how many tasks are in a queue.
+ *
+ * @function   footprint_watch_queue
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       ignored once FOOTPRINT_WATCHES queues, and pipes are watched.
+ *
+ * @signature  void footprint_watch_queue(const char* name,sem_t* notFullSem,
+ *   unsigned int capacity)
+ *
+ * @param      name name of the queue in the report.
+ * @param      notFullSem semaphore counting the room left in the queue.
+ * @param      capacity number of tasks that fit in the queue.
+ */
+void footprint_watch_queue(const char* name,sem_t* notFullSem,unsigned int capacity)
+{
+    if (numWatches < FOOTPRINT_WATCHES)
+    {
+        Watch watch = {name,notFullSem,capacity,-1};
+        watches[numWatches++] = watch;
+    }
+}
+
+/**
+ * reports how many bytes are waiting to be read from a pipe.
+ *
+ * @function   footprint_watch_pipe
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       ignored once FOOTPRINT_WATCHES queues, and pipes are watched.
+ *
+ * @signature  void footprint_watch_pipe(const char* name,int fd)
+ *
+ * @param      name name of the pipe in the report.
+ * @param      fd read end of the pipe.
+ */
+void footprint_watch_pipe(const char* name,int fd)
+{
+    if (numWatches < FOOTPRINT_WATCHES)
+    {
+        Watch watch = {name,0,0,fd};
+        watches[numWatches++] = watch;
+    }
+}
+
+/**
+ * stops reporting every queue, and pipe.
+ *
+ * @function   footprint_unwatch
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       called by a transport before its queue, and pipes go away.
+ *
+ * @signature  void footprint_unwatch()
+ */
+void footprint_unwatch()
+{
+    numWatches = 0;
+}
+
+/**
+ * formats the footprint as a line of text.
+ *
+ * @function   footprint_format
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       sizes are in KiB, except the pipes, which are in bytes. the line
+ *   ends with a newline, and is cut short if it does not fit.
+ *
+ * @signature  void footprint_format(char* line,size_t size,
+ *   size_t resultBytes)
+ *
+ * @param      line set to the line.
+ * @param      size size of the line buffer.
+ * @param      resultBytes bytes of the factors held by the collector.
+ */
+void footprint_format(char* line,size_t size,size_t resultBytes)
+{
+    long workersPss;
+    long workersPeak;
+    measure_workers(&workersPss,&workersPeak);
+    long long gmpBytes = gmpCounters != 0 ? __sync_fetch_and_add(&gmpCounters->bytes,0) : 0;
+    long long gmpPeak = gmpCounters != 0 ? __sync_fetch_and_add(&gmpCounters->peak,0) : 0;
+
+    size_t length = snprintf(line,size,
+        "memory: rss %ld KiB, peak rss %ld KiB, pss %ld KiB, workers pss %ld KiB, workers peak rss %ld KiB, "
+        "gmp heap %lld KiB, peak gmp heap %lld KiB, results %lu KiB",
+        read_kib("/proc/self/status","VmRSS"),read_kib("/proc/self/status","VmHWM"),
+        read_kib("/proc/self/smaps_rollup","Pss"),workersPss,workersPeak,
+        (gmpBytes > 0 ? gmpBytes : 0)/1024,gmpPeak/1024,(unsigned long) resultBytes/1024);
+    for(register unsigned int i = 0; i < numWatches && length < size; ++i)
+    {
+        Watch* watch = &watches[i];
+        if (watch->notFullSem != 0)
+        {
+            // exiting workers post the semaphore once more each, so it can
+            // end up above the capacity
+            int room = 0;
+            sem_getvalue(watch->notFullSem,&room);
+            length += snprintf(line+length,size-length,", %s %u/%u tasks",watch->name,
+                room < (int) watch->capacity ? watch->capacity-(room > 0 ? room : 0) : 0,watch->capacity);
+        }
+        else
+        {
+            int waiting = 0;
+            ioctl(watch->fd,FIONREAD,&waiting);
+            length += snprintf(line+length,size-length,", %s %d B",watch->name,waiting);
+        }
+    }
+    if (length < size)
+    {
+        snprintf(line+length,size-length,"\n");
+    }
+}
+
+/**
+ * allocates a block for GMP, and counts it.
+ *
+ * @function   count_allocate
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       GMP's own functions abort if they run out of memory, so the
+ *   block is never 0.
+ *
+ * @signature  void* count_allocate(size_t size)
+ *
+ * @param      size size of the block.
+ *
+ * @return     the block.
+ */
+void* count_allocate(size_t size)
+{
+    void* block = allocate(size);
+    add_gmp_bytes(size);
+    return block;
+}
+
+/**
+ * resizes a block for GMP, and counts the difference.
+ *
+ * @function   count_reallocate
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void* count_reallocate(void* block,size_t oldSize,
+ *   size_t newSize)
+ *
+ * @param      block block to resize.
+ * @param      oldSize size of the block.
+ * @param      newSize size to resize it to.
+ *
+ * @return     the resized block.
+ */
+void* count_reallocate(void* block,size_t oldSize,size_t newSize)
+{
+    void* resized = reallocate(block,oldSize,newSize);
+    add_gmp_bytes((long long) newSize-(long long) oldSize);
+    return resized;
+}
+
+/**
+ * frees a block for GMP, and stops counting it.
+ *
+ * @function   count_free
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void count_free(void* block,size_t size)
+ *
+ * @param      block block to free.
+ * @param      size size of the block.
+ */
+void count_free(void* block,size_t size)
+{
+    release(block,size);
+    add_gmp_bytes(-(long long) size);
+}
+
+/**
+ * adds to the bytes GMP has allocated, and raises the peak to match.
+ *
+ * @function   add_gmp_bytes
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void add_gmp_bytes(long long amount)
+ *
+ * @param      amount number of bytes allocated; negative if they were freed.
+ */
+void add_gmp_bytes(long long amount)
+{
+    long long bytes = __sync_add_and_fetch(&gmpCounters->bytes,amount);
+    long long peak = gmpCounters->peak;
+    while(peak < bytes && !__sync_bool_compare_and_swap(&gmpCounters->peak,peak,bytes))
+    {
+        peak = gmpCounters->peak;
+    }
+}
+
+/**
+ * reads a size in kB out of one of the files in /proc.
+ *
+ * @function   read_kib
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the file is made of "field: value kB" lines.
+ *
+ * @signature  long read_kib(const char* path,const char* field)
+ *
+ * @param      path path of the file.
+ * @param      field name of the field.
+ *
+ * @return     the size in KiB, or 0 if it could not be read.
+ */
+long read_kib(const char* path,const char* field)
+{
+    FILE* file = fopen(path,"r");
+    if (file == 0)
+    {
+        return 0;
+    }
+    char line[256];
+    size_t length = strlen(field);
+    long kib = 0;
+    while(fgets(line,sizeof(line),file) != 0)
+    {
+        if (strncmp(line,field,length) == 0 && line[length] == ':')
+        {
+            sscanf(line+length+1,"%ld",&kib);
+            break;
+        }
+    }
+    fclose(file);
+    return kib;
+}
+
+/**
+ * measures the worker processes that are children of the program.
+ *
+ * @function   measure_workers
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       see the top of this file for how the workers are found.
+ *
+ * @signature  void measure_workers(long* pss,long* peak)
+ *
+ * @param      pss set to the proportional set size of the live workers
+ *   together, in KiB.
+ * @param      peak set to the peak resident set size of the largest worker,
+ *   in KiB.
+ */
+void measure_workers(long* pss,long* peak)
+{
+    rusage usage;
+    *pss = 0;
+    *peak = getrusage(RUSAGE_CHILDREN,&usage) == 0 ? usage.ru_maxrss : 0;
+
+    DIR* threads = opendir("/proc/self/task");
+    if (threads == 0)
+    {
+        return;
+    }
+    dirent* thread;
+    while((thread = readdir(threads)) != 0)
+    {
+        if (thread->d_name[0] == '.')
+        {
+            continue;
+        }
+        char path[320];
+        snprintf(path,sizeof(path),"/proc/self/task/%s/children",thread->d_name);
+        FILE* children = fopen(path,"r");
+        if (children == 0)
+        {
+            continue;
+        }
+        int child;
+        while(fscanf(children,"%d",&child) == 1)
+        {
+            snprintf(path,sizeof(path),"/proc/%d/smaps_rollup",child);
+            *pss += read_kib(path,"Pss");
+            snprintf(path,sizeof(path),"/proc/%d/status",child);
+            long childPeak = read_kib(path,"VmHWM");
+            if (childPeak > *peak)
+            {
+                *peak = childPeak;
+            }
+        }
+        fclose(children);
+    }
+    closedir(threads);
+}
@@ -0,0 +1,55 @@
+/**
+ * header file for memory footprint accounting. implementation is in
+ *   Footprint.cpp
+ *
+ * @sourceFile Footprint.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * measures how much memory a run takes up: the resident, and proportional set
+ *   size of the program, and of its worker processes, the peak resident set
+ *   size of both, the bytes GMP has allocated, the bytes of the factors the
+ *   collector holds, and how full the task queue, and the pipes are.
+ *
+ * the bytes GMP has allocated are counted by memory functions that wrap the
+ *   ones GMP had, so footprint_enable must be called before the worker
+ *   processes are forked, and as early as possible. the count lives in shared
+ *   memory, so worker processes add to the same count. memory that GMP
+ *   allocated before the functions were set is not counted.
+ *
+ * the transports watch their queue, and pipes with footprint_watch_queue, and
+ *   footprint_watch_pipe. a queue is measured by the value of the semaphore
+ *   that counts the room left in it, and a pipe by the bytes that are waiting
+ *   to be read from it.
+ *
+ * the proportional set size splits memory shared between processes, like the
+ *   pages the workers inherit from the parent, evenly between them, so the
+ *   sizes of every process add up to what they take up together.
+ */
+#ifndef FOOTPRINT_H
+#define FOOTPRINT_H
+
+#include <stddef.h>
+#include <semaphore.h>
+
+#define FOOTPRINT_WATCHES 4
+#define FOOTPRINT_LINE_SIZE 512
+
+bool footprint_enable();
+bool footprint_enabled();
+void footprint_watch_queue(const char* name,sem_t* notFullSem,unsigned int capacity);
+void footprint_watch_pipe(const char* name,int fd);
+void footprint_unwatch();
+void footprint_format(char* line,size_t size,size_t resultBytes);
+
+#endif
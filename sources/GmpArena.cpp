@@ -0,0 +1,622 @@
+/**
+ * implementation of the pool allocator declared in GmpArena.h
+ *
+ * @sourceFile GmpArena.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   AllocatorBenchmark.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * GMP passes the size of a block to its free, and reallocate functions, so
+ *   the class of a block is worked out from its size, and blocks need no
+ *   header. a free block holds the pointer to the next one in its list.
+ *
+ * the reserved range is mapped without reserving swap, so only the slabs
+ *   that are carved out of it ever take up memory. slabs are handed out by an
+ *   atomic add to the carved offset. once the range is used up, blocks come
+ *   from malloc like the big ones. what is left of a slab when a thread takes
+ *   a new one is not used.
+ *
+ * worker processes inherit the range, and the caches of the thread that
+ *   forked them, as copies of their own. the central locks are all taken
+ *   around fork, so a process forked while another thread holds one, like the
+ *   reporter, or the checkpoint writer, does not start with it held, and the
+ *   central lists it inherits are whole.
+ */
+#include "GmpArena.h"
+#include <gmp.h>
+#include <errno.h>
+#include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include "Lock.h"
+
+/**
+ * a free block in a cache, or central list.
+ */
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+/**
+ * the free blocks of a thread, and the slab it carves new ones out of.
+ */
+struct ThreadCache
+{
+    char* slab;
+    size_t slabLeft;
+    FreeBlock* blocks[GMP_ARENA_CLASSES];
+    unsigned int cached[GMP_ARENA_CLASSES];
+};
+
+static void* arena_allocate(size_t size);
+static void* arena_reallocate(void* block,size_t oldSize,size_t newSize);
+static void arena_free(void* block,size_t size);
+static unsigned int class_of(size_t size);
+static bool in_arena(void* block);
+static void* carve(unsigned int blockClass);
+static void refill(unsigned int blockClass);
+static void give_back(unsigned int blockClass,unsigned int keep);
+static void lock_central();
+static void unlock_central();
+
+/**
+ * the reserved range, or 0 if the arena is not enabled, and how much of it
+ *   has been carved into slabs.
+ */
+static char* reserved = 0;
+static size_t carved = 0;
+
+/**
+ * central lists of free blocks of each class, and the semaphores that guard
+ *   them.
+ */
+static FreeBlock* central[GMP_ARENA_CLASSES];
+static sem_t centralAccess[GMP_ARENA_CLASSES];
+
+/**
+ * cache of the calling thread.
+ */
+static __thread ThreadCache cache;
+
+/**
+ * memory functions GMP had before the arena was enabled.
+ */
+static void* (*allocate)(size_t);
+static void* (*reallocate)(void*,size_t,size_t);
+static void (*release)(void*,size_t);
+
+/**
+ * makes GMP allocate its limbs from the arena.
+ *
+ * @function   gmp_arena_enable
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must be called before any other thread uses GMP. does nothing if
+ *   it was already called.
+ *
+ * @signature  bool gmp_arena_enable()
+ *
+ * @return     true if the arena is enabled; false otherwise, with errno set.
+ */
+bool gmp_arena_enable()
+{
+    if (reserved != 0)
+    {
+        return true;
+    }
+    void* range = mmap(0,GMP_ARENA_RESERVE,PROT_READ|PROT_WRITE,
+        MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE,-1,0);
+    if (range == MAP_FAILED)
+    {
+        return false;
+    }
+    for(register unsigned int i = 0; i < GMP_ARENA_CLASSES; ++i)
+    {
+        central[i] = 0;
+        sem_init(&centralAccess[i],0,1);
+    }
+    int error = pthread_atfork(lock_central,unlock_central,unlock_central);
+    if (error != 0)
+    {
+        munmap(range,GMP_ARENA_RESERVE);
+        errno = error;
+        return false;
+    }
+    reserved = (char*) range;
+    mp_get_memory_functions(&allocate,&reallocate,&release);
+    mp_set_memory_functions(arena_allocate,arena_reallocate,arena_free);
+    return true;
+}
+
+/**
+ * returns whether GMP allocates from the arena.
+ *
+ * @function   gmp_arena_enabled
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool gmp_arena_enabled()
+ *
+ * @return     true if gmp_arena_enable was called, and succeeded.
+ */
+bool gmp_arena_enabled()
+{
+    return reserved != 0;
+}
+
+/**
+ * trims the cache of the calling thread once it is done with a task.
+ *
+ * @function   gmp_arena_task_done
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       keeps GMP_ARENA_KEEP_BLOCKS blocks of each class. does nothing
+ *   if the arena is not enabled.
+ *
+ * @signature  void gmp_arena_task_done()
+ */
+void gmp_arena_task_done()
+{
+    if (reserved == 0)
+    {
+        return;
+    }
+    for(register unsigned int i = 0; i < GMP_ARENA_CLASSES; ++i)
+    {
+        if (cache.cached[i] > GMP_ARENA_KEEP_BLOCKS)
+        {
+            give_back(i,GMP_ARENA_KEEP_BLOCKS);
+        }
+    }
+}
+
+/**
+ * passes every block cached by the calling thread to the central lists.
+ *
+ * @function   gmp_arena_thread_done
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       called by a thread before it terminates, so its blocks are not
+ *   lost with it. does nothing if the arena is not enabled.
+ *
+ * @signature  void gmp_arena_thread_done()
+ */
+void gmp_arena_thread_done()
+{
+    if (reserved == 0)
+    {
+        return;
+    }
+    for(register unsigned int i = 0; i < GMP_ARENA_CLASSES; ++i)
+    {
+        give_back(i,0);
+    }
+}
+
+/**
+ * returns how much of the reserved range has been carved into slabs.
+ *
+ * @function   gmp_arena_carved
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       this is the most memory the arena can take up.
+ *
+ * @signature  size_t gmp_arena_carved()
+ *
+ * @return     number of bytes in slabs.
+ */
+size_t gmp_arena_carved()
+{
+    size_t bytes = __sync_fetch_and_add(&carved,0);
+    return bytes < GMP_ARENA_RESERVE ? bytes : GMP_ARENA_RESERVE;
+}
+
+/**
+ * allocates a block for GMP.
+ *
+ * @function   arena_allocate
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       takes the block from the cache of the thread, refilling it from
+ *   the central list, or carving a new block if it is empty.
+ *
+ * @signature  void* arena_allocate(size_t size)
+ *
+ * @param      size size of the block.
+ *
+ * @return     the block.
+ */
+void* arena_allocate(size_t size)
+{
+    if (size > GMP_ARENA_MAX_BLOCK)
+    {
+        return allocate(size);
+    }
+    unsigned int blockClass = class_of(size);
+    if (cache.blocks[blockClass] == 0)
+    {
+        refill(blockClass);
+    }
+    FreeBlock* block = cache.blocks[blockClass];
+    if (block == 0)
+    {
+        void* carvedBlock = carve(blockClass);
+        return carvedBlock != 0 ? carvedBlock : allocate(size);
+    }
+    cache.blocks[blockClass] = block->next;
+    --cache.cached[blockClass];
+    return block;
+}
+
+/**
+ * resizes a block for GMP.
+ *
+ * @function   arena_reallocate
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a block that still fits its class is left where it is. blocks
+ *   that are too big for the arena are resized by the functions GMP had;
+ *   anything else is moved into a block of the new size.
+ *
+ * @signature  void* arena_reallocate(void* block,size_t oldSize,
+ *   size_t newSize)
+ *
+ * @param      block block to resize.
+ * @param      oldSize size of the block.
+ * @param      newSize size to resize it to.
+ *
+ * @return     the resized block.
+ */
+void* arena_reallocate(void* block,size_t oldSize,size_t newSize)
+{
+    bool inArena = in_arena(block);
+    if (!inArena && newSize > GMP_ARENA_MAX_BLOCK)
+    {
+        return reallocate(block,oldSize,newSize);
+    }
+    if (inArena && newSize <= GMP_ARENA_MAX_BLOCK && class_of(oldSize) == class_of(newSize))
+    {
+        return block;
+    }
+    void* moved = arena_allocate(newSize);
+    memcpy(moved,block,oldSize < newSize ? oldSize : newSize);
+    arena_free(block,oldSize);
+    return moved;
+}
+
+/**
+ * frees a block for GMP.
+ *
+ * @function   arena_free
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the block goes to the cache of the calling thread; half the
+ *   cache goes to the central list once it holds too many blocks.
+ *
+ * @signature  void arena_free(void* block,size_t size)
+ *
+ * @param      block block to free.
+ * @param      size size of the block.
+ */
+void arena_free(void* block,size_t size)
+{
+    if (!in_arena(block))
+    {
+        release(block,size);
+        return;
+    }
+    unsigned int blockClass = class_of(size);
+    FreeBlock* freed = (FreeBlock*) block;
+    freed->next = cache.blocks[blockClass];
+    cache.blocks[blockClass] = freed;
+    if (++cache.cached[blockClass] > GMP_ARENA_CACHE_BLOCKS)
+    {
+        give_back(blockClass,GMP_ARENA_CACHE_BLOCKS/2);
+    }
+}
+
+/**
+ * returns the class of blocks of a size.
+ *
+ * @function   class_of
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       class i holds blocks of GMP_ARENA_MIN_BLOCK<<i bytes.
+ *
+ * @signature  unsigned int class_of(size_t size)
+ *
+ * @param      size size of the block, at most GMP_ARENA_MAX_BLOCK.
+ *
+ * @return     class of the block.
+ */
+unsigned int class_of(size_t size)
+{
+    if (size <= GMP_ARENA_MIN_BLOCK)
+    {
+        return 0;
+    }
+    return sizeof(unsigned long)*8-__builtin_clzl(size-1)-4;
+}
+
+/**
+ * returns whether a block lies in the reserved range.
+ *
+ * @function   in_arena
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool in_arena(void* block)
+ *
+ * @param      block block to check.
+ *
+ * @return     true if the block came from the arena.
+ */
+bool in_arena(void* block)
+{
+    return (char*) block >= reserved && (char*) block < reserved+GMP_ARENA_RESERVE;
+}
+
+/**
+ * carves a new block out of the slab of the calling thread.
+ *
+ * @function   carve
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       takes a new slab if the block does not fit in what is left.
+ *
+ * @signature  void* carve(unsigned int blockClass)
+ *
+ * @param      blockClass class of the block.
+ *
+ * @return     the block, or 0 if the reserved range is used up.
+ */
+void* carve(unsigned int blockClass)
+{
+    size_t size = (size_t) GMP_ARENA_MIN_BLOCK<<blockClass;
+    if (cache.slabLeft < size)
+    {
+        size_t offset = __sync_fetch_and_add(&carved,(size_t) GMP_ARENA_SLAB_SIZE);
+        if (offset+GMP_ARENA_SLAB_SIZE > GMP_ARENA_RESERVE)
+        {
+            return 0;
+        }
+        cache.slab = reserved+offset;
+        cache.slabLeft = GMP_ARENA_SLAB_SIZE;
+    }
+    void* block = cache.slab;
+    cache.slab += size;
+    cache.slabLeft -= size;
+    return block;
+}
+
+/**
+ * moves up to GMP_ARENA_KEEP_BLOCKS blocks of a class from the central list
+ *   to the cache of the calling thread.
+ *
+ * @function   refill
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void refill(unsigned int blockClass)
+ *
+ * @param      blockClass class of the blocks.
+ */
+void refill(unsigned int blockClass)
+{
+    // checked without the lock first, so an empty list costs nothing
+    if (central[blockClass] == 0)
+    {
+        return;
+    }
+    Lock scopelock(&centralAccess[blockClass]);
+    for(register unsigned int i = 0; i < GMP_ARENA_KEEP_BLOCKS && central[blockClass] != 0; ++i)
+    {
+        FreeBlock* block = central[blockClass];
+        central[blockClass] = block->next;
+        block->next = cache.blocks[blockClass];
+        cache.blocks[blockClass] = block;
+        ++cache.cached[blockClass];
+    }
+}
+
+/**
+ * moves the blocks of a class in the cache of the calling thread to the
+ *   central list, until only some of them are left.
+ *
+ * @function   give_back
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the blocks are linked together before the lock is taken, so it
+ *   is only held to splice them in.
+ *
+ * @signature  void give_back(unsigned int blockClass,unsigned int keep)
+ *
+ * @param      blockClass class of the blocks.
+ * @param      keep number of blocks to leave in the cache.
+ */
+void give_back(unsigned int blockClass,unsigned int keep)
+{
+    if (cache.cached[blockClass] <= keep)
+    {
+        return;
+    }
+
+    // the blocks past the first keep ones are given back
+    FreeBlock** link = &cache.blocks[blockClass];
+    for(register unsigned int i = 0; i < keep; ++i)
+    {
+        link = &(*link)->next;
+    }
+    FreeBlock* first = *link;
+    FreeBlock* last = first;
+    while(last->next != 0)
+    {
+        last = last->next;
+    }
+    *link = 0;
+    cache.cached[blockClass] = keep;
+
+    Lock scopelock(&centralAccess[blockClass]);
+    last->next = central[blockClass];
+    central[blockClass] = first;
+}
+
+/**
+ * takes every central lock; called by the thread that forks, right before
+ *   the fork.
+ *
+ * @function   lock_central
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a thread only ever holds one central lock, so taking them all in
+ *   order cannot deadlock.
+ *
+ * @signature  void lock_central()
+ */
+void lock_central()
+{
+    for(register unsigned int i = 0; i < GMP_ARENA_CLASSES; ++i)
+    {
+        while(sem_wait(&centralAccess[i]) < 0 && errno == EINTR);
+    }
+}
+
+/**
+ * releases every central lock taken by lock_central; called after the fork in
+ *   both the parent, and the child.
+ *
+ * @function   unlock_central
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the child has its own copy of the semaphores, which only the
+ *   forking thread held, so posting them leaves them free.
+ *
+ * @signature  void unlock_central()
+ */
+void unlock_central()
+{
+    for(register unsigned int i = 0; i < GMP_ARENA_CLASSES; ++i)
+    {
+        sem_post(&centralAccess[i]);
+    }
+}
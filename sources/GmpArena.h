@@ -0,0 +1,64 @@
+/**
+ * header file for the pool allocator that GMP can be made to use. the
+ *   implementation is in GmpArena.cpp
+ *
+ * @sourceFile GmpArena.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   AllocatorBenchmark.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * once gmp_arena_enable is called, GMP allocates its limbs from pools
+ *   instead of malloc. blocks are grouped in classes by size, powers of 2
+ *   from GMP_ARENA_MIN_BLOCK to GMP_ARENA_MAX_BLOCK bytes; bigger blocks still
+ *   come from malloc.
+ *
+ * every thread keeps a cache of free blocks of each class, so allocating, and
+ *   freeing a block takes no lock. a thread carves new blocks out of a slab of
+ *   its own, which it takes from a range of address space reserved up front.
+ *   blocks freed by a thread go to its own cache, whichever thread allocated
+ *   them, so a thread that frees more than it allocates, like one that deletes
+ *   the results of other threads, would pile them up. once a cache holds more
+ *   than GMP_ARENA_CACHE_BLOCKS blocks of a class, half of them move to a
+ *   central list, which threads refill their caches from before carving new
+ *   blocks.
+ *
+ * the workers call gmp_arena_task_done between tasks, which trims their
+ *   caches down to GMP_ARENA_KEEP_BLOCKS blocks of each class, so the blocks a
+ *   task let go of can be used by the other threads, but the next task still
+ *   reuses the ones it is likely to need. a thread that terminates passes all
+ *   of its cached blocks on with gmp_arena_thread_done.
+ *
+ * memory that GMP allocated before gmp_arena_enable was called is still freed
+ *   by the functions GMP had; blocks are told apart by whether they lie in the
+ *   reserved range.
+ */
+#ifndef GMPARENA_H
+#define GMPARENA_H
+
+#include <stddef.h>
+
+#define GMP_ARENA_RESERVE (1ULL<<34)
+#define GMP_ARENA_SLAB_SIZE (1<<20)
+#define GMP_ARENA_MIN_BLOCK 16
+#define GMP_ARENA_MAX_BLOCK 65536
+#define GMP_ARENA_CLASSES 13
+#define GMP_ARENA_CACHE_BLOCKS 256
+#define GMP_ARENA_KEEP_BLOCKS 32
+
+bool gmp_arena_enable();
+bool gmp_arena_enabled();
+void gmp_arena_task_done();
+void gmp_arena_thread_done();
+size_t gmp_arena_carved();
+
+#endif
@@ -0,0 +1,349 @@
+/**
+ * implementation of the IoRing class declared in IoRing.h
+ *
+ * @sourceFile IoRing.cpp
+ *
+ * @program    Processes-Main.out
+ *
+ * @class      IoRing
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * submission queue entries are filled in by the caller after get_sqe returns
+ *   them, and only handed to the kernel when submit is called. completions are
+ *   consumed one at a time with next_completion.
+ */
+#include "IoRing.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/**
+ * sets up an io_uring instance, and maps its rings into memory.
+ *
+ * @class      IoRing
+ *
+ * @method     IoRing
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       if anything fails, or the kernel is too old to wait for
+ *   completions with a timeout, the instance is left closed; is_open returns
+ *   false.
+ *
+ * @signature  IoRing::IoRing(unsigned int entries)
+ *
+ * @param      entries number of entries in the submission queue.
+ *
+ * @return     an instance of IoRing.
+ */
+IoRing::IoRing(unsigned int entries)
+    :fd(-1)
+    ,sqEntries(0)
+    ,sqeTail(0)
+    ,sqes((io_uring_sqe*) MAP_FAILED)
+    ,sqRing(MAP_FAILED)
+    ,cqRing(MAP_FAILED)
+    ,sqRingSize(0)
+    ,cqRingSize(0)
+{
+    io_uring_params params;
+    memset(&params,0,sizeof(params));
+    fd = syscall(__NR_io_uring_setup,entries,&params);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    // waiting for completions with a timeout needs IORING_FEAT_EXT_ARG
+    if (!(params.features & IORING_FEAT_EXT_ARG))
+    {
+        release();
+        return;
+    }
+
+    // map the rings. kernels with IORING_FEAT_SINGLE_MMAP share one mapping
+    // between the submission, and completion rings
+    sqEntries = params.sq_entries;
+    sqRingSize = params.sq_off.array+params.sq_entries*sizeof(unsigned int);
+    cqRingSize = params.cq_off.cqes+params.cq_entries*sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        sqRingSize = cqRingSize = sqRingSize > cqRingSize ? sqRingSize : cqRingSize;
+    }
+    sqRing = mmap(0,sqRingSize,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,fd,IORING_OFF_SQ_RING);
+    cqRing = (params.features & IORING_FEAT_SINGLE_MMAP) ? sqRing :
+        mmap(0,cqRingSize,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,fd,IORING_OFF_CQ_RING);
+    sqes = (io_uring_sqe*) mmap(0,params.sq_entries*sizeof(io_uring_sqe),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,fd,IORING_OFF_SQES);
+    if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED)
+    {
+        release();
+        return;
+    }
+
+    sqHead = (unsigned int*) ((char*) sqRing+params.sq_off.head);
+    sqTail = (unsigned int*) ((char*) sqRing+params.sq_off.tail);
+    sqMask = (unsigned int*) ((char*) sqRing+params.sq_off.ring_mask);
+    sqArray = (unsigned int*) ((char*) sqRing+params.sq_off.array);
+    cqHead = (unsigned int*) ((char*) cqRing+params.cq_off.head);
+    cqTail = (unsigned int*) ((char*) cqRing+params.cq_off.tail);
+    cqMask = (unsigned int*) ((char*) cqRing+params.cq_off.ring_mask);
+    cqes = (io_uring_cqe*) ((char*) cqRing+params.cq_off.cqes);
+    sqeTail = *sqTail;
+}
+
+/**
+ * destructor for the IoRing; unmaps the rings, and closes the instance.
+ *
+ * @class      IoRing
+ *
+ * @method     ~IoRing
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       closing the instance cancels any requests still in flight.
+ *
+ * @signature  IoRing::~IoRing()
+ */
+IoRing::~IoRing()
+{
+    release();
+}
+
+/**
+ * returns true if the io_uring instance was set up successfully.
+ *
+ * @class      IoRing
+ *
+ * @method     is_open
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool IoRing::is_open()
+ *
+ * @return     true if the instance can be used; false otherwise.
+ */
+bool IoRing::is_open()
+{
+    return fd >= 0;
+}
+
+/**
+ * registers buffers with the kernel, so they can be used with
+ *   IORING_OP_READ_FIXED and IORING_OP_WRITE_FIXED.
+ *
+ * @class      IoRing
+ *
+ * @method     register_buffers
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the buffers are referred to by their index in the passed array.
+ *
+ * @signature  bool IoRing::register_buffers(iovec* buffers,unsigned int count)
+ *
+ * @param      buffers array of buffers to register.
+ * @param      count number of buffers in the array.
+ *
+ * @return     true if the buffers were registered; false otherwise.
+ */
+bool IoRing::register_buffers(iovec* buffers,unsigned int count)
+{
+    return syscall(__NR_io_uring_register,fd,IORING_REGISTER_BUFFERS,buffers,count) == 0;
+}
+
+/**
+ * returns the next free submission queue entry, cleared.
+ *
+ * @class      IoRing
+ *
+ * @method     get_sqe
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the entry is not seen by the kernel until submit is called.
+ *
+ * @signature  io_uring_sqe* IoRing::get_sqe()
+ *
+ * @return     the next free entry, or 0 if the submission queue is full.
+ */
+io_uring_sqe* IoRing::get_sqe()
+{
+    unsigned int head = __atomic_load_n(sqHead,__ATOMIC_ACQUIRE);
+    if (sqeTail-head >= sqEntries)
+    {
+        return 0;
+    }
+
+    unsigned int index = sqeTail & *sqMask;
+    io_uring_sqe* sqe = &sqes[index];
+    memset(sqe,0,sizeof(io_uring_sqe));
+    sqArray[index] = index;
+    ++sqeTail;
+    return sqe;
+}
+
+/**
+ * hands all the entries returned by get_sqe since the last call to the
+ *   kernel, and optionally waits for completions.
+ *
+ * @class      IoRing
+ *
+ * @method     submit
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int IoRing::submit(unsigned int waitFor,long timeoutMs)
+ *
+ * @param      waitFor number of completions to wait for; 0 to return right
+ *   away.
+ * @param      timeoutMs longest time to wait for the completions in
+ *   milliseconds.
+ *
+ * @return     number of entries submitted, or -1 with errno set on error.
+ *   errno is EINTR if the wait was interrupted by a signal, and ETIME if it
+ *   timed out.
+ */
+int IoRing::submit(unsigned int waitFor,long timeoutMs)
+{
+    __kernel_timespec timeout;
+    timeout.tv_sec = timeoutMs/1000;
+    timeout.tv_nsec = (timeoutMs%1000)*1000000L;
+
+    io_uring_getevents_arg arg;
+    memset(&arg,0,sizeof(arg));
+    arg.ts = (unsigned long) &timeout;
+
+    __atomic_store_n(sqTail,sqeTail,__ATOMIC_RELEASE);
+    unsigned int toSubmit = sqeTail-__atomic_load_n(sqHead,__ATOMIC_ACQUIRE);
+    return syscall(__NR_io_uring_enter,fd,toSubmit,waitFor,
+        (waitFor ? IORING_ENTER_GETEVENTS : 0)|IORING_ENTER_EXT_ARG,&arg,sizeof(arg));
+}
+
+/**
+ * takes the next completion off the completion queue.
+ *
+ * @class      IoRing
+ *
+ * @method     next_completion
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool IoRing::next_completion(io_uring_cqe* completion)
+ *
+ * @param      completion set to the completion, if there is one.
+ *
+ * @return     true if a completion was taken; false if the queue is empty.
+ */
+bool IoRing::next_completion(io_uring_cqe* completion)
+{
+    unsigned int head = *cqHead;
+    if (head == __atomic_load_n(cqTail,__ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+
+    *completion = cqes[head & *cqMask];
+    __atomic_store_n(cqHead,head+1,__ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * unmaps the rings, and closes the io_uring instance if they are open.
+ *
+ * @class      IoRing
+ *
+ * @method     release
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void IoRing::release()
+ */
+void IoRing::release()
+{
+    if (sqes != MAP_FAILED)
+    {
+        munmap(sqes,sqEntries*sizeof(io_uring_sqe));
+        sqes = (io_uring_sqe*) MAP_FAILED;
+    }
+    if (cqRing != MAP_FAILED && cqRing != sqRing)
+    {
+        munmap(cqRing,cqRingSize);
+    }
+    cqRing = MAP_FAILED;
+    if (sqRing != MAP_FAILED)
+    {
+        munmap(sqRing,sqRingSize);
+        sqRing = MAP_FAILED;
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * header file for the IoRing class. implementation is in IoRing.cpp
+ *
+ * @sourceFile IoRing.h
+ *
+ * @program    Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * used to wrap an io_uring instance so it is set up and mapped when an
+ *   instance of this class is constructed, and unmapped and closed when it is
+ *   destroyed. talks to the kernel through the raw system calls, so it does not
+ *   need liburing.
+ *
+ * if the kernel does not support io_uring, or it is disabled, or it is older
+ *   than 5.11, the instance is not open, and the caller is expected to fall back to regular system calls.
+ */
+#ifndef IORING_H
+#define IORING_H
+
+#include <stddef.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+class IoRing
+{
+public:
+
+    IoRing(unsigned int entries);
+    ~IoRing();
+    bool is_open();
+    bool register_buffers(iovec* buffers,unsigned int count);
+    io_uring_sqe* get_sqe();
+    int submit(unsigned int waitFor,long timeoutMs);
+    bool next_completion(io_uring_cqe* completion);
+
+private:
+
+    void release();
+
+    int fd;
+    unsigned int sqEntries;
+    unsigned int sqeTail;
+    unsigned int* sqHead;
+    unsigned int* sqTail;
+    unsigned int* sqMask;
+    unsigned int* sqArray;
+    unsigned int* cqHead;
+    unsigned int* cqTail;
+    unsigned int* cqMask;
+    io_uring_cqe* cqes;
+    io_uring_sqe* sqes;
+    void* sqRing;
+    void* cqRing;
+    size_t sqRingSize;
+    size_t cqRingSize;
+};
+
+#endif
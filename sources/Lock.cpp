@@ -24,6 +24,8 @@
  *   back to the semaphore.
  */
 #include "Lock.h"
+#include "Contention.h"
+#include "SpinWait.h"
 
 /**
  * waits upon the passed semaphore object.
@@ -38,7 +40,8 @@
  *
  * @programmer Eric Tsang
  *
- * @note       none
+ * @note       spins on the semaphore for a while before sleeping on it if
+ *   spinning is turned on; see SpinWait.h.
  *
  * @signature  Lock::Lock(sem_t* _sem)
  *
@@ -49,7 +52,11 @@
  */
 Lock::Lock(sem_t* _sem):sem(_sem)
 {
-    sem_wait(sem);
+#ifdef TRACE_CONTENTION
+    acquired = contention_wait(sem);
+#else
+    spin_wait(sem);
+#endif
 }
 
 /**
@@ -71,5 +78,8 @@ Lock::Lock(sem_t* _sem):sem(_sem)
  */
 Lock::~Lock()
 {
+#ifdef TRACE_CONTENTION
+    contention_held(sem,acquired);
+#endif
     sem_post(sem);
 }
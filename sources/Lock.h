@@ -17,6 +17,12 @@
  *
  * used to wait on, and post to a semaphore using the RAII (Resource Allocation
  *   Is Initialization) idiom.
+ *
+ * if spinning is turned on, the semaphore is spun on for a while before the
+ *   waiter goes to sleep, since most are held for a moment; see SpinWait.h.
+ *
+ * when built with TRACE_CONTENTION, how long the semaphore is waited for, and
+ *   held is recorded; see Contention.h.
  */
 #ifndef LOCK_H
 #define LOCK_H
@@ -30,6 +36,9 @@ public:
 
 private:
     sem_t* sem;
+#ifdef TRACE_CONTENTION
+    unsigned long long acquired;
+#endif
 };
 
 #endif
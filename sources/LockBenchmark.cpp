@@ -0,0 +1,352 @@
+/**
+ * benchmark of Lock under contention, spinning before sleeping, against plain
+ *   sem_wait.
+ *
+ * usage: ./LockBenchmark [--workers list] [--acquisitions n] [--work n]
+ *   [--processes] [--no-header]
+ *
+ * runs 1, 2, 4, 8, and 16 workers, or the comma separated counts given with
+ *   --workers, that each take a lock --acquisitions times (100000 by default),
+ *   and prints how long a take took as csv, one line per implementation, and
+ *   worker count. the critical section bumps a counter, and stores into a ring
+ *   of slots, about as much as popping a task off the queue; between takes, a
+ *   worker does --work iterations (100 by default) of busy work.
+ *
+ * the implementations are posix, which waits with sem_wait right away, and
+ *   spin, which is what Lock does with --spin; see SpinWait.h. the workers
+ *   are threads, or, with --processes, processes sharing the lock on a
+ *   MAP_SHARED page, like the workers of Processes-Main.
+ *
+ * the output has these columns:
+ *
+ *   implementation,backend,workers,acquisitions,seconds,ns_per_acquisition
+ *
+ * @sourceFile LockBenchmark.cpp
+ *
+ * @program    LockBenchmark.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * acquisitions is the total over every worker. the benchmark fails if the
+ *   counter does not add up to it, which would mean the lock let two workers
+ *   in at once.
+ *
+ * spin falls back to plain sem_wait on a machine with a single cpu, so both
+ *   implementations measure the same thing there.
+ */
+#include <time.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <vector>
+#include "SpinWait.h"
+#include "Lock.h"
+
+#define USAGE "usage: %s [--workers list] [--acquisitions n] [--work n] [--processes] [--no-header]\n"
+
+#define DEFAULT_WORKERS "1,2,4,8,16"
+#define DEFAULT_ACQUISITIONS 100000
+#define DEFAULT_WORK 100
+#define RING_SIZE 64
+
+/**
+ * what the workers share; lives on a MAP_SHARED page.
+ */
+struct Shared
+{
+    sem_t lock;
+    sem_t ready;
+    sem_t go;
+    volatile unsigned long counter;
+    unsigned long ring[RING_SIZE];
+    unsigned long acquisitions;
+    unsigned long work;
+};
+
+int main(int,char**);
+double run_line(Shared* shared,unsigned int numWorkers,bool processes);
+void* worker_routine(void* shared);
+
+/**
+ * entry point of the program.
+ *
+ * @function   main
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int main(int argc,char** argv)
+ *
+ * @param      argc number of command line arguments
+ * @param      argv array of c strings of command line arguments
+ *
+ * @return     status code.
+ */
+int main(int argc,char** argv)
+{
+    // parse command line options
+    static option longOptions[] =
+    {
+        {"workers",required_argument,0,'w'},
+        {"acquisitions",required_argument,0,'n'},
+        {"work",required_argument,0,'k'},
+        {"processes",no_argument,0,'p'},
+        {"no-header",no_argument,0,'H'},
+        {0,0,0,0}
+    };
+    const char* workerList = DEFAULT_WORKERS;
+    long acquisitions = DEFAULT_ACQUISITIONS;
+    long work = DEFAULT_WORK;
+    bool processes = false;
+    bool header = true;
+    int opt;
+    while((opt = getopt_long(argc,argv,"",longOptions,0)) != -1)
+    {
+        switch(opt)
+        {
+        case 'w':
+            workerList = optarg;
+            break;
+        case 'n':
+            acquisitions = atol(optarg);
+            break;
+        case 'k':
+            work = atol(optarg);
+            break;
+        case 'p':
+            processes = true;
+            break;
+        case 'H':
+            header = false;
+            break;
+        default:
+            fprintf(stderr,USAGE,argv[0]);
+            return 1;
+        }
+    }
+
+    // parse the worker counts
+    std::vector<unsigned int> workerCounts;
+    for(const char* count = workerList; *count != '\0';)
+    {
+        char* end;
+        long numWorkers = strtol(count,&end,10);
+        if (end == count || numWorkers <= 0 || (*end != ',' && *end != '\0'))
+        {
+            workerCounts.clear();
+            break;
+        }
+        workerCounts.push_back(numWorkers);
+        count = *end == ',' ? end+1 : end;
+    }
+    if (argc-optind != 0 || workerCounts.empty() || acquisitions <= 0 || work < 0)
+    {
+        fprintf(stderr,USAGE,argv[0]);
+        return 1;
+    }
+
+    Shared* shared = (Shared*) mmap(0,sizeof(Shared),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    if (shared == MAP_FAILED || sem_init(&shared->lock,processes ? 1 : 0,1) < 0 ||
+        sem_init(&shared->ready,processes ? 1 : 0,0) < 0 ||
+        sem_init(&shared->go,processes ? 1 : 0,0) < 0)
+    {
+        perror("failed to make the lock");
+        return 1;
+    }
+
+    if (header)
+    {
+        printf("implementation,backend,workers,acquisitions,seconds,ns_per_acquisition\n");
+    }
+    const char* implementations[] = {"posix","spin"};
+    for(register unsigned int i = 0; i < workerCounts.size(); ++i)
+    {
+        for(register unsigned int j = 0; j < sizeof(implementations)/sizeof(*implementations); ++j)
+        {
+            spin_enable(j == 1);
+            shared->counter = 0;
+            shared->acquisitions = acquisitions/workerCounts[i];
+            shared->work = work;
+            double seconds = run_line(shared,workerCounts[i],processes);
+            unsigned long total = shared->acquisitions*workerCounts[i];
+            if (seconds < 0)
+            {
+                perror("failed to start workers");
+                return 1;
+            }
+            if (shared->counter != total)
+            {
+                fprintf(stderr,"%s counted %lu acquisitions instead of %lu\n",
+                    implementations[j],shared->counter,total);
+                return 1;
+            }
+            printf("%s,%s,%u,%lu,%.6f,%.1f\n",implementations[j],processes ? "processes" : "threads",
+                workerCounts[i],total,seconds,seconds*1e9/total);
+            fflush(stdout);
+        }
+    }
+
+    sem_destroy(&shared->lock);
+    sem_destroy(&shared->ready);
+    sem_destroy(&shared->go);
+    munmap(shared,sizeof(Shared));
+    return 0;
+}
+
+/**
+ * runs the workers of a line, and waits for them to finish.
+ *
+ * @function   run_line
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       worker processes are forked, so they spin, or not like the
+ *   parent does.
+ *
+ * the workers wait at a start barrier once they are running; the time starts
+ *   once all of them have reached it, so creating the workers is not timed.
+ *   if a worker cannot be started, the ones that were are released, and
+ *   waited for.
+ *
+ * @signature  double run_line(Shared* shared,unsigned int numWorkers,
+ *   bool processes)
+ *
+ * @param      shared what the workers share.
+ * @param      numWorkers number of workers to run.
+ * @param      processes true to run the workers as processes; false for
+ *   threads.
+ *
+ * @return     seconds it took, or -1 if the workers could not be started.
+ */
+double run_line(Shared* shared,unsigned int numWorkers,bool processes)
+{
+    timespec start;
+    timespec end;
+    unsigned int started = 0;
+    int error = 0;
+    std::vector<pthread_t> threads(numWorkers);
+
+    // start the workers; they wait at the barrier until all are running
+    for(; started < numWorkers; ++started)
+    {
+        if (processes)
+        {
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                error = errno;
+                break;
+            }
+            if (pid == 0)
+            {
+                worker_routine(shared);
+                _exit(0);
+            }
+        }
+        else if ((error = pthread_create(&threads[started],0,worker_routine,shared)) != 0)
+        {
+            break;
+        }
+    }
+    for(register unsigned int i = 0; i < started; ++i)
+    {
+        sem_wait(&shared->ready);
+    }
+
+    // release the workers, and wait for them to finish
+    clock_gettime(CLOCK_MONOTONIC,&start);
+    for(register unsigned int i = 0; i < started; ++i)
+    {
+        sem_post(&shared->go);
+    }
+    if (processes)
+    {
+        while(wait(0) > 0);
+    }
+    else
+    {
+        for(register unsigned int i = 0; i < started; ++i)
+        {
+            pthread_join(threads[i],0);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC,&end);
+
+    if (started < numWorkers)
+    {
+        errno = error;
+        return -1;
+    }
+    return (end.tv_sec-start.tv_sec)+(end.tv_nsec-start.tv_nsec)/1e9;
+}
+
+/**
+ * routine executed by the workers; takes the lock over, and over.
+ *
+ * @function   worker_routine
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       waits at the start barrier of run_line first.
+ *
+ * @signature  void* worker_routine(void* shared)
+ *
+ * @param      shared pointer to what the workers share.
+ */
+void* worker_routine(void* shared)
+{
+    Shared* self = (Shared*) shared;
+    volatile unsigned long sink = 0;
+
+    // wait at the start barrier
+    sem_post(&self->ready);
+    sem_wait(&self->go);
+
+    for(register unsigned long i = 0; i < self->acquisitions; ++i)
+    {
+        {
+            Lock scopelock(&self->lock);
+            unsigned long counter = self->counter+1;
+            self->ring[counter%RING_SIZE] = i;
+            self->counter = counter;
+        }
+        for(register unsigned long j = 0; j < self->work; ++j)
+        {
+            sink = sink+j;
+        }
+    }
+    return 0;
+}
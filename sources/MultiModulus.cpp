@@ -0,0 +1,182 @@
+/**
+ * implementation of finding the remainders of a number divided by several
+ *   limbs at once declared in MultiModulus.h
+ *
+ * @sourceFile MultiModulus.cpp
+ *
+ * @program    Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the remainders of a batch are kept in an array on the stack
+ *   while the limbs are read, so they can stay in registers, and are only
+ *   copied to the caller's buffer at the end.
+ */
+#include "MultiModulus.h"
+
+#if GMP_LIMB_BITS == 64 && GMP_NAIL_BITS == 0 && defined(__SIZEOF_INT128__)
+#define MULTI_MODULUS_INVERSES
+__extension__ typedef unsigned __int128 DoubleLimb;
+#endif
+
+#ifdef MULTI_MODULUS_INVERSES
+static inline mp_limb_t mod_preinv(mp_limb_t hi,mp_limb_t lo,mp_limb_t normalized,mp_limb_t inverse);
+#endif
+
+/**
+ * works out what is needed to divide by a limb without dividing.
+ *
+ * @function   word_modulus_init
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       costs a single hardware division, for the inverse, which is
+ *   floor((2^128-1)/normalized)-2^64.
+ *
+ * @signature  void word_modulus_init(WordModulus* modulus,mp_limb_t divisor)
+ *
+ * @param      modulus modulus to fill in.
+ * @param      divisor divisor to make it for; must not be 0.
+ */
+void word_modulus_init(WordModulus* modulus,mp_limb_t divisor)
+{
+    modulus->divisor = divisor;
+#ifdef MULTI_MODULUS_INVERSES
+    modulus->shift = __builtin_clzll(divisor);
+    modulus->normalized = divisor << modulus->shift;
+    modulus->inverse = (mp_limb_t) ((((DoubleLimb) ~modulus->normalized) << 64 | ~(mp_limb_t) 0)/
+        modulus->normalized);
+#else
+    modulus->shift = 0;
+    modulus->normalized = divisor;
+    modulus->inverse = 0;
+#endif
+}
+
+/**
+ * finds the remainders of a number divided by each divisor of a batch.
+ *
+ * @function   multi_modulus_residues
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       see MultiModulus.h for how it works. a number of no limbs is 0,
+ *   and leaves every remainder 0.
+ *
+ * @signature  void multi_modulus_residues(mp_srcptr limbs,mp_size_t size,
+ *   const WordModulus* moduli,unsigned int count,mp_limb_t* residues)
+ *
+ * @param      limbs limbs of the number, least significant first, like
+ *   mpz_limbs_read returns them.
+ * @param      size number of limbs of the number.
+ * @param      moduli divisors to divide by.
+ * @param      count number of divisors; at most MULTI_MODULUS_BATCH.
+ * @param      residues buffer of count limbs that the remainders are written
+ *   to, in the order of the divisors.
+ */
+void multi_modulus_residues(mp_srcptr limbs,mp_size_t size,const WordModulus* moduli,
+    unsigned int count,mp_limb_t* residues)
+{
+    mp_limb_t remainders[MULTI_MODULUS_BATCH];
+#ifdef MULTI_MODULUS_INVERSES
+    for(register unsigned int k = 0; k < count; ++k)
+    {
+        remainders[k] = 0;
+    }
+
+    // find the remainders for the shifted divisors, a limb at a time
+    for(register mp_size_t i = size-1; i >= 0; --i)
+    {
+        mp_limb_t limb = limbs[i];
+        for(register unsigned int k = 0; k < count; ++k)
+        {
+            remainders[k] = mod_preinv(remainders[k],limb,moduli[k].normalized,moduli[k].inverse);
+        }
+    }
+
+    // reduce them by the divisors, which divide the shifted divisors
+    for(register unsigned int k = 0; k < count; ++k)
+    {
+        unsigned int shift = moduli[k].shift;
+        if (shift != 0)
+        {
+            remainders[k] = mod_preinv(remainders[k] >> (64-shift),remainders[k] << shift,
+                moduli[k].normalized,moduli[k].inverse) >> shift;
+        }
+    }
+#else
+    for(register unsigned int k = 0; k < count; ++k)
+    {
+        remainders[k] = size == 0 ? 0 : mpn_mod_1(limbs,size,moduli[k].divisor);
+    }
+#endif
+
+    for(register unsigned int k = 0; k < count; ++k)
+    {
+        residues[k] = remainders[k];
+    }
+}
+
+#ifdef MULTI_MODULUS_INVERSES
+/**
+ * divides a two limb number by a normalized limb using its inverse.
+ *
+ * @function   mod_preinv
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       estimates the quotient as the high limb of the number times the
+ *   inverse, plus the number, and corrects the remainder it leaves at most
+ *   twice. hi must be smaller than the divisor.
+ *
+ * @signature  mp_limb_t mod_preinv(mp_limb_t hi,mp_limb_t lo,
+ *   mp_limb_t normalized,mp_limb_t inverse)
+ *
+ * @param      hi most significant limb of the number.
+ * @param      lo least significant limb of the number.
+ * @param      normalized divisor, with its top bit set.
+ * @param      inverse inverse of the divisor from word_modulus_init.
+ *
+ * @return     the remainder.
+ */
+mp_limb_t mod_preinv(mp_limb_t hi,mp_limb_t lo,mp_limb_t normalized,mp_limb_t inverse)
+{
+    DoubleLimb estimate = (DoubleLimb) inverse*hi+((DoubleLimb) hi << 64 | lo);
+    mp_limb_t quotient = (mp_limb_t) (estimate >> 64)+1;
+    mp_limb_t remainder = lo-quotient*normalized;
+
+    // the first correction is needed about half the time, so it is made with
+    // a mask rather than a branch that would be mispredicted; the second one
+    // is rare
+    remainder += -(mp_limb_t) (remainder > (mp_limb_t) estimate) & normalized;
+    if (__builtin_expect(remainder >= normalized,0))
+    {
+        remainder -= normalized;
+    }
+    return remainder;
+}
+#endif
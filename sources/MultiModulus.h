@@ -0,0 +1,62 @@
+/**
+ * header file for finding the remainders of a number divided by several limbs
+ *   at once. implementation is in MultiModulus.cpp
+ *
+ * @sourceFile MultiModulus.h
+ *
+ * @program    Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * dividing a number of many limbs by a limb takes one division of two limbs
+ *   by one for every limb of the number. a hardware division is slow, so each
+ *   divisor is turned into a WordModulus first: the divisor shifted up until
+ *   its top bit is set, and an inverse of that, with which a division of two
+ *   limbs takes two multiplications, and a couple of corrections instead
+ *   (Moller, and Granlund, "improved division by invariant integers"). that
+ *   pays off once the inverse is used for enough limbs.
+ *
+ * multi_modulus_residues finds the remainders of a number for a batch of up
+ *   to MULTI_MODULUS_BATCH divisors in one pass over its limbs, most
+ *   significant first. every limb is read once for the whole batch rather than
+ *   once per divisor, and the divisions for the divisors of the batch do not
+ *   depend on each other, so the cpu can overlap them.
+ *
+ * the remainder is first found for the shifted divisor, which the divisor
+ *   divides, and then reduced by the divisor with one more step, so the limbs
+ *   of the number never have to be shifted.
+ *
+ * the inverses need 64 bit limbs, and a compiler with 128 bit integers; other
+ *   targets divide with mpn_mod_1 instead.
+ */
+#ifndef MULTIMODULUS_H
+#define MULTIMODULUS_H
+
+#include <gmp.h>
+
+#define MULTI_MODULUS_BATCH 16
+
+/**
+ * a divisor, with what is needed to divide by it without dividing.
+ */
+struct WordModulus
+{
+    mp_limb_t divisor;
+    mp_limb_t normalized;
+    mp_limb_t inverse;
+    unsigned int shift;
+};
+
+void word_modulus_init(WordModulus* modulus,mp_limb_t divisor);
+void multi_modulus_residues(mp_srcptr limbs,mp_size_t size,const WordModulus* moduli,
+    unsigned int count,mp_limb_t* residues);
+
+#endif
@@ -76,3 +76,97 @@ Number::~Number()
 {
     mpz_clear(value);
 }
+
+/**
+ * parses a number in the format written by mpz_out_raw from a buffer.
+ *
+ * @function   parse_raw
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the format is a 4 byte big endian size in bytes, negative for negative
+ *   numbers, followed by the magnitude of the number in big endian order.
+ *
+ * @signature  bool parse_raw(std::string& buffer,size_t* offset,mpz_t number)
+ *
+ * @param      buffer buffer to parse the number from.
+ * @param      offset offset into the buffer to parse the number from. it is
+ *   advanced past the number if it is parsed.
+ * @param      number set to the parsed number.
+ *
+ * @return     true if a complete number was parsed; false if the buffer does
+ *   not hold all of it yet.
+ */
+bool parse_raw(std::string& buffer,size_t* offset,mpz_t number)
+{
+    if (buffer.size() < *offset+4)
+    {
+        return false;
+    }
+
+    const unsigned char* data = (const unsigned char*) buffer.data()+*offset;
+    int size = (int) ((unsigned int) data[0] << 24 |
+        (unsigned int) data[1] << 16 |
+        (unsigned int) data[2] << 8 |
+        (unsigned int) data[3]);
+    size_t magnitude = size < 0 ? -size : size;
+    if (buffer.size() < *offset+4+magnitude)
+    {
+        return false;
+    }
+
+    mpz_import(number,magnitude,1,1,1,0,data+4);
+    if (size < 0)
+    {
+        mpz_neg(number,number);
+    }
+    *offset += 4+magnitude;
+    return true;
+}
+
+/**
+ * appends a number to a buffer in the format written by mpz_out_raw.
+ *
+ * @function   append_raw
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       see parse_raw for the format.
+ *
+ * @signature  void append_raw(std::string& buffer,mpz_t number)
+ *
+ * @param      buffer buffer to append the number to.
+ * @param      number the number to append.
+ */
+void append_raw(std::string& buffer,mpz_t number)
+{
+    size_t magnitude = (mpz_sizeinbase(number,2)+7)/8;
+    if (mpz_sgn(number) == 0)
+    {
+        magnitude = 0;
+    }
+    int size = mpz_sgn(number) < 0 ? -(int) magnitude : (int) magnitude;
+
+    size_t start = buffer.size();
+    buffer.resize(start+4+magnitude);
+    unsigned char* data = (unsigned char*) &buffer[start];
+    data[0] = (unsigned int) size >> 24;
+    data[1] = (unsigned int) size >> 16;
+    data[2] = (unsigned int) size >> 8;
+    data[3] = (unsigned int) size;
+    mpz_export(data+4,0,1,1,1,0,number);
+}
@@ -18,11 +18,15 @@
  * used to wrap an integer of the gmp library so that they will be properly
  *   initialized and deallocated when an instance of this class is constructed
  *   or destroyed.
+ *
+ * also declares functions to convert integers to and from the format written
+ *   by mpz_out_raw in memory, for code that cannot use a FILE stream.
  */
 #ifndef NUMBER_H
 #define NUMBER_H
 
 #include <gmp.h>
+#include <string>
 
 class Number
 {
@@ -32,4 +36,7 @@ public:
     mpz_t value;
 };
 
+bool parse_raw(std::string& buffer,size_t* offset,mpz_t number);
+void append_raw(std::string& buffer,mpz_t number);
+
 #endif
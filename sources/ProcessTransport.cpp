@@ -0,0 +1,1587 @@
+/**
+ * implementation of the ProcessTransport class declared in ProcessTransport.h
+ *
+ * @sourceFile ProcessTransport.cpp
+ *
+ * @program    Factors-Main.out, Processes-Main.out
+ *
+ * @class      ProcessTransport
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the parent writes a TaskRecord for each chunk into the task pipe. records are
+ *   far smaller than PIPE_BUF, so each is written, and read whole; children
+ *   take turns reading them out of it under tasksLock, one read at a time, and
+ *   write the results of each chunk into the feedback pipe as a batch under
+ *   feedbackLock; the chunk index, the worker's slot, the number of results,
+ *   then the results, all written with mpz_out_raw.
+ *
+ * the parent keeps the set of chunks it issued whose results have not arrived
+ *   yet, and is done once it is empty. the chunk of a child that dies is
+ *   issued again if it is still in the set, and results of chunks that are no
+ *   longer in it are dropped, so a chunk is never lost, or counted twice.
+ *
+ * without io_uring, the parent reads the feedback pipe when a child signals it
+ *   with SIGUSR1. with io_uring, it keeps a read outstanding on it instead.
+ *   either way, whatever is read is appended to an inbox, and only complete
+ *   batches are parsed out of it, so the parent never waits on a child that is
+ *   still writing its batch.
+ */
+#include "ProcessTransport.h"
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/types.h>
+#include <semaphore.h>
+#include "Lock.h"
+#include "Contention.h"
+#include "Footprint.h"
+#include "GmpArena.h"
+#include "FindFactorsTask.h"
+
+#define URING_ENTRIES 16
+#define URING_FEEDBACK_SIZE 65536
+#define URING_TIMEOUT_MS 10
+#define URING_READ URING_TASK_SLOTS
+#define NO_CHUNK ULONG_MAX
+
+/**
+ * record of a task in the task pipe.
+ */
+struct TaskRecord
+{
+    unsigned long chunk;
+};
+
+/**
+ * lease held by a worker process on a chunk of the search range. a child reads
+ *   each task record from the task pipe straight into its lease, so the chunk
+ *   is leased the moment it leaves the pipe, and sets the chunk back to
+ *   NO_CHUNK once the task's results have been written into the feedback pipe;
+ *   the parent knows which chunk to re-issue if the child dies in between.
+ *
+ * slotFreed is set once the child has posted tasksNotFullSem for the record it
+ *   read, so the parent can post it instead if the child dies before that.
+ */
+struct Lease
+{
+    pid_t pid;
+    TaskRecord task;
+    bool slotFreed;
+};
+
+static int worker_process(unsigned int slot);
+static void read_feedback_pipe(int sigNum);
+static void parse_batches(std::string* inbox,std::set<unsigned long>* outstanding);
+static void on_child_terminated(int sigNum);
+static pid_t spawn_worker(unsigned int slot);
+static void reap_workers(int waitOptions);
+static bool wait_for_sem(sem_t* sem,bool retry);
+static bool write_task(unsigned long chunk);
+static bool write_requeued_chunks();
+static bool is_outstanding(unsigned long chunk);
+static void mask_feedback_signal(bool masked);
+
+/**
+ * options of the run.
+ */
+static EngineOptions* options = 0;
+
+/**
+ * collector that the results read from the feedback pipe are passed to.
+ */
+static ResultCollector* collector = 0;
+
+/**
+ * counters of the workers, and the parent. the children count into them
+ *   through the shared memory they were mapped into.
+ */
+static WorkerMetrics* workerMetrics = 0;
+
+/**
+ * spans of the workers, and the parent, shared like the counters.
+ */
+static Timeline* workerTimeline = 0;
+
+/**
+ * pipe. contains tasks from parent, consumed by children.
+ */
+static int tasks[2] = {-1,-1};
+
+/**
+ * pipe. contains calculation results from children, read by parent.
+ */
+static int feedback[2] = {-1,-1};
+
+/**
+ * pointer to a sem_t sized shared memory where a semaphore will be allocated
+ *   onto. used by children to ensure mutual access when reading from the task
+ *   pipe.
+ */
+static sem_t* tasksLock = (sem_t*) MAP_FAILED;
+
+/**
+ * pointer to a sem_t sized shared memory where a semaphore will be allocated
+ *   onto. used by processes to ensure that there can only be
+ *   MAX_PENDING_TASKS_PER_WORKER serialized tasks per worker in the task pipe
+ *   at a time.
+ */
+static sem_t* tasksNotFullSem = (sem_t*) MAP_FAILED;
+
+/**
+ * pointer to a sem_t sized shared memory where a semaphore will be allocated
+ *   onto. used by children to ensure mutual access when writing into the
+ *   feedback pipe.
+ */
+static sem_t* feedbackLock = (sem_t*) MAP_FAILED;
+
+/**
+ * pointer to a sem_t sized shared memory where a semaphore will be allocated
+ *   onto. posted by children once for every chunk whose results have been
+ *   written into the feedback pipe, so the parent knows when every chunk it
+ *   issued has been completed.
+ */
+static sem_t* chunksDoneSem = (sem_t*) MAP_FAILED;
+
+/**
+ * pointer to shared memory holding the pid of the process that currently holds
+ *   tasksLock, or 0 if it is not held. used by the parent to release the lock
+ *   if its holder dies while holding it.
+ */
+static pid_t* tasksLockHolder = (pid_t*) MAP_FAILED;
+
+/**
+ * pointer to shared memory holding the pid of the child that currently holds
+ *   feedbackLock, or 0 if it is not held by a child.
+ */
+static pid_t* feedbackLockHolder = (pid_t*) MAP_FAILED;
+
+/**
+ * pointer to shared memory holding the cancellation flag. once it is set to
+ *   non-zero, the children stop working on their tasks.
+ */
+static volatile int* cancelFlag = (volatile int*) MAP_FAILED;
+
+/**
+ * shared memory array of numWorkers leases, indexed by worker slot.
+ */
+static Lease* leases = (Lease*) MAP_FAILED;
+
+/**
+ * number of worker processes that are still alive.
+ */
+static unsigned int liveWorkers = 0;
+
+/**
+ * chunks that were issued, and whose results have not been read yet. it is
+ *   also changed by the SIGUSR1 handler, so SIGUSR1 is masked while the parent
+ *   uses it.
+ */
+static std::set<unsigned long>* outstandingChunks = 0;
+
+/**
+ * chunks that were leased by children that terminated abnormally, and need to
+ *   be written into the task pipe again.
+ */
+static std::vector<unsigned long> requeuedChunks;
+
+/**
+ * buffers registered with io_uring. the task buffer is split into
+ *   URING_TASK_SLOTS slots of PIPE_BUF bytes, so every write into the task pipe
+ *   is atomic.
+ */
+static char uringTaskBuffer[URING_TASK_SLOTS][PIPE_BUF];
+static char uringFeedbackBuffer[URING_FEEDBACK_SIZE];
+
+/**
+ * bytes read from the feedback pipe by the SIGUSR1 handler that are not yet
+ *   parsed into batches.
+ */
+static std::string feedbackInbox;
+
+/**
+ * true while results are read by the SIGUSR1 handler, and not the ring.
+ */
+static bool readBySignal = false;
+
+/**
+ * true once a child died holding feedbackLock while results are read by the
+ *   ring, until the part of a batch it left behind is dropped, and the lock is
+ *   released by pump_ring.
+ */
+static bool feedbackLockOrphaned = false;
+
+/**
+ * instantiates a ProcessTransport instance.
+ *
+ * @class      ProcessTransport
+ *
+ * @method     ProcessTransport
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       no processes are spawned until start is called.
+ *
+ * @signature  ProcessTransport::ProcessTransport(EngineOptions* _options,
+ *   ResultCollector* _collector)
+ *
+ * @param      _options options of the run.
+ * @param      _collector collector that the results are passed to.
+ *
+ * @return     an instance of a ProcessTransport.
+ */
+ProcessTransport::ProcessTransport(EngineOptions* _options,ResultCollector* _collector)
+    :metrics(_options->numWorkers)
+    ,timeline(_options->numWorkers,_options->tracePath != 0)
+    ,ring(0)
+    ,reading(false)
+{
+    options = _options;
+    collector = _collector;
+    workerMetrics = &metrics;
+    workerTimeline = &timeline;
+    outstandingChunks = &outstanding;
+    memset(slotLength,0,sizeof(slotLength));
+}
+
+/**
+ * destructor for the ProcessTransport. releases the pipes, and the shared
+ *   memory.
+ *
+ * @class      ProcessTransport
+ *
+ * @method     ~ProcessTransport
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       closing the task pipe makes any children that are still alive
+ *   run out of tasks, and terminate.
+ *
+ * @signature  ProcessTransport::~ProcessTransport()
+ */
+ProcessTransport::~ProcessTransport()
+{
+    footprint_unwatch();
+    signal(SIGUSR1,SIG_DFL);
+    signal(SIGCHLD,SIG_DFL);
+
+    delete ring;
+    if (tasks[1] >= 0)
+    {
+        close(tasks[1]);
+        tasks[1] = -1;
+    }
+    if (feedback[0] >= 0)
+    {
+        close(feedback[0]);
+    }
+    feedbackInbox.clear();
+    if (tasks[0] >= 0)
+    {
+        close(tasks[0]);
+    }
+    if (feedback[1] >= 0)
+    {
+        close(feedback[1]);
+    }
+
+    if (tasksLock != MAP_FAILED)
+    {
+        sem_destroy(tasksLock);
+        sem_destroy(tasksNotFullSem);
+        sem_destroy(feedbackLock);
+        sem_destroy(chunksDoneSem);
+        munmap(tasksLock,sizeof(sem_t));
+        munmap(tasksNotFullSem,sizeof(sem_t));
+        munmap(feedbackLock,sizeof(sem_t));
+        munmap(chunksDoneSem,sizeof(sem_t));
+        munmap(tasksLockHolder,sizeof(pid_t));
+        munmap(feedbackLockHolder,sizeof(pid_t));
+        munmap((void*) cancelFlag,sizeof(int));
+        munmap(leases,sizeof(Lease)*options->numWorkers);
+    }
+}
+
+/**
+ * sets up IPC, and spawns the worker processes.
+ *
+ * @class      ProcessTransport
+ *
+ * @method     start
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the read end of the task pipe, and the write end of the feedback pipe are
+ *   kept open by the parent, so replacement workers can inherit them.
+ *
+ * @signature  bool ProcessTransport::start()
+ *
+ * @return     true if the workers were spawned; false otherwise.
+ */
+bool ProcessTransport::start()
+{
+    // create all synchronization primitives, and data structures needed to
+    // pass tasks, and results
+    if (pipe(tasks) < 0 ||
+        pipe(feedback) < 0)
+    {
+        return false;
+    }
+
+    tasksLock = (sem_t*) mmap(0,sizeof(sem_t),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    tasksNotFullSem = (sem_t*) mmap(0,sizeof(sem_t),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    feedbackLock = (sem_t*) mmap(0,sizeof(sem_t),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    chunksDoneSem = (sem_t*) mmap(0,sizeof(sem_t),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    tasksLockHolder = (pid_t*) mmap(0,sizeof(pid_t),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    feedbackLockHolder = (pid_t*) mmap(0,sizeof(pid_t),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    cancelFlag = (volatile int*) mmap(0,sizeof(int),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    leases = (Lease*) mmap(0,sizeof(Lease)*options->numWorkers,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+
+    if (tasksLock == MAP_FAILED ||
+        tasksNotFullSem == MAP_FAILED ||
+        feedbackLock == MAP_FAILED ||
+        chunksDoneSem == MAP_FAILED ||
+        tasksLockHolder == MAP_FAILED ||
+        feedbackLockHolder == MAP_FAILED ||
+        cancelFlag == MAP_FAILED ||
+        leases == MAP_FAILED)
+    {
+        return false;
+    }
+
+    if (sem_init(tasksLock,1,1) < 0 ||
+        sem_init(tasksNotFullSem,1,options->numWorkers*MAX_PENDING_TASKS_PER_WORKER) < 0 ||
+        sem_init(feedbackLock,1,1) < 0 ||
+        sem_init(chunksDoneSem,1,0) < 0)
+    {
+        return false;
+    }
+    *tasksLockHolder = 0;
+    *feedbackLockHolder = 0;
+    *cancelFlag = 0;
+    contention_name(tasksLock,"tasksLock");
+    contention_name(tasksNotFullSem,"tasksNotFullSem");
+    contention_name(feedbackLock,"feedbackLock");
+    contention_name(chunksDoneSem,"chunksDoneSem");
+    footprint_watch_queue("task pipe",tasksNotFullSem,options->numWorkers*MAX_PENDING_TASKS_PER_WORKER);
+    footprint_watch_pipe("task pipe",tasks[0]);
+    footprint_watch_pipe("feedback pipe",feedback[0]);
+
+    // setup signal handlers. SIGCHLD interrupts the parent when it is blocked
+    // on a semaphore, so it can re-issue the chunk of a dead child right away
+    signal(SIGUSR1,read_feedback_pipe);
+    readBySignal = true;
+    signal(SIGCHLD,on_child_terminated);
+
+    // create the worker processes
+    for(register unsigned int i = 0; i < options->numWorkers; ++i)
+    {
+        if (spawn_worker(i) < 0)
+        {
+            return false;
+        }
+    }
+
+    // set up io_uring if it was asked for, and is available
+    if (options->uring && !open_ring())
+    {
+        perror("io_uring unavailable; using blocking pipe i/o");
+    }
+
+    return true;
+}
+
+/**
+ * writes a task into the task pipe once there is room for it. the chunks of
+ *   dead children are re-issued first.
+ *
+ * @class      ProcessTransport
+ *
+ * @method     post
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       with io_uring, the task is queued, and the queue is only pumped
+ *   into the ring once it holds more than URING_TASK_SLOTS tasks.
+ *
+ * @signature  bool ProcessTransport::post(unsigned long chunk)
+ *
+ * @param      chunk index of the chunk to find the factors in.
+ *
+ * @return     true if the task was posted; false otherwise.
+ */
+bool ProcessTransport::post(unsigned long chunk)
+{
+    unsigned long long postStart = WorkerMetrics::now();
+    if (ring != 0)
+    {
+        outstanding.insert(chunk);
+        pendingChunks.push_back(chunk);
+        while(pendingChunks.size() > URING_TASK_SLOTS)
+        {
+            if (!pump_ring())
+            {
+                return false;
+            }
+        }
+        timeline.record(timeline.get_producer(),SPAN_DISPATCH,postStart,WorkerMetrics::now(),chunk);
+        return true;
+    }
+
+    if (!write_requeued_chunks())
+    {
+        return false;
+    }
+
+    // write the chunk into the task pipe. it is expected before it is written,
+    // as its results may arrive right after
+    unsigned long long waitStart = WorkerMetrics::now();
+    if (!wait_for_sem(tasksNotFullSem,true))
+    {
+        return false;
+    }
+    metrics.add(metrics.get_producer(),METRIC_NOT_FULL_WAIT_NS,WorkerMetrics::now()-waitStart);
+    mask_feedback_signal(true);
+    outstanding.insert(chunk);
+    mask_feedback_signal(false);
+    if (!write_task(chunk))
+    {
+        return false;
+    }
+    timeline.record(timeline.get_producer(),SPAN_DISPATCH,postStart,WorkerMetrics::now(),chunk);
+    return true;
+}
+
+/**
+ * waits for every chunk to be completed, re-issuing the chunks of children
+ *   that die in the mean time, then closes the task pipe, and waits for the
+ *   children to terminate.
+ *
+ * @class      ProcessTransport
+ *
+ * @method     finish
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       once the cancellation flag is set, it stops waiting for chunks,
+ *   and the children skip the tasks left in the pipe before they terminate.
+ *
+ * @signature  bool ProcessTransport::finish()
+ *
+ * @return     true if every chunk was completed; false otherwise.
+ */
+bool ProcessTransport::finish()
+{
+    if (ring != 0)
+    {
+        while(!outstanding.empty() && *cancelFlag == 0)
+        {
+            if (!pump_ring())
+            {
+                return false;
+            }
+        }
+    }
+    else
+    {
+        mask_feedback_signal(true);
+        bool done = outstanding.empty();
+        mask_feedback_signal(false);
+        while(!done && *cancelFlag == 0)
+        {
+            if (!wait_for_sem(chunksDoneSem,false) && errno != EINTR && errno != ETIMEDOUT)
+            {
+                return false;
+            }
+            read_feedback_pipe(SIGUSR1);
+
+            if (!write_requeued_chunks())
+            {
+                return false;
+            }
+            mask_feedback_signal(true);
+            done = outstanding.empty();
+            mask_feedback_signal(false);
+        }
+    }
+    close(tasks[1]);
+    tasks[1] = -1;
+
+    // join all child processes
+    while(liveWorkers > 0)
+    {
+        reap_workers(0);
+    }
+
+    // read in any remaining results
+    if (ring == 0)
+    {
+        read_feedback_pipe(SIGUSR1);
+    }
+    return true;
+}
+
+/**
+ * returns the flag that cancels the tasks of the children once it is set.
+ *
+ * @class      ProcessTransport
+ *
+ * @method     get_cancel_flag
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the flag is in shared memory, and may be set from any thread, or
+ *   signal handler of the parent. only valid after start.
+ *
+ * @signature  volatile int* ProcessTransport::get_cancel_flag()
+ *
+ * @return     pointer to the cancellation flag.
+ */
+volatile int* ProcessTransport::get_cancel_flag()
+{
+    return cancelFlag;
+}
+
+/**
+ * returns the counters of the workers.
+ *
+ * @class      ProcessTransport
+ *
+ * @method     get_metrics
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the counters are in shared memory, and may be read while the
+ *   children are running.
+ *
+ * @signature  WorkerMetrics* ProcessTransport::get_metrics()
+ *
+ * @return     pointer to the metrics of the workers.
+ */
+WorkerMetrics* ProcessTransport::get_metrics()
+{
+    return &metrics;
+}
+
+/**
+ * returns the spans recorded by the workers, and the producer.
+ *
+ * @class      ProcessTransport
+ *
+ * @method     get_timeline
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       spans are only recorded with --trace, and must not be written
+ *   until finish returns.
+ *
+ * @signature  Timeline* ProcessTransport::get_timeline()
+ *
+ * @return     pointer to the timeline of the workers.
+ */
+Timeline* ProcessTransport::get_timeline()
+{
+    return &timeline;
+}
+
+/**
+ * sets up io_uring, and registers the task, and feedback buffers with it.
+ *
+ * @class      ProcessTransport
+ *
+ * @method     open_ring
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       once the ring is open, results are read by the ring, and not the
+ *   SIGUSR1 handler.
+ *
+ * @signature  bool ProcessTransport::open_ring()
+ *
+ * @return     true if the ring can be used; false otherwise.
+ */
+bool ProcessTransport::open_ring()
+{
+    iovec buffers[2];
+    buffers[0].iov_base = uringTaskBuffer;
+    buffers[0].iov_len = sizeof(uringTaskBuffer);
+    buffers[1].iov_base = uringFeedbackBuffer;
+    buffers[1].iov_len = sizeof(uringFeedbackBuffer);
+
+    ring = new IoRing(URING_ENTRIES);
+    if (!ring->is_open() || !ring->register_buffers(buffers,2))
+    {
+        delete ring;
+        ring = 0;
+        return false;
+    }
+
+    signal(SIGUSR1,SIG_IGN);
+    readBySignal = false;
+    return true;
+}
+
+/**
+ * writes queued tasks into the task pipe, and reads results from the feedback
+ *   pipe through io_uring; waits for at least one of them to complete.
+ *
+ * @class      ProcessTransport
+ *
+ * @method     pump_ring
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * tasks are packed into the slots of the registered task buffer, and written
+ *   into the task pipe with one IORING_OP_WRITE_FIXED per slot. a slot never
+ *   holds more than PIPE_BUF bytes, so each write is atomic, and tasks are never
+ *   split between children. the writes of one submission are linked, so they
+ *   reach the pipe in order.
+ *
+ * one IORING_OP_READ_FIXED is kept outstanding on the feedback pipe; whatever
+ *   it reads is appended to the inbox, and complete batches are parsed out of
+ *   it.
+ *
+ * the wait times out, so children are reaped, and tasks are written once there
+ *   is room in the task pipe.
+ *
+ * if a child dies holding feedbackLock, the lock is only released once the
+ *   feedback pipe is empty, and the part of a batch it wrote is dropped from
+ *   the inbox, so the batches after it are not parsed out of step.
+ *
+ * @signature  bool ProcessTransport::pump_ring()
+ *
+ * @return     true on success; false with errno set otherwise.
+ */
+bool ProcessTransport::pump_ring()
+{
+    reap_workers(WNOHANG);
+    if (liveWorkers == 0)
+    {
+        errno = ECHILD;
+        return false;
+    }
+
+    // pack tasks into the free slots, as long as there is room for them in the
+    // task pipe
+    io_uring_sqe* prevWrite = 0;
+    for(register unsigned int slot = 0; slot < URING_TASK_SLOTS; ++slot)
+    {
+        if (slotLength[slot] != 0)
+        {
+            continue;
+        }
+
+        std::string data;
+        while(true)
+        {
+            if (nextTask.empty())
+            {
+                // skip re-issued chunks whose results already arrived
+                while(!requeuedChunks.empty() &&
+                    outstanding.count(requeuedChunks.back()) == 0)
+                {
+                    requeuedChunks.pop_back();
+                }
+                if ((requeuedChunks.empty() && pendingChunks.empty()) ||
+                    sem_trywait(tasksNotFullSem) < 0)
+                {
+                    break;
+                }
+
+                // re-issue the chunks of dead children before new ones
+                TaskRecord record;
+                if (!requeuedChunks.empty())
+                {
+                    record.chunk = requeuedChunks.back();
+                    requeuedChunks.pop_back();
+                }
+                else
+                {
+                    record.chunk = pendingChunks.front();
+                    pendingChunks.pop_front();
+                }
+                nextTask.assign((const char*) &record,sizeof(record));
+            }
+            if (data.size()+nextTask.size() > PIPE_BUF)
+            {
+                break;
+            }
+            data += nextTask;
+            nextTask.clear();
+        }
+        if (data.empty())
+        {
+            break;
+        }
+
+        memcpy(uringTaskBuffer[slot],data.data(),data.size());
+        io_uring_sqe* sqe = ring->get_sqe();
+        sqe->opcode = IORING_OP_WRITE_FIXED;
+        sqe->fd = tasks[1];
+        sqe->addr = (unsigned long) uringTaskBuffer[slot];
+        sqe->len = data.size();
+        sqe->buf_index = 0;
+        sqe->user_data = slot;
+        if (prevWrite != 0)
+        {
+            prevWrite->flags |= IOSQE_IO_LINK;
+        }
+        prevWrite = sqe;
+        slotLength[slot] = data.size();
+    }
+
+    // keep a read on the feedback pipe outstanding
+    if (!reading)
+    {
+        io_uring_sqe* sqe = ring->get_sqe();
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->fd = feedback[0];
+        sqe->addr = (unsigned long) uringFeedbackBuffer;
+        sqe->len = URING_FEEDBACK_SIZE;
+        sqe->buf_index = 1;
+        sqe->user_data = URING_READ;
+        reading = true;
+    }
+
+    // submit the new requests, and wait for at least one completion
+    if (ring->submit(1,URING_TIMEOUT_MS) < 0 && errno != EINTR && errno != ETIME)
+    {
+        return false;
+    }
+
+    if (!read_completions())
+    {
+        return false;
+    }
+
+    // a child died part way through writing a batch. nobody else writes while
+    // it holds feedbackLock, so once the pipe is empty, all it wrote is in the
+    // inbox, or in a completion; the part of its batch there is dropped like
+    // it is without the ring, and the lock is released
+    int unread;
+    if (feedbackLockOrphaned && ioctl(feedback[0],FIONREAD,&unread) == 0 && unread == 0)
+    {
+        if (!read_completions())
+        {
+            return false;
+        }
+        inbox.clear();
+        feedbackLockOrphaned = false;
+        *feedbackLockHolder = 0;
+        sem_post(feedbackLock);
+    }
+    return true;
+}
+
+/**
+ * handles the completions of io_uring requests; frees the slots of finished
+ *   writes, and passes the results of every complete batch that was read to
+ *   the collector.
+ *
+ * @class      ProcessTransport
+ *
+ * @method     read_completions
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       does not wait for requests to complete.
+ *
+ * @signature  bool ProcessTransport::read_completions()
+ *
+ * @return     true on success; false with errno set otherwise.
+ */
+bool ProcessTransport::read_completions()
+{
+    io_uring_cqe cqe;
+    while(ring->next_completion(&cqe))
+    {
+        if (cqe.user_data < URING_TASK_SLOTS)
+        {
+            if (cqe.res != (int) slotLength[cqe.user_data])
+            {
+                errno = cqe.res < 0 ? -cqe.res : EIO;
+                return false;
+            }
+            slotLength[cqe.user_data] = 0;
+        }
+        else
+        {
+            reading = false;
+            if (cqe.res <= 0)
+            {
+                errno = cqe.res < 0 ? -cqe.res : EPIPE;
+                return false;
+            }
+            inbox.append(uringFeedbackBuffer,cqe.res);
+            parse_batches(&inbox,&outstanding);
+        }
+    }
+    return true;
+}
+
+/**
+ * parses all the complete batches out of an inbox, and passes their results
+ *   to the collector.
+ *
+ * @function   parse_batches
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       parsed batches are removed from the inbox; an incomplete batch at
+ *   its end is left there. if outstanding is given, batches of chunks that are
+ *   not in it are duplicates from children that died before releasing their
+ *   lease, and are dropped.
+ *
+ * @signature  void parse_batches(std::string* inbox,
+ *   std::set<unsigned long>* outstanding)
+ *
+ * @param      inbox bytes read from the feedback pipe.
+ * @param      outstanding chunks whose results are still expected, or 0 to
+ *   accept the results of every chunk.
+ */
+void parse_batches(std::string* inbox,std::set<unsigned long>* outstanding)
+{
+    size_t offset = 0;
+    while(true)
+    {
+        Number chunk;
+        Number slot;
+        Number count;
+        if (!parse_raw(*inbox,&offset,chunk.value) ||
+            !parse_raw(*inbox,&offset,slot.value) ||
+            !parse_raw(*inbox,&offset,count.value))
+        {
+            break;
+        }
+
+        std::vector<Number*> factors;
+        unsigned long numFactors = mpz_get_ui(count.value);
+        for(register unsigned long i = 0; i < numFactors; ++i)
+        {
+            Number* factor = new Number();
+            if (!parse_raw(*inbox,&offset,factor->value))
+            {
+                delete factor;
+                break;
+            }
+            factors.push_back(factor);
+        }
+        if (factors.size() != numFactors)
+        {
+            for(register unsigned int i = 0; i < factors.size(); ++i)
+            {
+                delete factors[i];
+            }
+            break;
+        }
+
+        // the batch is complete; remove it from the inbox
+        inbox->erase(0,offset);
+        offset = 0;
+        if (outstanding != 0 && outstanding->erase(mpz_get_ui(chunk.value)) == 0)
+        {
+            for(register unsigned int i = 0; i < factors.size(); ++i)
+            {
+                delete factors[i];
+            }
+            continue;
+        }
+        collector->chunk_done(mpz_get_ui(slot.value),mpz_get_ui(chunk.value),&factors);
+    }
+}
+
+/**
+ * SIGUSR1 handler. reads everything there is in the feedback pipe into the
+ *   inbox, and passes the results of every complete batch to the collector.
+ *   each batch holds all the results of one chunk.
+ *
+ * @function   read_feedback_pipe
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the pipe is read without taking feedbackLock, so a child that is writing a
+ *   batch larger than the pipe can hold is never left blocked on a full pipe;
+ *   the part of the batch that was read waits in the inbox for the rest of it.
+ *   the parent also calls this function periodically while waiting on its
+ *   semaphores, in case a signal is missed. SIGUSR1 is blocked while the inbox
+ *   is used, so the handler never interrupts itself.
+ *
+ * @signature  void read_feedback_pipe(int)
+ *
+ * @param      int unused
+ */
+void read_feedback_pipe(int)
+{
+    int savedErrno = errno;
+    sigset_t feedbackSignal;
+    sigset_t oldSignals;
+    sigemptyset(&feedbackSignal);
+    sigaddset(&feedbackSignal,SIGUSR1);
+    sigprocmask(SIG_BLOCK,&feedbackSignal,&oldSignals);
+
+    // read all results from feedback pipe, and pass them to the collector
+    pollfd pollParams;
+    pollParams.fd = feedback[0];
+    pollParams.events = POLLIN;
+
+    char buffer[PIPE_BUF];
+    ssize_t length;
+    while(poll(&pollParams,1,0) == 1 &&
+        (length = read(feedback[0],buffer,sizeof(buffer))) > 0)
+    {
+        feedbackInbox.append(buffer,length);
+    }
+    parse_batches(&feedbackInbox,outstandingChunks);
+
+    sigprocmask(SIG_SETMASK,&oldSignals,0);
+    errno = savedErrno;
+}
+
+/**
+ * function executed by worker processes.
+ *
+ * @function   worker_process
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * continuously reads tasks from the task pipe, executes them, and writes the
+ *   results to the feedback pipe for the parent to receive.
+ *
+ * once there are no more tasks to execute, the process terminates.
+ *
+ * the time spent blocked on the task pipe while holding tasksLock is counted
+ *   as idle. the latency of a task is from when it is read, to when its
+ *   results are written.
+ *
+ * @signature  int worker_process(unsigned int slot)
+ *
+ * @param      slot index of the worker's entry in the leases array.
+ *
+ * @return     status code.
+ */
+int worker_process(unsigned int slot)
+{
+    Lease* lease = &leases[slot];
+    Number* prime = &options->prime;
+
+    // close unused pipe descriptors
+    close(tasks[1]);
+    close(feedback[0]);
+
+    // get stream references to file descriptors. tasks are read with read, so
+    // a child never takes more out of the task pipe than the one record it
+    // holds a lease on
+    FILE* feedbackOut = fdopen(feedback[1],"w");
+
+    if (feedbackOut == 0)
+    {
+        perror("failed on fdopen");
+        return 1;
+    }
+
+    // do what worker processes do
+    while(true)
+    {
+        FindFactorsTask* taskPtr;
+        unsigned long long taskStart;
+        Number candidates;
+
+        // get the next task that needs processing
+        {
+            // read the record of the next task from the task pipe
+            {
+                unsigned long long lockStart = WorkerMetrics::now();
+                Lock scopelock(tasksLock);
+                *tasksLockHolder = getpid();
+                unsigned long long readStart = WorkerMetrics::now();
+                workerMetrics->add(slot,METRIC_TASK_WAIT_NS,readStart-lockStart);
+                workerTimeline->record(slot,SPAN_TASK_LOCK,lockStart,readStart,TIMELINE_NO_CHUNK);
+
+                // the record is read straight into the lease, so there is no
+                // moment where the chunk is out of the pipe, but not leased.
+                // waiting for the parent to write a task counts as idle
+                lease->slotFreed = false;
+                ssize_t length;
+                while((length = read(tasks[0],&lease->task,sizeof(TaskRecord))) < 0 && errno == EINTR);
+                taskStart = WorkerMetrics::now();
+                workerMetrics->add(slot,METRIC_IDLE_NS,taskStart-readStart);
+                workerTimeline->record(slot,SPAN_IDLE,readStart,taskStart,TIMELINE_NO_CHUNK);
+                if (length == sizeof(TaskRecord))
+                {
+                    sem_post(tasksNotFullSem);
+                    lease->slotFreed = true;
+                }
+
+                *tasksLockHolder = 0;
+                if (length != sizeof(TaskRecord))
+                {
+                    if (length != 0)
+                    {
+                        perror("failed to read from pipe");
+                        return 1;
+                    }
+                    break;
+                }
+            }
+
+            // calculate the bounds of the task from its chunk
+            Number loBound;
+            Number hiBound;
+            mpz_set_ui(loBound.value,lease->task.chunk);
+            mpz_mul_ui(loBound.value,loBound.value,options->chunkSize);
+            mpz_add_ui(loBound.value,loBound.value,1);
+            mpz_add_ui(hiBound.value,loBound.value,options->chunkSize-1);
+            if (mpz_cmp(hiBound.value,prime->value) > 0)
+            {
+                mpz_set(hiBound.value,prime->value);
+            }
+            mpz_sub(candidates.value,hiBound.value,loBound.value);
+            mpz_add_ui(candidates.value,candidates.value,1);
+
+            // create the task
+            taskPtr = new FindFactorsTask(prime->value,hiBound.value,loBound.value);
+        }
+
+        // do the processing. a cancelled task only gives up its lease; its
+        // results are incomplete, so they are not written
+        taskPtr->set_cancel_flag(cancelFlag);
+        unsigned long long executeStart = WorkerMetrics::now();
+        bool completed = taskPtr->execute();
+        unsigned long long executeEnd = WorkerMetrics::now();
+        workerMetrics->add(slot,METRIC_EXECUTE_NS,executeEnd-executeStart);
+        workerTimeline->record(slot,SPAN_EXECUTE,executeStart,executeEnd,lease->task.chunk);
+        if (!completed)
+        {
+            sem_post(chunksDoneSem);
+            lease->task.chunk = NO_CHUNK;
+            delete taskPtr;
+            continue;
+        }
+
+        // post results of the tasks
+        std::vector<mpz_t*>* results = taskPtr->get_results();
+        unsigned long chunk = lease->task.chunk;
+        unsigned long long publishStart;
+        {
+            unsigned long long lockStart = WorkerMetrics::now();
+            Lock scopelock(feedbackLock);
+            *feedbackLockHolder = getpid();
+            publishStart = WorkerMetrics::now();
+            workerMetrics->add(slot,METRIC_RESULT_WAIT_NS,publishStart-lockStart);
+            workerTimeline->record(slot,SPAN_RESULT_LOCK,lockStart,publishStart,chunk);
+
+            // write the results as a batch; the chunk index, the worker's
+            // slot, the number of results, then the results
+            Number batchHeader;
+            mpz_set_ui(batchHeader.value,chunk);
+            bool written = mpz_out_raw(feedbackOut,batchHeader.value) != 0;
+            mpz_set_ui(batchHeader.value,slot);
+            written = written && mpz_out_raw(feedbackOut,batchHeader.value) != 0;
+            mpz_set_ui(batchHeader.value,results->size());
+            written = written && mpz_out_raw(feedbackOut,batchHeader.value) != 0;
+            for(register unsigned int i = 0; i < results->size(); ++i)
+            {
+                written = written && mpz_out_raw(feedbackOut,*results->at(i)) != 0;
+            }
+            if (!written)
+            {
+                perror("failed to write to pipe");
+                return 1;
+            }
+            fflush(feedbackOut);
+
+            // release the lease on the chunk now that its results are posted
+            sem_post(chunksDoneSem);
+            lease->task.chunk = NO_CHUNK;
+
+            *feedbackLockHolder = 0;
+        }
+        kill(getppid(),SIGUSR1);
+        workerTimeline->record(slot,SPAN_PUBLISH,publishStart,WorkerMetrics::now(),chunk);
+
+        workerMetrics->add(slot,METRIC_TASKS,1);
+        workerMetrics->add(slot,METRIC_CANDIDATES,mpz_get_ui(candidates.value));
+        workerMetrics->add(slot,METRIC_HITS,results->size());
+        workerMetrics->add_latency(slot,WorkerMetrics::now()-taskStart);
+        delete taskPtr;
+        gmp_arena_task_done();
+    }
+
+    close(tasks[0]);
+    fclose(feedbackOut);
+
+    return 0;
+}
+
+/**
+ * SIGCHLD handler. does nothing; it is installed so that a child terminating
+ *   interrupts the parent when it is blocked waiting on a semaphore.
+ *
+ * @function   on_child_terminated
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void on_child_terminated(int)
+ *
+ * @param      int unused
+ */
+void on_child_terminated(int)
+{
+}
+
+/**
+ * forks a worker process that will occupy the passed slot of the leases array.
+ *
+ * @function   spawn_worker
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * buffered output is flushed before forking, and the child terminates with
+ *   _exit, so nothing buffered by the parent is written twice.
+ *
+ * @signature  pid_t spawn_worker(unsigned int slot)
+ *
+ * @param      slot index of the entry in the leases array for the new worker.
+ *
+ * @return     pid of the new worker process, or -1 if fork failed.
+ */
+pid_t spawn_worker(unsigned int slot)
+{
+    fflush(0);
+    leases[slot].task.chunk = NO_CHUNK;
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // child process. _exit is used so the child does not flush the stdio
+        // buffers it inherited from the parent
+        _exit(worker_process(slot));
+    }
+    if (pid > 0)
+    {
+        leases[slot].pid = pid;
+        ++liveWorkers;
+    }
+    return pid;
+}
+
+/**
+ * collects the exit statuses of terminated worker processes.
+ *
+ * @function   reap_workers
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * a worker that did not exit with a status of 0 is considered crashed. if it
+ *   held a lease on a chunk, the chunk is added to requeuedChunks, and if it
+ *   held tasksLock or feedbackLock, the lock is released on its behalf. if -r
+ *   was passed, and tasks are still being issued, a replacement worker is
+ *   spawned into its slot.
+ *
+ * if it died after reading a record, but before posting tasksNotFullSem for
+ *   it, it is posted on its behalf. a worker that dies right between posting
+ *   it, and setting slotFreed gets it posted twice, which only lets one more
+ *   record into the task pipe than it should hold.
+ *
+ * @signature  void reap_workers(int waitOptions)
+ *
+ * @param      waitOptions options passed to waitpid; WNOHANG to return right
+ *   away if no worker has terminated, or 0 to block until one does.
+ */
+void reap_workers(int waitOptions)
+{
+    pid_t pid;
+    int status;
+    while(liveWorkers > 0 && (pid = waitpid(-1,&status,waitOptions)) > 0)
+    {
+        --liveWorkers;
+
+        // find the slot of the terminated worker
+        unsigned int slot = 0;
+        while(slot < options->numWorkers && leases[slot].pid != pid)
+        {
+            ++slot;
+        }
+        if (slot == options->numWorkers ||
+            (WIFEXITED(status) && WEXITSTATUS(status) == 0))
+        {
+            continue;
+        }
+
+        if (WIFSIGNALED(status))
+        {
+            fprintf(stderr,"worker %d killed by signal %d\n",pid,WTERMSIG(status));
+        }
+        else
+        {
+            fprintf(stderr,"worker %d exited with status %d\n",pid,WEXITSTATUS(status));
+        }
+
+        // release any locks that the worker died holding
+        if (*tasksLockHolder == pid)
+        {
+            *tasksLockHolder = 0;
+            sem_post(tasksLock);
+        }
+        if (*feedbackLockHolder == pid)
+        {
+            // everything after the last complete batch was written by the
+            // dead worker, since it held the lock; drop it with its chunk.
+            // the ring may still be reading it, so there, pump_ring does
+            if (readBySignal)
+            {
+                read_feedback_pipe(SIGUSR1);
+                feedbackInbox.clear();
+                *feedbackLockHolder = 0;
+                sem_post(feedbackLock);
+            }
+            else
+            {
+                feedbackLockOrphaned = true;
+            }
+        }
+
+        // give back the room of the record it read
+        if (leases[slot].task.chunk != NO_CHUNK && !leases[slot].slotFreed)
+        {
+            sem_post(tasksNotFullSem);
+        }
+
+        // re-issue the chunk it was working on, and replace it
+        if (tasks[1] >= 0)
+        {
+            if (leases[slot].task.chunk != NO_CHUNK)
+            {
+                fprintf(stderr,"re-issuing chunk %lu\n",leases[slot].task.chunk);
+                requeuedChunks.push_back(leases[slot].task.chunk);
+            }
+            if (options->respawn && spawn_worker(slot) < 0)
+            {
+                perror("fork");
+            }
+        }
+        leases[slot].task.chunk = NO_CHUNK;
+    }
+}
+
+/**
+ * waits on a semaphore shared with the worker processes, reaping any workers
+ *   that terminate in the mean time.
+ *
+ * @function   wait_for_sem
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the semaphore is waited on with a timeout, so a worker that terminates just
+ *   before the wait begins is still noticed.
+ *
+ * @signature  bool wait_for_sem(sem_t* sem,bool retry)
+ *
+ * @param      sem semaphore to wait on.
+ * @param      retry true to keep waiting until the semaphore is acquired; false
+ *   to return after waiting once.
+ *
+ * @return     true if the semaphore was acquired; false otherwise, with errno
+ *   set to EINTR or ETIMEDOUT if retry is false and the wait was interrupted or
+ *   timed out, or ECHILD if no worker processes are left.
+ */
+bool wait_for_sem(sem_t* sem,bool retry)
+{
+    do
+    {
+        reap_workers(WNOHANG);
+        if (liveWorkers == 0)
+        {
+            errno = ECHILD;
+            return false;
+        }
+
+        timespec timeout;
+        clock_gettime(CLOCK_REALTIME,&timeout);
+        timeout.tv_nsec += 100*1000*1000;
+        if (timeout.tv_nsec >= 1000*1000*1000)
+        {
+            timeout.tv_nsec -= 1000*1000*1000;
+            ++timeout.tv_sec;
+        }
+        if (sem_timedwait(sem,&timeout) == 0)
+        {
+            return true;
+        }
+        if (errno != EINTR && errno != ETIMEDOUT)
+        {
+            return false;
+        }
+        read_feedback_pipe(SIGUSR1);
+    }
+    while(retry);
+
+    return false;
+}
+
+/**
+ * writes the record of a task into the task pipe.
+ *
+ * @function   write_task
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the record is smaller than PIPE_BUF, so it is written whole, or
+ *   not at all; a write interrupted by a signal is retried.
+ *
+ * @signature  bool write_task(unsigned long chunk)
+ *
+ * @param      chunk index of the chunk to find the factors in.
+ *
+ * @return     true if the record was written; false otherwise.
+ */
+bool write_task(unsigned long chunk)
+{
+    TaskRecord record;
+    record.chunk = chunk;
+    ssize_t length;
+    while((length = write(tasks[1],&record,sizeof(record))) < 0 && errno == EINTR);
+    return length == sizeof(record);
+}
+
+/**
+ * writes the chunks of dead children into the task pipe again.
+ *
+ * @function   write_requeued_chunks
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       chunks whose results arrived after all, because their worker
+ *   died after writing them, are skipped.
+ *
+ * @signature  bool write_requeued_chunks()
+ *
+ * @return     true if all the chunks were written; false otherwise.
+ */
+bool write_requeued_chunks()
+{
+    while(!requeuedChunks.empty() && *cancelFlag == 0)
+    {
+        unsigned long chunk = requeuedChunks.back();
+        requeuedChunks.pop_back();
+        if (!is_outstanding(chunk))
+        {
+            continue;
+        }
+        if (!wait_for_sem(tasksNotFullSem,true) || !write_task(chunk))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * returns true if the results of a chunk are still expected.
+ *
+ * @function   is_outstanding
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool is_outstanding(unsigned long chunk)
+ *
+ * @param      chunk index of the chunk to look up.
+ *
+ * @return     true if the chunk is outstanding; false otherwise.
+ */
+bool is_outstanding(unsigned long chunk)
+{
+    mask_feedback_signal(true);
+    bool found = outstandingChunks->count(chunk) != 0;
+    mask_feedback_signal(false);
+    return found;
+}
+
+/**
+ * masks, or unmasks SIGUSR1, so the parent can use the set of outstanding
+ *   chunks without the SIGUSR1 handler changing it under it.
+ *
+ * @function   mask_feedback_signal
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must not be called from the SIGUSR1 handler, which restores the
+ *   mask it was entered with instead.
+ *
+ * @signature  void mask_feedback_signal(bool masked)
+ *
+ * @param      masked true to mask SIGUSR1; false to unmask it.
+ */
+void mask_feedback_signal(bool masked)
+{
+    sigset_t feedbackSignal;
+    sigemptyset(&feedbackSignal);
+    sigaddset(&feedbackSignal,SIGUSR1);
+    sigprocmask(masked ? SIG_BLOCK : SIG_UNBLOCK,&feedbackSignal,0);
+}
@@ -0,0 +1,83 @@
+/**
+ * header file for the ProcessTransport class. implementation is in
+ *   ProcessTransport.cpp
+ *
+ * @sourceFile ProcessTransport.h
+ *
+ * @program    Factors-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * transport of the processes backend. chunks are written into a pipe read by
+ *   worker processes, and results come back through another pipe. see
+ *   Engine.h for what a transport does.
+ *
+ * if a worker process dies while working on a chunk, the chunk is issued again
+ *   to another worker. with -r, the dead worker is also replaced. with -u, the
+ *   pipes are written and read through io_uring if it is available.
+ *
+ * the cancellation flag lives in shared memory, like the semaphores. once it
+ *   is set, the children stop the task they are on, and skip the tasks left in
+ *   the pipe without writing any results, and finish stops waiting for chunks.
+ *
+ * the metrics are in shared memory too. each child counts into the slot of the
+ *   worker it replaces, so a slot adds up every child that held it. so is the
+ *   timeline, which the children record their spans into with --trace.
+ *
+ * the state shared with the signal handlers, and the worker processes lives at
+ *   file scope in ProcessTransport.cpp, so only one instance may exist at a
+ *   time.
+ */
+#ifndef PROCESSTRANSPORT_H
+#define PROCESSTRANSPORT_H
+
+#include <set>
+#include <deque>
+#include <string>
+#include "Engine.h"
+#include "IoRing.h"
+#include "Timeline.h"
+#include "WorkerMetrics.h"
+#include "ResultCollector.h"
+
+#define URING_TASK_SLOTS 8
+
+class ProcessTransport
+{
+public:
+
+    ProcessTransport(EngineOptions* _options,ResultCollector* _collector);
+    ~ProcessTransport();
+    bool start();
+    bool post(unsigned long chunk);
+    bool finish();
+    volatile int* get_cancel_flag();
+    WorkerMetrics* get_metrics();
+    Timeline* get_timeline();
+
+private:
+
+    bool open_ring();
+    bool pump_ring();
+    bool read_completions();
+
+    WorkerMetrics metrics;
+    Timeline timeline;
+    IoRing* ring;
+    std::deque<unsigned long> pendingChunks;
+    std::set<unsigned long> outstanding;
+    std::string nextTask;
+    std::string inbox;
+    unsigned int slotLength[URING_TASK_SLOTS];
+    bool reading;
+};
+
+#endif
@@ -0,0 +1,354 @@
+/**
+ * implementation of the Reporter class declared in Reporter.h
+ *
+ * @sourceFile Reporter.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   Coordinator-Main.out
+ *
+ * @class      Reporter
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * a line of the report looks like this:
+ *
+ *   42% 3120000 candidates/s, eta 17s, per worker: 1040000 1050000 1030000
+ *
+ * throughput is measured over the last interval. the estimate of the time left
+ *   is based on the throughput since the start of the run, so it does not jump
+ *   around as much.
+ */
+#include "Reporter.h"
+#include <time.h>
+#include <signal.h>
+#include "Engine.h"
+#include "Footprint.h"
+
+/**
+ * instantiates a Reporter instance.
+ *
+ * @class      Reporter
+ *
+ * @method     Reporter
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       nothing is reported until start is called.
+ *
+ * @signature  Reporter::Reporter(ResultCollector* _collector,FILE* _out,
+ *   FILE* _logFileOut,unsigned long _firstChunk,unsigned long _numChunks,
+ *   unsigned long _chunkSize)
+ *
+ * @param      _collector collector whose counters are sampled.
+ * @param      _out stream to print the report to besides the log file.
+ * @param      _logFileOut stream to the log file.
+ * @param      _firstChunk number of chunks that were already completed before
+ *   the run started.
+ * @param      _numChunks number of chunks in the whole range.
+ * @param      _chunkSize number of candidates in a chunk.
+ *
+ * @return     an instance of a Reporter.
+ */
+Reporter::Reporter(ResultCollector* _collector,FILE* _out,FILE* _logFileOut,unsigned long _firstChunk,unsigned long _numChunks,unsigned long _chunkSize)
+    :collector(_collector)
+    ,out(_out)
+    ,logFileOut(_logFileOut)
+    ,firstChunk(_firstChunk)
+    ,numChunks(_numChunks)
+    ,chunkSize(_chunkSize)
+    ,startTime(0)
+    ,lastTime(0)
+    ,lastChunksDone(0)
+    ,metrics(0)
+    ,metricsPath(0)
+    ,timeline(0)
+    ,stopSem(false,0)
+    ,running(false)
+{
+}
+
+/**
+ * destructor for the Reporter.
+ *
+ * @class      Reporter
+ *
+ * @method     ~Reporter
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       stops the reporter thread if it is still running.
+ *
+ * @signature  Reporter::~Reporter()
+ */
+Reporter::~Reporter()
+{
+    stop();
+}
+
+/**
+ * makes the reporter dump the metrics of the workers every time it reports.
+ *
+ * @class      Reporter
+ *
+ * @method     set_metrics
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must be called before start.
+ *
+ * @signature  void Reporter::set_metrics(WorkerMetrics* _metrics,
+ *   const char* _metricsPath)
+ *
+ * @param      _metrics metrics of the workers.
+ * @param      _metricsPath path of the file to dump them to.
+ */
+void Reporter::set_metrics(WorkerMetrics* _metrics,const char* _metricsPath)
+{
+    metrics = _metrics;
+    metricsPath = _metricsPath;
+}
+
+/**
+ * makes the reporter record every report on a timeline.
+ *
+ * @class      Reporter
+ *
+ * @method     set_timeline
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must be called before start. reports are recorded in the
+ *   reporter slot of the timeline.
+ *
+ * @signature  void Reporter::set_timeline(Timeline* _timeline)
+ *
+ * @param      _timeline timeline to record on.
+ */
+void Reporter::set_timeline(Timeline* _timeline)
+{
+    timeline = _timeline;
+}
+
+/**
+ * starts the reporter thread.
+ *
+ * @class      Reporter
+ *
+ * @method     start
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the reporter thread blocks all signals, so signal handlers of
+ *   the program are never run on it.
+ *
+ * @signature  bool Reporter::start()
+ *
+ * @return     true if the thread was started; false otherwise.
+ */
+bool Reporter::start()
+{
+    startTime = lastTime = current_timestamp();
+    lastChunksDone = collector->get_progress(&lastWorkerChunks);
+
+    // start the reporter thread with all signals blocked
+    sigset_t allSignals;
+    sigset_t oldSignals;
+    sigfillset(&allSignals);
+    pthread_sigmask(SIG_SETMASK,&allSignals,&oldSignals);
+    running = pthread_create(&reporter,0,reporter_routine,this) == 0;
+    pthread_sigmask(SIG_SETMASK,&oldSignals,0);
+
+    return running;
+}
+
+/**
+ * stops the reporter thread.
+ *
+ * @class      Reporter
+ *
+ * @method     stop
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       does nothing if the reporter thread is not running.
+ *
+ * @signature  void Reporter::stop()
+ */
+void Reporter::stop()
+{
+    if (running)
+    {
+        stopSem.post();
+        pthread_join(reporter,0);
+        running = false;
+    }
+}
+
+/**
+ * routine executed by the reporter thread.
+ *
+ * @class      Reporter
+ *
+ * @method     reporter_routine
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       reports every REPORT_INTERVAL_MS milliseconds until stop is
+ *   called.
+ *
+ * @signature  void* Reporter::reporter_routine(void* reporter)
+ *
+ * @param      reporter pointer to the Reporter that started the thread.
+ */
+void* Reporter::reporter_routine(void* reporter)
+{
+    Reporter* self = (Reporter*) reporter;
+
+    while(true)
+    {
+        timespec timeout;
+        clock_gettime(CLOCK_REALTIME,&timeout);
+        timeout.tv_sec += REPORT_INTERVAL_MS/1000;
+        timeout.tv_nsec += (REPORT_INTERVAL_MS%1000)*1000*1000;
+        if (timeout.tv_nsec >= 1000*1000*1000)
+        {
+            timeout.tv_nsec -= 1000*1000*1000;
+            ++timeout.tv_sec;
+        }
+        if (sem_timedwait(&self->stopSem.sem,&timeout) == 0)
+        {
+            break;
+        }
+
+        self->report();
+    }
+
+    return 0;
+}
+
+/**
+ * samples the counters of the collector, and prints a line of the report.
+ *
+ * @class      Reporter
+ *
+ * @method     report
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the chunk counts are converted into candidates with the chunk
+ *   size; the last chunk of the range is counted as full. the metrics are
+ *   dumped after the line is printed.
+ *
+ * @signature  void Reporter::report()
+ */
+void Reporter::report()
+{
+    unsigned long long reportStart = WorkerMetrics::now();
+    std::vector<unsigned long> workerChunks;
+    unsigned long chunksDone = collector->get_progress(&workerChunks);
+    long now = current_timestamp();
+    long elapsed = now-lastTime > 0 ? now-lastTime : 1;
+    long totalElapsed = now-startTime > 0 ? now-startTime : 1;
+
+    // a chunk is counted twice if it was re-issued after its results were
+    // posted, so the count is capped at the size of the range
+    unsigned long completed = firstChunk+chunksDone;
+    if (completed > numChunks)
+    {
+        completed = numChunks;
+    }
+    unsigned long percentage = numChunks ? completed*100/numChunks : 100;
+
+    // throughput over the last interval, and overall for the estimate
+    unsigned long rate = (chunksDone-lastChunksDone)*chunkSize*1000/elapsed;
+    unsigned long eta = chunksDone ? (numChunks-completed)*totalElapsed/chunksDone/1000 : 0;
+
+    fprintf(out,"%lu%% %lu candidates/s, eta %lus, per worker:",percentage,rate,eta);
+    fprintf(logFileOut,"%lu%% %lu candidates/s, eta %lus, per worker:",percentage,rate,eta);
+    for(register unsigned int i = 0; i < workerChunks.size(); ++i)
+    {
+        unsigned long workerRate = (workerChunks[i]-lastWorkerChunks[i])*chunkSize*1000/elapsed;
+        fprintf(out," %lu",workerRate);
+        fprintf(logFileOut," %lu",workerRate);
+    }
+    fprintf(out,"\n");
+    fprintf(logFileOut,"\n");
+    if (footprint_enabled())
+    {
+        print_footprint(out,logFileOut,collector->get_memory_used());
+    }
+
+    // factors are written into the same descriptors without going through
+    // stdio, so each line is flushed whole
+    fflush(out);
+    fflush(logFileOut);
+
+    lastTime = now;
+    lastChunksDone = chunksDone;
+    lastWorkerChunks = workerChunks;
+
+    if (metrics != 0 && !metrics->dump(metricsPath))
+    {
+        perror("failed to dump metrics");
+    }
+    if (timeline != 0)
+    {
+        timeline->record(timeline->get_reporter(),SPAN_PROGRESS,reportStart,WorkerMetrics::now(),TIMELINE_NO_CHUNK);
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * header file for the Reporter class. implementation is in Reporter.cpp
+ *
+ * @sourceFile Reporter.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   Coordinator-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * reports the progress of a run from a background thread. every
+ *   REPORT_INTERVAL_MS milliseconds, it samples the completed-chunk counters of
+ *   the collector, and prints the percentage of the range that is completed,
+ *   the throughput, an estimate of the time left, and the throughput of each
+ *   worker to stdout, or stderr, and the log file. the threads that produce tasks never
+ *   do any of this work.
+ *
+ * if it is given the metrics of the workers with set_metrics, it also dumps
+ *   them to their file every time it reports. if it is given a timeline with
+ *   set_timeline, it records every report on it. if the memory footprint is
+ *   measured, it is printed after every report.
+ */
+#ifndef REPORTER_H
+#define REPORTER_H
+
+#include <vector>
+#include <stdio.h>
+#include <pthread.h>
+#include "Semaphore.h"
+#include "Timeline.h"
+#include "WorkerMetrics.h"
+#include "ResultCollector.h"
+
+#define REPORT_INTERVAL_MS 1000
+
+class Reporter
+{
+public:
+
+    Reporter(ResultCollector* _collector,FILE* _out,FILE* _logFileOut,unsigned long _firstChunk,unsigned long _numChunks,unsigned long _chunkSize);
+    ~Reporter();
+    void set_metrics(WorkerMetrics* _metrics,const char* _metricsPath);
+    void set_timeline(Timeline* _timeline);
+    bool start();
+    void stop();
+
+private:
+
+    static void* reporter_routine(void* reporter);
+    void report();
+
+    ResultCollector* collector;
+    FILE* out;
+    FILE* logFileOut;
+    unsigned long firstChunk;
+    unsigned long numChunks;
+    unsigned long chunkSize;
+    long startTime;
+    long lastTime;
+    unsigned long lastChunksDone;
+    std::vector<unsigned long> lastWorkerChunks;
+    WorkerMetrics* metrics;
+    const char* metricsPath;
+    Timeline* timeline;
+    Semaphore stopSem;
+    pthread_t reporter;
+    bool running;
+};
+
+#endif
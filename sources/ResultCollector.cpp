@@ -0,0 +1,1144 @@
+/**
+ * implementation of the ResultCollector class declared in ResultCollector.h
+ *
+ * @sourceFile ResultCollector.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   Coordinator-Main.out, Agent-Main.out
+ *
+ * @class      ResultCollector
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ */
+#include "ResultCollector.h"
+#include "Lock.h"
+#include "Contention.h"
+#include <algorithm>
+
+static size_t footprint(Number* number);
+static bool less_than(Number* i,Number* j);
+static bool run_head_greater(const RunHead& i,const RunHead& j);
+
+/**
+ * instantiates a ResultCollector instance.
+ *
+ * @class      ResultCollector
+ *
+ * @method     ResultCollector
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  ResultCollector::ResultCollector(unsigned int numWorkers,
+ *   size_t _memoryBudget)
+ *
+ * @param      numWorkers number of workers that report chunks.
+ * @param      _memoryBudget number of bytes the collected factors may take up
+ *   before they are spilled to temporary files, or 0 to keep them all in
+ *   memory.
+ *
+ * @return     an instance of a ResultCollector.
+ */
+ResultCollector::ResultCollector(unsigned int numWorkers,size_t _memoryBudget)
+    :workerResults(numWorkers)
+    ,workerBytes(numWorkers,0)
+    ,memoryBudget(_memoryBudget)
+    ,memoryUsed(0)
+    ,nextResult(0)
+    ,haveLastResult(false)
+    ,workerChunks(numWorkers,0)
+    ,checkpoint(0)
+    ,factorization(0)
+    ,writer(0)
+    ,streamFrontier(0)
+    ,ranged(false)
+    ,reducing(false)
+    ,relayOut(0)
+    ,findingFirst(false)
+    ,haveFirstFactor(false)
+    ,firstFactorChunk(0)
+    ,cancelFlag(0)
+    ,frontier(0)
+    ,access(false,1)
+{
+    contention_name(&access.sem,"ResultCollector::access");
+}
+
+/**
+ * destructor for the ResultCollector. deletes the collected factors, the
+ *   checkpoint, and the spilled runs.
+ *
+ * @class      ResultCollector
+ *
+ * @method     ~ResultCollector
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  ResultCollector::~ResultCollector()
+ */
+ResultCollector::~ResultCollector()
+{
+    delete checkpoint;
+    for(register unsigned int i = 0; i < results.size(); ++i)
+    {
+        delete results[i];
+    }
+    for(register unsigned int i = 0; i < workerResults.size(); ++i)
+    {
+        for(register unsigned int j = 0; j < workerResults[i].size(); ++j)
+        {
+            delete workerResults[i][j];
+        }
+    }
+    for(register unsigned int i = 0; i < runHeads.size(); ++i)
+    {
+        delete runHeads[i].value;
+    }
+    for(register unsigned int i = 0; i < runs.size(); ++i)
+    {
+        fclose(runs[i]);
+    }
+
+    std::map<unsigned long,std::vector<Number*> >::iterator it;
+    for(it = reorderBuffer.begin(); it != reorderBuffer.end(); ++it)
+    {
+        for(register unsigned int i = 0; i < it->second.size(); ++i)
+        {
+            delete it->second[i];
+        }
+    }
+}
+
+/**
+ * sets the checkpoint that completed chunks are recorded in.
+ *
+ * @class      ResultCollector
+ *
+ * @method     set_checkpoint
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the collector takes ownership of the checkpoint, and deletes it.
+ *
+ * @signature  void ResultCollector::set_checkpoint(Checkpoint* _checkpoint)
+ *
+ * @param      _checkpoint checkpoint that is already started.
+ */
+void ResultCollector::set_checkpoint(Checkpoint* _checkpoint)
+{
+    checkpoint = _checkpoint;
+}
+
+/**
+ * sets the factorization that the factors are passed to as they are written
+ *   out, or returned.
+ *
+ * @class      ResultCollector
+ *
+ * @method     set_factorization
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the collector does not take ownership of the factorization.
+ *
+ * @signature  void ResultCollector::set_factorization(
+ *   Factorization* _factorization)
+ *
+ * @param      _factorization factorization of the number whose factors are
+ *   collected.
+ */
+void ResultCollector::set_factorization(Factorization* _factorization)
+{
+    factorization = _factorization;
+}
+
+/**
+ * switches the collector to streaming mode; factors are written out in
+ *   ascending order as soon as they are known, instead of being kept.
+ *
+ * @class      ResultCollector
+ *
+ * @method     start_stream
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       factors loaded from the checkpoint are all below firstChunk, so
+ *   they are sorted, and written out right away. each factor is written on a
+ *   line of its own.
+ *
+ * @signature  void ResultCollector::start_stream(TeeWriter* _writer,
+ *   unsigned long firstChunk)
+ *
+ * @param      _writer writer to write the factors to.
+ * @param      firstChunk first chunk that will be reported to the collector.
+ */
+void ResultCollector::start_stream(TeeWriter* _writer,unsigned long firstChunk)
+{
+    writer = _writer;
+    streamFrontier = firstChunk;
+
+    std::sort(results.begin(),results.end(),less_than);
+    for(register unsigned int i = 0; i < results.size(); ++i)
+    {
+        writer->append_number(results[i]->value);
+        writer->append("\n");
+        if (factorization != 0)
+        {
+            factorization->add_divisor(results[i]->value);
+        }
+        delete results[i];
+    }
+    results.clear();
+    writer->flush();
+}
+
+/**
+ * drops every factor outside of the passed range from now on.
+ *
+ * @class      ResultCollector
+ *
+ * @method     set_range
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must be called before any chunks are reported.
+ *
+ * @signature  void ResultCollector::set_range(mpz_t lo,mpz_t hi)
+ *
+ * @param      lo smallest factor that is kept.
+ * @param      hi largest factor that is kept.
+ */
+void ResultCollector::set_range(mpz_t lo,mpz_t hi)
+{
+    ranged = true;
+    mpz_set(rangeLo.value,lo);
+    mpz_set(rangeHi.value,hi);
+}
+
+/**
+ * sets the first chunk that will be reported to the collector.
+ *
+ * @class      ResultCollector
+ *
+ * @method     set_frontier
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the chunks below it count as complete. must be called before any
+ *   chunks are reported.
+ *
+ * @signature  void ResultCollector::set_frontier(unsigned long firstChunk)
+ *
+ * @param      firstChunk first chunk that will be reported to the collector.
+ */
+void ResultCollector::set_frontier(unsigned long firstChunk)
+{
+    frontier = firstChunk;
+}
+
+/**
+ * switches the collector to reduction mode; factors are counted, and summed
+ *   instead of being kept.
+ *
+ * @class      ResultCollector
+ *
+ * @method     start_reduction
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must be called before any chunks are reported.
+ *
+ * @signature  void ResultCollector::start_reduction()
+ */
+void ResultCollector::start_reduction()
+{
+    reducing = true;
+}
+
+/**
+ * switches the collector to relay mode; the factors of each chunk are written
+ *   to a stream as a batch instead of being kept.
+ *
+ * @class      ResultCollector
+ *
+ * @method     start_relay
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must be called before any chunks are reported. the stream is
+ *   flushed after every batch, and is not closed by the collector.
+ *
+ * @signature  void ResultCollector::start_relay(FILE* _relayOut)
+ *
+ * @param      _relayOut stream to write the batches to.
+ */
+void ResultCollector::start_relay(FILE* _relayOut)
+{
+    relayOut = _relayOut;
+}
+
+/**
+ * returns the number of factors counted in reduction mode, and their sum.
+ *
+ * @class      ResultCollector
+ *
+ * @method     get_reduction
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void ResultCollector::get_reduction(mpz_t count,mpz_t sum)
+ *
+ * @param      count set to the number of factors.
+ * @param      sum set to the sum of the factors.
+ */
+void ResultCollector::get_reduction(mpz_t count,mpz_t sum)
+{
+    Lock scopelock(&access.sem);
+    mpz_set(count,factorCount.value);
+    mpz_set(sum,factorSum.value);
+}
+
+/**
+ * switches the collector to first factor mode; only the smallest factor above
+ *   1 is kept.
+ *
+ * @class      ResultCollector
+ *
+ * @method     start_first_factor
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must be called before any chunks are reported.
+ *
+ * @signature  void ResultCollector::start_first_factor()
+ */
+void ResultCollector::start_first_factor()
+{
+    findingFirst = true;
+}
+
+/**
+ * sets the flag that is set once the smallest factor above 1 is known in
+ *   first factor mode.
+ *
+ * @class      ResultCollector
+ *
+ * @method     set_cancel_flag
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the collector does not take ownership of the flag.
+ *
+ * @signature  void ResultCollector::set_cancel_flag(
+ *   volatile int* _cancelFlag)
+ *
+ * @param      _cancelFlag cancellation flag of the transport.
+ */
+void ResultCollector::set_cancel_flag(volatile int* _cancelFlag)
+{
+    Lock scopelock(&access.sem);
+    cancelFlag = _cancelFlag;
+}
+
+/**
+ * returns the smallest factor above 1 found in first factor mode.
+ *
+ * @class      ResultCollector
+ *
+ * @method     get_first_factor
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the factor is only the smallest one of the number if every chunk
+ *   below it is complete; see get_frontier.
+ *
+ * @signature  bool ResultCollector::get_first_factor(mpz_t factor)
+ *
+ * @param      factor set to the smallest factor found.
+ *
+ * @return     true if a factor above 1 was found; false otherwise.
+ */
+bool ResultCollector::get_first_factor(mpz_t factor)
+{
+    Lock scopelock(&access.sem);
+    if (haveFirstFactor)
+    {
+        mpz_set(factor,firstFactor.value);
+    }
+    return haveFirstFactor;
+}
+
+/**
+ * adds the factors found in a chunk to the results, and records the chunk as
+ *   completed in the checkpoint.
+ *
+ * @class      ResultCollector
+ *
+ * @method     chunk_done
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the collector takes ownership of the factors. a chunk may be reported more
+ *   than once if a worker died after posting its results; duplicated factors
+ *   are removed by finish.
+ *
+ * if the factors held in memory go over the memory budget, the calling
+ *   worker's buffer is spilled to a temporary file. the spill happens outside
+ *   the lock, so other workers can keep reporting chunks meanwhile.
+ *
+ * in streaming mode, the factors are put into the reorder buffer instead, and
+ *   every chunk at the front of the buffer is written out. the factors within
+ *   a chunk are already in ascending order. a chunk that was already reported
+ *   is dropped.
+ *
+ * in reduction mode, the factors are counted, summed, and deleted. in first
+ *   factor mode, the smallest one above 1 is kept, and the rest are deleted.
+ *   in relay mode, they are written to the relay stream as a batch, and
+ *   deleted.
+ *
+ * the completed chunks are tracked the same way the checkpoint tracks them; a
+ *   frontier below which every chunk is complete, and a set of the chunks
+ *   completed above it. in reduction, and first factor mode, a chunk that was
+ *   already reported is dropped.
+ *
+ * @signature  void ResultCollector::chunk_done(unsigned int worker,
+ *   unsigned long chunk,std::vector<Number*>* factors)
+ *
+ * @param      worker index of the worker that completed the chunk.
+ * @param      chunk index of the completed chunk.
+ * @param      factors factors found in the chunk.
+ */
+void ResultCollector::chunk_done(unsigned int worker,unsigned long chunk,std::vector<Number*>* factors)
+{
+    if (ranged)
+    {
+        unsigned int kept = 0;
+        for(register unsigned int i = 0; i < factors->size(); ++i)
+        {
+            Number* factor = factors->at(i);
+            if (mpz_cmp(factor->value,rangeLo.value) < 0 || mpz_cmp(factor->value,rangeHi.value) > 0)
+            {
+                delete factor;
+            }
+            else
+            {
+                factors->at(kept++) = factor;
+            }
+        }
+        factors->resize(kept);
+    }
+
+    if (relayOut != 0)
+    {
+        // write the results as a batch; the chunk index, the number of
+        // results, then the results
+        Lock scopelock(&access.sem);
+        ++workerChunks[worker];
+        Number batchHeader;
+        mpz_set_ui(batchHeader.value,chunk);
+        mpz_out_raw(relayOut,batchHeader.value);
+        mpz_set_ui(batchHeader.value,factors->size());
+        mpz_out_raw(relayOut,batchHeader.value);
+        for(register unsigned int i = 0; i < factors->size(); ++i)
+        {
+            mpz_out_raw(relayOut,factors->at(i)->value);
+            delete factors->at(i);
+        }
+        fflush(relayOut);
+        return;
+    }
+
+    if (reducing)
+    {
+        // count, and sum the factors outside the lock
+        Number sum;
+        unsigned long count = factors->size();
+        for(register unsigned int i = 0; i < factors->size(); ++i)
+        {
+            mpz_add(sum.value,sum.value,factors->at(i)->value);
+            delete factors->at(i);
+        }
+
+        Lock scopelock(&access.sem);
+        ++workerChunks[worker];
+        if (!advance_frontier(chunk))
+        {
+            return;
+        }
+        mpz_add_ui(factorCount.value,factorCount.value,count);
+        mpz_add(factorSum.value,factorSum.value,sum.value);
+        return;
+    }
+
+    if (findingFirst)
+    {
+        // pick out the smallest factor above 1 outside the lock
+        Number* smallest = 0;
+        for(register unsigned int i = 0; i < factors->size(); ++i)
+        {
+            Number* factor = factors->at(i);
+            if (mpz_cmp_ui(factor->value,1) > 0 &&
+                (smallest == 0 || mpz_cmp(factor->value,smallest->value) < 0))
+            {
+                smallest = factor;
+            }
+        }
+
+        Lock scopelock(&access.sem);
+        ++workerChunks[worker];
+        if (advance_frontier(chunk) && smallest != 0 &&
+            (!haveFirstFactor || mpz_cmp(smallest->value,firstFactor.value) < 0))
+        {
+            haveFirstFactor = true;
+            firstFactorChunk = chunk;
+            mpz_set(firstFactor.value,smallest->value);
+        }
+        for(register unsigned int i = 0; i < factors->size(); ++i)
+        {
+            delete factors->at(i);
+        }
+
+        // every chunk that could hold a smaller factor is complete
+        if (haveFirstFactor && frontier > firstFactorChunk && cancelFlag != 0)
+        {
+            *cancelFlag = 1;
+        }
+        return;
+    }
+
+    if (checkpoint != 0)
+    {
+        checkpoint->chunk_done(chunk,factors);
+    }
+
+    std::vector<Number*> run;
+    {
+        Lock scopelock(&access.sem);
+        ++workerChunks[worker];
+        advance_frontier(chunk);
+        if (writer == 0)
+        {
+            std::vector<Number*>& buffer = workerResults[worker];
+            buffer.insert(buffer.end(),factors->begin(),factors->end());
+            for(register unsigned int i = 0; i < factors->size(); ++i)
+            {
+                size_t bytes = footprint(factors->at(i));
+                workerBytes[worker] += bytes;
+                memoryUsed += bytes;
+            }
+            if (memoryBudget == 0 || memoryUsed <= memoryBudget)
+            {
+                return;
+            }
+            run.swap(buffer);
+            memoryUsed -= workerBytes[worker];
+            workerBytes[worker] = 0;
+        }
+    }
+    if (!run.empty())
+    {
+        if (!spill_run(&run))
+        {
+            // keep the factors in memory rather than lose them
+            perror("failed to spill results");
+            Lock scopelock(&access.sem);
+            results.insert(results.end(),run.begin(),run.end());
+        }
+        return;
+    }
+
+    Lock scopelock(&access.sem);
+
+    if (chunk < streamFrontier || reorderBuffer.count(chunk))
+    {
+        for(register unsigned int i = 0; i < factors->size(); ++i)
+        {
+            delete factors->at(i);
+        }
+        return;
+    }
+    reorderBuffer[chunk] = *factors;
+    for(register unsigned int i = 0; i < factors->size(); ++i)
+    {
+        memoryUsed += footprint(factors->at(i));
+    }
+
+    // write out all consecutive completed chunks at the front of the buffer
+    bool advanced = false;
+    while(!reorderBuffer.empty() && reorderBuffer.begin()->first == streamFrontier)
+    {
+        std::vector<Number*>& done = reorderBuffer.begin()->second;
+        for(register unsigned int i = 0; i < done.size(); ++i)
+        {
+            writer->append_number(done[i]->value);
+            writer->append("\n");
+            if (factorization != 0)
+            {
+                factorization->add_divisor(done[i]->value);
+            }
+            memoryUsed -= footprint(done[i]);
+            delete done[i];
+        }
+        reorderBuffer.erase(reorderBuffer.begin());
+        ++streamFrontier;
+        advanced = true;
+    }
+    if (advanced)
+    {
+        writer->flush();
+    }
+}
+
+/**
+ * returns the number of chunks completed so far.
+ *
+ * @class      ResultCollector
+ *
+ * @method     get_progress
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       chunks loaded from the checkpoint are not counted.
+ *
+ * @signature  unsigned long ResultCollector::get_progress(
+ *   std::vector<unsigned long>* _workerChunks)
+ *
+ * @param      _workerChunks set to the number of chunks completed by each
+ *   worker.
+ *
+ * @return     number of chunks completed by all the workers.
+ */
+unsigned long ResultCollector::get_progress(std::vector<unsigned long>* _workerChunks)
+{
+    Lock scopelock(&access.sem);
+    *_workerChunks = workerChunks;
+
+    unsigned long chunksDone = 0;
+    for(register unsigned int i = 0; i < workerChunks.size(); ++i)
+    {
+        chunksDone += workerChunks[i];
+    }
+    return chunksDone;
+}
+
+/**
+ * returns the number of bytes taken up by the factors held in memory.
+ *
+ * @class      ResultCollector
+ *
+ * @method     get_memory_used
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       counts the factors in the buffers of the workers, or in the
+ *   reorder buffer when streaming, as estimated for the memory budget. spilled
+ *   factors are not counted.
+ *
+ * @signature  size_t ResultCollector::get_memory_used()
+ *
+ * @return     estimated number of bytes used by the factors.
+ */
+size_t ResultCollector::get_memory_used()
+{
+    Lock scopelock(&access.sem);
+    return memoryUsed;
+}
+
+/**
+ * returns the frontier below which every chunk is complete.
+ *
+ * @class      ResultCollector
+ *
+ * @method     get_frontier
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       chunks below the first chunk set with set_frontier count as
+ *   complete.
+ *
+ * @signature  unsigned long ResultCollector::get_frontier()
+ *
+ * @return     index of the first chunk that is not complete.
+ */
+unsigned long ResultCollector::get_frontier()
+{
+    Lock scopelock(&access.sem);
+    return frontier;
+}
+
+/**
+ * writes the final checkpoint, and sorts the results, removing duplicates.
+ *   in streaming mode, there are no results left to sort.
+ *
+ * @class      ResultCollector
+ *
+ * @method     finish
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must only be called once no more chunks are being reported. if
+ *   any runs were spilled, the results held in memory are sorted, and the
+ *   first factor of every run is read back, so next_result can merge them.
+ *
+ * @signature  void ResultCollector::finish()
+ */
+void ResultCollector::finish()
+{
+    if (checkpoint != 0)
+    {
+        checkpoint->stop();
+        delete checkpoint;
+        checkpoint = 0;
+    }
+
+    for(register unsigned int i = 0; i < workerResults.size(); ++i)
+    {
+        results.insert(results.end(),workerResults[i].begin(),workerResults[i].end());
+        workerResults[i].clear();
+        workerBytes[i] = 0;
+    }
+    memoryUsed = 0;
+
+    std::sort(results.begin(),results.end(),less_than);
+    unsigned int kept = 0;
+    for(register unsigned int i = 0; i < results.size(); ++i)
+    {
+        if (kept == 0 || mpz_cmp(results[kept-1]->value,results[i]->value) != 0)
+        {
+            results[kept++] = results[i];
+        }
+        else
+        {
+            delete results[i];
+        }
+    }
+    results.resize(kept);
+
+    // read the first factor of every spilled run
+    for(register unsigned int i = 0; i < runs.size(); ++i)
+    {
+        RunHead head;
+        head.value = new Number();
+        head.run = runs[i];
+        rewind(head.run);
+        if (mpz_inp_raw(head.value->value,head.run) == 0)
+        {
+            delete head.value;
+            fclose(head.run);
+            continue;
+        }
+        runHeads.push_back(head);
+    }
+    runs.clear();
+    std::make_heap(runHeads.begin(),runHeads.end(),run_head_greater);
+}
+
+/**
+ * returns the collected factors one at a time, in ascending order, without
+ *   duplicates.
+ *
+ * @class      ResultCollector
+ *
+ * @method     next_result
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       merges the spilled runs with the results held in memory. the
+ *   runs are kept in a heap keyed by the factor at their front, so only one
+ *   factor from each run is in memory at a time. must only be called after
+ *   finish.
+ *
+ * @signature  bool ResultCollector::next_result(mpz_t result)
+ *
+ * @param      result set to the next factor.
+ *
+ * @return     true if result was set; false if there are no more factors.
+ */
+bool ResultCollector::next_result(mpz_t result)
+{
+    while(true)
+    {
+        Number* fromMemory = nextResult < results.size() ? results[nextResult] : 0;
+        if (!runHeads.empty() && (fromMemory == 0 ||
+            mpz_cmp(runHeads.front().value->value,fromMemory->value) < 0))
+        {
+            // take the factor at the front of the smallest run, and read the
+            // next one from it
+            std::pop_heap(runHeads.begin(),runHeads.end(),run_head_greater);
+            RunHead& head = runHeads.back();
+            mpz_set(result,head.value->value);
+            if (mpz_inp_raw(head.value->value,head.run) != 0)
+            {
+                std::push_heap(runHeads.begin(),runHeads.end(),run_head_greater);
+            }
+            else
+            {
+                delete head.value;
+                fclose(head.run);
+                runHeads.pop_back();
+            }
+        }
+        else if (fromMemory != 0)
+        {
+            mpz_set(result,fromMemory->value);
+            ++nextResult;
+        }
+        else
+        {
+            return false;
+        }
+
+        // a factor may be in more than one run if its chunk was reported twice
+        if (!haveLastResult || mpz_cmp(lastResult.value,result) != 0)
+        {
+            mpz_set(lastResult.value,result);
+            haveLastResult = true;
+            if (factorization != 0)
+            {
+                factorization->add_divisor(result);
+            }
+            return true;
+        }
+    }
+}
+
+/**
+ * returns the collected factors.
+ *
+ * @class      ResultCollector
+ *
+ * @method     get_results
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the vector must not be used while chunks are being reported,
+ *   except to load a checkpoint into before the workers are started. after
+ *   finish, it only holds the factors that were not spilled; use next_result
+ *   to get all of them.
+ *
+ * @signature  std::vector<Number*>* ResultCollector::get_results()
+ *
+ * @return     pointer to the vector of collected factors.
+ */
+std::vector<Number*>* ResultCollector::get_results()
+{
+    return &results;
+}
+
+/**
+ * sorts a run of factors, writes it to a temporary file, and deletes the
+ *   factors.
+ *
+ * @class      ResultCollector
+ *
+ * @method     spill_run
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the factors are written with mpz_out_raw. the file is created
+ *   with tmpfile, so it is removed once it is closed, or the program
+ *   terminates. the factors are left untouched if the run can not be written.
+ *
+ * @signature  bool ResultCollector::spill_run(std::vector<Number*>* run)
+ *
+ * @param      run factors to spill; cleared if they were spilled.
+ *
+ * @return     true if the run was spilled; false otherwise, with errno set.
+ */
+bool ResultCollector::spill_run(std::vector<Number*>* run)
+{
+    FILE* file = tmpfile();
+    if (file == 0)
+    {
+        return false;
+    }
+
+    std::sort(run->begin(),run->end(),less_than);
+    for(register unsigned int i = 0; i < run->size(); ++i)
+    {
+        if (mpz_out_raw(file,run->at(i)->value) == 0)
+        {
+            fclose(file);
+            return false;
+        }
+    }
+    if (fflush(file) != 0)
+    {
+        fclose(file);
+        return false;
+    }
+
+    for(register unsigned int i = 0; i < run->size(); ++i)
+    {
+        delete run->at(i);
+    }
+    run->clear();
+
+    Lock scopelock(&access.sem);
+    runs.push_back(file);
+    return true;
+}
+
+/**
+ * records a chunk as complete, and moves the frontier past every consecutive
+ *   complete chunk.
+ *
+ * @class      ResultCollector
+ *
+ * @method     advance_frontier
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must be called while holding the access lock.
+ *
+ * @signature  bool ResultCollector::advance_frontier(unsigned long chunk)
+ *
+ * @param      chunk index of the completed chunk.
+ *
+ * @return     true if the chunk was not complete before; false otherwise.
+ */
+bool ResultCollector::advance_frontier(unsigned long chunk)
+{
+    if (chunk < frontier || !doneAhead.insert(chunk).second)
+    {
+        return false;
+    }
+    while(!doneAhead.empty() && *doneAhead.begin() == frontier)
+    {
+        doneAhead.erase(doneAhead.begin());
+        ++frontier;
+    }
+    return true;
+}
+
+/**
+ * returns an estimate of the memory taken up by a collected factor.
+ *
+ * @function   footprint
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       counts the Number, its limbs, the pointer to it in a buffer,
+ *   and the allocator's overhead for the two allocations.
+ *
+ * @signature  size_t footprint(Number* number)
+ *
+ * @param      number factor to estimate the memory of.
+ *
+ * @return     estimated number of bytes used by the factor.
+ */
+static size_t footprint(Number* number)
+{
+    return sizeof(Number)+sizeof(Number*)+2*2*sizeof(size_t)+
+        mpz_size(number->value)*sizeof(mp_limb_t);
+}
+
+/**
+ * orders factors in ascending order.
+ *
+ * @function   less_than
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool less_than(Number* i,Number* j)
+ *
+ * @param      i factor on the left side.
+ * @param      j factor on the right side.
+ *
+ * @return     true if i is smaller than j; false otherwise.
+ */
+static bool less_than(Number* i,Number* j)
+{
+    return mpz_cmp(i->value,j->value) < 0;
+}
+
+/**
+ * orders runs by the factor at their front, so the heap of runs built with it
+ *   has the run with the smallest factor at the top.
+ *
+ * @function   run_head_greater
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool run_head_greater(const RunHead& i,
+ *   const RunHead& j)
+ *
+ * @param      i run on the left side.
+ * @param      j run on the right side.
+ *
+ * @return     true if the front of i is larger than the front of j; false
+ *   otherwise.
+ */
+static bool run_head_greater(const RunHead& i,const RunHead& j)
+{
+    return mpz_cmp(i.value->value,j.value->value) > 0;
+}
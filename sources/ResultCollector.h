@@ -0,0 +1,145 @@
+/**
+ * header file for the ResultCollector class. implementation is in
+ *   ResultCollector.cpp
+ *
+ * @sourceFile ResultCollector.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   Coordinator-Main.out, Agent-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * collects the factors found in each chunk of the range, no matter which
+ *   backend found them, and records every completed chunk in the checkpoint if
+ *   there is one. chunk_done may be called from any thread.
+ *
+ * also counts the chunks completed by each worker, so progress can be sampled
+ *   without involving the workers.
+ *
+ * in streaming mode, factors are not kept until the end. chunks that complete
+ *   out of order wait in a reorder buffer keyed by chunk index, and the factors
+ *   of each chunk are written out as soon as all the chunks below it are
+ *   complete, so they come out in ascending order.
+ *
+ * with a memory budget, factors are kept in a buffer per worker. once the
+ *   factors held in memory take up more than the budget, the buffer of the
+ *   worker that went over is sorted, and spilled to a temporary file as a run.
+ *   finish then merges the runs, and whatever is left in memory, and
+ *   next_result returns the merged factors one at a time, so they never all
+ *   have to be in memory at once.
+ *
+ * if a factorization is set, every factor is passed to it in ascending order
+ *   as it is written out in streaming mode, or returned by next_result.
+ *
+ * with a range set, factors outside of it are dropped as soon as their chunk
+ *   is reported. in reduction mode, the factors of each chunk are only counted,
+ *   and summed, and then deleted, so nothing is kept, sorted, or printed. a
+ *   chunk that was already reported is not counted again.
+ *
+ * in relay mode, the factors of each chunk are written to a stream as a batch
+ *   as soon as it is reported, and deleted; the chunk index, the number of
+ *   factors, then the factors, all with mpz_out_raw. the agent uses it to send
+ *   the results of its workers on to the coordinator.
+ *
+ * in first factor mode, only the smallest factor above 1 is kept. once every
+ *   chunk below the one it was found in is complete, no smaller one can turn
+ *   up, so the cancellation flag is set to stop the workers.
+ *
+ * in every mode, the collector keeps a frontier below which every chunk is
+ *   complete, so a run that is cut short can tell how far its results go.
+ */
+#ifndef RESULTCOLLECTOR_H
+#define RESULTCOLLECTOR_H
+
+#include <map>
+#include <set>
+#include <stdio.h>
+#include <stddef.h>
+#include <vector>
+#include "Number.h"
+#include "TeeWriter.h"
+#include "Semaphore.h"
+#include "Checkpoint.h"
+#include "Factorization.h"
+
+/**
+ * the factor at the front of a spilled run while the runs are being merged.
+ */
+struct RunHead
+{
+    Number* value;
+    FILE* run;
+};
+
+class ResultCollector
+{
+public:
+
+    ResultCollector(unsigned int numWorkers,size_t _memoryBudget);
+    ~ResultCollector();
+    void set_checkpoint(Checkpoint* _checkpoint);
+    void set_factorization(Factorization* _factorization);
+    void start_stream(TeeWriter* _writer,unsigned long firstChunk);
+    void set_range(mpz_t lo,mpz_t hi);
+    void set_frontier(unsigned long firstChunk);
+    void start_reduction();
+    void start_relay(FILE* _relayOut);
+    void get_reduction(mpz_t count,mpz_t sum);
+    void start_first_factor();
+    void set_cancel_flag(volatile int* _cancelFlag);
+    bool get_first_factor(mpz_t factor);
+    void chunk_done(unsigned int worker,unsigned long chunk,std::vector<Number*>* factors);
+    unsigned long get_progress(std::vector<unsigned long>* workerChunks);
+    unsigned long get_frontier();
+    size_t get_memory_used();
+    void finish();
+    bool next_result(mpz_t result);
+    std::vector<Number*>* get_results();
+
+private:
+
+    bool spill_run(std::vector<Number*>* run);
+    bool advance_frontier(unsigned long chunk);
+
+    std::vector<Number*> results;
+    std::vector<std::vector<Number*> > workerResults;
+    std::vector<size_t> workerBytes;
+    size_t memoryBudget;
+    size_t memoryUsed;
+    std::vector<FILE*> runs;
+    std::vector<RunHead> runHeads;
+    unsigned int nextResult;
+    Number lastResult;
+    bool haveLastResult;
+    std::vector<unsigned long> workerChunks;
+    Checkpoint* checkpoint;
+    Factorization* factorization;
+    TeeWriter* writer;
+    unsigned long streamFrontier;
+    std::map<unsigned long,std::vector<Number*> > reorderBuffer;
+    bool ranged;
+    Number rangeLo;
+    Number rangeHi;
+    bool reducing;
+    Number factorCount;
+    Number factorSum;
+    FILE* relayOut;
+    bool findingFirst;
+    bool haveFirstFactor;
+    unsigned long firstFactorChunk;
+    Number firstFactor;
+    volatile int* cancelFlag;
+    unsigned long frontier;
+    std::set<unsigned long> doneAhead;
+    Semaphore access;
+};
+
+#endif
@@ -22,6 +22,8 @@
  *   or destroyed.
  */
 #include "Semaphore.h"
+#include "Contention.h"
+#include "SpinWait.h"
 
 /**
  * instantiates a Semaphore instance.
@@ -119,11 +121,16 @@ void Semaphore::post()
  *
  * @programmer Eric Tsang
  *
- * @note       none
+ * @note       spins on the semaphore for a while before sleeping on it if
+ *   spinning is turned on; see SpinWait.h.
  *
  * @signature  void Semaphore::wait()
  */
 void Semaphore::wait()
 {
-    sem_wait(&sem);
+#ifdef TRACE_CONTENTION
+    contention_wait(&sem);
+#else
+    spin_wait(&sem);
+#endif
 }
@@ -17,6 +17,9 @@
  *
  * used to wrap a semaphore object so it can be properly deallocated when the
  *   Semaphore instance is destroyed.
+ *
+ * wait spins on the semaphore for a while before going to sleep if spinning
+ *   is turned on; see SpinWait.h.
  */
 #ifndef SEMAPHORE_H
 #define SEMAPHORE_H
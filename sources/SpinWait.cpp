@@ -0,0 +1,181 @@
+/**
+ * implementation of waiting on semaphores by spinning before sleeping declared
+ *   in SpinWait.h
+ *
+ * @sourceFile SpinWait.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   LockBenchmark.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * the averages are read, and written without a lock; a lost update only makes
+ *   the next waiter spin a little more, or less than it should.
+ */
+#include "SpinWait.h"
+#include <unistd.h>
+#include <stdint.h>
+
+static volatile unsigned int* average_of(sem_t* sem);
+static void relax();
+
+/**
+ * true once spin_enable(true) is called.
+ */
+static volatile bool spinEnabled = false;
+
+/**
+ * number of cpus that are online, or 0 until it is read.
+ */
+static long numCpus = 0;
+
+/**
+ * the average number of spins it took to get the semaphores whose addresses
+ *   land on each entry, scaled by 8.
+ */
+static volatile unsigned int averageSpins[SPIN_WAIT_TABLE_SIZE];
+
+/**
+ * turns spinning on, or off for the whole process.
+ *
+ * @function   spin_enable
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       spinning is off until this is called.
+ *
+ * @signature  void spin_enable(bool enabled)
+ *
+ * @param      enabled true to spin before sleeping, or false to make
+ *   spin_wait the same as sem_wait.
+ */
+void spin_enable(bool enabled)
+{
+    spinEnabled = enabled;
+}
+
+/**
+ * waits on a semaphore, spinning on it for a while before going to sleep.
+ *
+ * @function   spin_wait
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       see SpinWait.h for how long it spins.
+ *
+ * @signature  void spin_wait(sem_t* sem)
+ *
+ * @param      sem semaphore to wait on.
+ */
+void spin_wait(sem_t* sem)
+{
+    if (numCpus == 0)
+    {
+        numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (!spinEnabled || numCpus <= 1)
+    {
+        sem_wait(sem);
+        return;
+    }
+
+    // spin while the semaphore is taken, only trying to take it once it looks
+    // free
+    volatile unsigned int* average = average_of(sem);
+    unsigned int limit = 2*(*average/8)+SPIN_WAIT_MIN_SPINS;
+    if (limit > SPIN_WAIT_MAX_SPINS)
+    {
+        limit = SPIN_WAIT_MAX_SPINS;
+    }
+    for(register unsigned int spins = 0; spins < limit; ++spins)
+    {
+        int value;
+        sem_getvalue(sem,&value);
+        if (value > 0 && sem_trywait(sem) == 0)
+        {
+            // move the average an eighth of the way to this wait
+            *average = *average-*average/8+spins;
+            return;
+        }
+        relax();
+    }
+
+    // it is held for longer than it is worth spinning for
+    *average = *average/2;
+    sem_wait(sem);
+}
+
+/**
+ * returns the average that a semaphore is counted in.
+ *
+ * @function   average_of
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       semaphores are at least 16 bytes long, so the low bits of their
+ *   addresses are dropped.
+ *
+ * @signature  volatile unsigned int* average_of(sem_t* sem)
+ *
+ * @param      sem semaphore to find the average of.
+ *
+ * @return     pointer to the entry of the table the semaphore lands on.
+ */
+volatile unsigned int* average_of(sem_t* sem)
+{
+    uintptr_t address = (uintptr_t) sem;
+    return &averageSpins[(address >> 4 ^ address >> 10)%SPIN_WAIT_TABLE_SIZE];
+}
+
+/**
+ * tells the cpu that this is a spin loop, so it can slow down the loop, and
+ *   give its resources to the other hardware thread of the core.
+ *
+ * @function   relax
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       does nothing on cpus without such an instruction.
+ *
+ * @signature  void relax()
+ */
+void relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
@@ -0,0 +1,59 @@
+/**
+ * header file for waiting on semaphores by spinning before sleeping.
+ *   implementation is in SpinWait.cpp
+ *
+ * @sourceFile SpinWait.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   LockBenchmark.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * most semaphores are held for a handful of instructions, like popping a task
+ *   off a vector, so a waiter that goes to sleep in the kernel right away
+ *   spends a lot longer getting woken up again than it would have waiting.
+ *   spin_wait first spins on the semaphore for a while, reading its value, and
+ *   only trying to take it once it is above 0, so spinning waiters do not pass
+ *   the cache line back, and forth. if it is still not free, it sleeps with
+ *   sem_wait, which waits on a futex in the semaphore, so posting to it only
+ *   enters the kernel if somebody sleeps on it.
+ *
+ * how long to spin is learned for every semaphore: the number of spins it took
+ *   to get the semaphore is averaged, and a waiter spins for up to twice that
+ *   plus SPIN_WAIT_MIN_SPINS, but never more than SPIN_WAIT_MAX_SPINS. every
+ *   time spinning fails, the average is halved, so a semaphore that is held
+ *   for long, or one that counts tasks rather than guarding memory, soon stops
+ *   being spun on. the averages are kept in a table of SPIN_WAIT_TABLE_SIZE
+ *   entries picked by the address of the semaphore; semaphores that land on
+ *   the same entry share an average. every process learns on its own.
+ *
+ * spinning only makes sense while the holder is running on another cpu, so
+ *   nothing is spun on a machine with a single cpu.
+ *
+ * since the semaphore is still a sem_t, it works between processes on shared
+ *   memory just like before, and can still be waited on with a timeout, or
+ *   read with sem_getvalue. spinning is off until spin_enable(true) is
+ *   called, so spin_wait is plain sem_wait by default; the mains turn it on
+ *   with --spin, and the lock benchmark uses it to compare the two.
+ */
+#ifndef SPINWAIT_H
+#define SPINWAIT_H
+
+#include <semaphore.h>
+
+#define SPIN_WAIT_TABLE_SIZE 64
+#define SPIN_WAIT_MIN_SPINS 16
+#define SPIN_WAIT_MAX_SPINS 4096
+
+void spin_enable(bool enabled);
+void spin_wait(sem_t* sem);
+
+#endif
@@ -0,0 +1,216 @@
+/**
+ * implementation of the TeeWriter class declared in TeeWriter.h
+ *
+ * @sourceFile TeeWriter.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   Coordinator-Main.out
+ *
+ * @class      TeeWriter
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ */
+#include "TeeWriter.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * instantiates a TeeWriter instance.
+ *
+ * @class      TeeWriter
+ *
+ * @method     TeeWriter
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the descriptors are not closed by the writer.
+ *
+ * @signature  TeeWriter::TeeWriter(int _first,int _second)
+ *
+ * @param      _first first file descriptor to write into.
+ * @param      _second second file descriptor to write into.
+ *
+ * @return     an instance of a TeeWriter.
+ */
+TeeWriter::TeeWriter(int _first,int _second)
+    :first(_first)
+    ,second(_second)
+{
+    buffer.reserve(TEE_BUFFER_SIZE);
+}
+
+/**
+ * destructor for the TeeWriter; flushes anything left in the buffer.
+ *
+ * @class      TeeWriter
+ *
+ * @method     ~TeeWriter
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  TeeWriter::~TeeWriter()
+ */
+TeeWriter::~TeeWriter()
+{
+    flush();
+}
+
+/**
+ * appends text to the buffer.
+ *
+ * @class      TeeWriter
+ *
+ * @method     append
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the buffer is flushed once it holds TEE_BUFFER_SIZE bytes.
+ *
+ * @signature  void TeeWriter::append(const char* text)
+ *
+ * @param      text null terminated text to append.
+ */
+void TeeWriter::append(const char* text)
+{
+    buffer.append(text);
+    if (buffer.size() >= TEE_BUFFER_SIZE)
+    {
+        flush();
+    }
+}
+
+/**
+ * appends a number in base 10 to the buffer.
+ *
+ * @class      TeeWriter
+ *
+ * @method     append_number
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the number is converted straight into the buffer.
+ *
+ * @signature  void TeeWriter::append_number(mpz_t number)
+ *
+ * @param      number number to append.
+ */
+void TeeWriter::append_number(mpz_t number)
+{
+    // mpz_sizeinbase may overestimate by one, and leaves out the sign, and the
+    // null terminator
+    size_t oldSize = buffer.size();
+    buffer.resize(oldSize+mpz_sizeinbase(number,10)+2);
+    mpz_get_str(&buffer[oldSize],10,number);
+    buffer.resize(oldSize+strlen(&buffer[oldSize]));
+    if (buffer.size() >= TEE_BUFFER_SIZE)
+    {
+        flush();
+    }
+}
+
+/**
+ * writes the buffer into both file descriptors, and empties it.
+ *
+ * @class      TeeWriter
+ *
+ * @method     flush
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the buffer is emptied even if a write fails.
+ *
+ * @signature  bool TeeWriter::flush()
+ *
+ * @return     true if the buffer was written into both descriptors; false
+ *   otherwise.
+ */
+bool TeeWriter::flush()
+{
+    bool written = write_all(first);
+    written = write_all(second) && written;
+    buffer.clear();
+    return written;
+}
+
+/**
+ * writes the whole buffer into a file descriptor.
+ *
+ * @class      TeeWriter
+ *
+ * @method     write_all
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       retries partial writes, and writes interrupted by signals.
+ *
+ * @signature  bool TeeWriter::write_all(int fd)
+ *
+ * @param      fd file descriptor to write into.
+ *
+ * @return     true if the whole buffer was written; false otherwise.
+ */
+bool TeeWriter::write_all(int fd)
+{
+    size_t offset = 0;
+    while(offset < buffer.size())
+    {
+        ssize_t written = write(fd,buffer.data()+offset,buffer.size()-offset);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            return false;
+        }
+        offset += written;
+    }
+    return true;
+}
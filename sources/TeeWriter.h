@@ -0,0 +1,55 @@
+/**
+ * header file for the TeeWriter class. implementation is in TeeWriter.cpp
+ *
+ * @sourceFile TeeWriter.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out,
+ *   Coordinator-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * buffered writer that writes everything appended to it into two file
+ *   descriptors; stdout, and the log file. text is only written when the
+ *   buffer fills up, or when flush is called, so each flush costs one write
+ *   per descriptor instead of a formatted print per number.
+ *
+ * flush only uses the write system call, so it may be called from a signal
+ *   handler. the caller is responsible for flushing any stdio streams on the
+ *   same descriptors first, so their output is not reordered.
+ */
+#ifndef TEEWRITER_H
+#define TEEWRITER_H
+
+#include <gmp.h>
+#include <string>
+
+#define TEE_BUFFER_SIZE 65536
+
+class TeeWriter
+{
+public:
+
+    TeeWriter(int _first,int _second);
+    ~TeeWriter();
+    void append(const char* text);
+    void append_number(mpz_t number);
+    bool flush();
+
+private:
+
+    bool write_all(int fd);
+
+    std::string buffer;
+    int first;
+    int second;
+};
+
+#endif
@@ -0,0 +1,509 @@
+/**
+ * implementation of the ThreadTransport class declared in ThreadTransport.h
+ *
+ * @sourceFile ThreadTransport.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Agent-Main.out
+ *
+ * @class      ThreadTransport
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * tasks are consumed in the order they are posted, so chunks complete roughly
+ *   in order, and the checkpoint frontier keeps advancing.
+ */
+#include "ThreadTransport.h"
+#include "Lock.h"
+#include "Contention.h"
+#include "Footprint.h"
+#include "GmpArena.h"
+#include "FindFactorsTask.h"
+#include <errno.h>
+#include <limits.h>
+
+/**
+ * instantiates a ThreadTransport instance.
+ *
+ * @class      ThreadTransport
+ *
+ * @method     ThreadTransport
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       no threads are created until start is called. the engine waits
+ *   for the job of the number in the options with finish, so its chunksLeft
+ *   never runs out.
+ *
+ * @signature  ThreadTransport::ThreadTransport(EngineOptions* _options,
+ *   ResultCollector* _collector)
+ *
+ * @param      _options options of the run.
+ * @param      _collector collector that the workers pass the results of the
+ *   number in the options to; 0 if only jobs are posted.
+ *
+ * @return     an instance of a ThreadTransport.
+ */
+ThreadTransport::ThreadTransport(EngineOptions* _options,ResultCollector* _collector)
+    :options(_options)
+    ,metrics(_options->numWorkers)
+    ,timeline(_options->numWorkers,_options->tracePath != 0)
+    ,job(_collector)
+    ,nextWorker(0)
+    ,cancelled(0)
+    ,taskAccess(false,1)
+    ,tasksNotFullSem(false,_options->numWorkers*MAX_PENDING_TASKS_PER_WORKER)
+    ,tasksAvailableSem(false,0)
+{
+    mpz_set(job.subject.value,options->prime.value);
+    job.chunksLeft = ULONG_MAX;
+    contention_name(&taskAccess.sem,"taskAccess");
+    contention_name(&tasksNotFullSem.sem,"tasksNotFullSem");
+    contention_name(&tasksAvailableSem.sem,"tasksAvailableSem");
+    footprint_watch_queue("task queue",&tasksNotFullSem.sem,options->numWorkers*MAX_PENDING_TASKS_PER_WORKER);
+}
+
+/**
+ * destructor for the ThreadTransport.
+ *
+ * @class      ThreadTransport
+ *
+ * @method     ~ThreadTransport
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       stops the task queue from being reported, since it goes away
+ *   with the transport.
+ *
+ * @signature  ThreadTransport::~ThreadTransport()
+ */
+ThreadTransport::~ThreadTransport()
+{
+    footprint_unwatch();
+}
+
+/**
+ * creates the worker threads.
+ *
+ * @class      ThreadTransport
+ *
+ * @method     start
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool ThreadTransport::start()
+ *
+ * @return     true if all the workers were created; false otherwise.
+ */
+bool ThreadTransport::start()
+{
+    for(register unsigned int i = 0; i < options->numWorkers; ++i)
+    {
+        pthread_t worker;
+        int error = pthread_create(&worker,0,worker_routine,this);
+        if (error != 0)
+        {
+            errno = error;
+            return false;
+        }
+        workers.push_back(worker);
+    }
+    return true;
+}
+
+/**
+ * inserts a task into the tasks queue once there is room for it.
+ *
+ * @class      ThreadTransport
+ *
+ * @method     post
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the chunk is part of the job of the number in the options.
+ *
+ * @signature  bool ThreadTransport::post(unsigned long chunk)
+ *
+ * @param      chunk index of the chunk to find the factors in.
+ *
+ * @return     true.
+ */
+bool ThreadTransport::post(unsigned long chunk)
+{
+    return post(&job,chunk);
+}
+
+/**
+ * inserts a task for a chunk of the passed job into the tasks queue once
+ *   there is room for it.
+ *
+ * @class      ThreadTransport
+ *
+ * @method     post
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the job must stay alive until its last chunk is completed.
+ *
+ * @signature  bool ThreadTransport::post(Job* job,unsigned long chunk)
+ *
+ * @param      job job that the chunk is part of.
+ * @param      chunk index of the chunk to find the factors in.
+ *
+ * @return     true.
+ */
+bool ThreadTransport::post(Job* job,unsigned long chunk)
+{
+    std::vector<Job*> jobs(1,job);
+    return post(&jobs,chunk);
+}
+
+/**
+ * inserts a task for the same chunk of several jobs into the tasks queue once
+ *   there is room for it.
+ *
+ * @class      ThreadTransport
+ *
+ * @method     post
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the task takes up one place in the queue no matter how many jobs
+ *   it is for. the jobs must stay alive until their last chunk is completed.
+ *
+ * @signature  bool ThreadTransport::post(std::vector<Job*>* jobs,
+ *   unsigned long chunk)
+ *
+ * @param      jobs jobs that the chunk is part of.
+ * @param      chunk index of the chunk to find the factors in.
+ *
+ * @return     true.
+ */
+bool ThreadTransport::post(std::vector<Job*>* jobs,unsigned long chunk)
+{
+    ThreadTask task;
+    task.jobs = *jobs;
+    task.chunk = chunk;
+
+    unsigned long long waitStart = WorkerMetrics::now();
+    tasksNotFullSem.wait();
+    unsigned long long lockStart = WorkerMetrics::now();
+    metrics.add(metrics.get_producer(),METRIC_NOT_FULL_WAIT_NS,lockStart-waitStart);
+    {
+        Lock scopelock(&taskAccess.sem);
+        unsigned long long lockEnd = WorkerMetrics::now();
+        metrics.add(metrics.get_producer(),METRIC_TASK_WAIT_NS,lockEnd-lockStart);
+        timeline.record(timeline.get_producer(),SPAN_TASK_LOCK,lockStart,lockEnd,TIMELINE_NO_CHUNK);
+        tasks.push_back(task);
+    }
+    tasksAvailableSem.post();
+    timeline.record(timeline.get_producer(),SPAN_DISPATCH,waitStart,WorkerMetrics::now(),chunk);
+    return true;
+}
+
+/**
+ * wakes up the workers once for each of them, so they see there are no more
+ *   tasks once the queue is empty, and joins them.
+ *
+ * @class      ThreadTransport
+ *
+ * @method     finish
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool ThreadTransport::finish()
+ *
+ * @return     true.
+ */
+bool ThreadTransport::finish()
+{
+    for(register unsigned int i = 0; i < workers.size(); ++i)
+    {
+        tasksAvailableSem.post();
+    }
+    for(register unsigned int i = 0; i < workers.size(); ++i)
+    {
+        pthread_join(workers[i],0);
+    }
+    workers.clear();
+    return true;
+}
+
+/**
+ * returns the flag that cancels the tasks of the workers once it is set.
+ *
+ * @class      ThreadTransport
+ *
+ * @method     get_cancel_flag
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the flag may be set from any thread.
+ *
+ * @signature  volatile int* ThreadTransport::get_cancel_flag()
+ *
+ * @return     pointer to the cancellation flag.
+ */
+volatile int* ThreadTransport::get_cancel_flag()
+{
+    return &cancelled;
+}
+
+/**
+ * returns the counters of the workers.
+ *
+ * @class      ThreadTransport
+ *
+ * @method     get_metrics
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the counters may be read while the workers are running.
+ *
+ * @signature  WorkerMetrics* ThreadTransport::get_metrics()
+ *
+ * @return     pointer to the metrics of the workers.
+ */
+WorkerMetrics* ThreadTransport::get_metrics()
+{
+    return &metrics;
+}
+
+/**
+ * returns the spans recorded by the workers, and the producer.
+ *
+ * @class      ThreadTransport
+ *
+ * @method     get_timeline
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       spans are only recorded with --trace, and must not be written
+ *   until finish returns.
+ *
+ * @signature  Timeline* ThreadTransport::get_timeline()
+ *
+ * @return     pointer to the timeline of the workers.
+ */
+Timeline* ThreadTransport::get_timeline()
+{
+    return &timeline;
+}
+
+/**
+ * routine executed by worker threads.
+ *
+ * @class      ThreadTransport
+ *
+ * @method     worker_routine
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * continuously reads tasks from the tasks queue, executes them, and passes
+ *   the results to the collector of their job. the worker that completes the
+ *   last chunk of a job posts its doneSem. the factors of every job of a task
+ *   are found by a single FindFactorsTask.
+ *
+ * once there are no more tasks to execute, the thread terminates.
+ *
+ * the time spent waiting for a task to be posted is counted as idle, and the
+ *   time spent passing the results to the collectors, which includes waiting
+ *   for their locks, as waiting on results. the latency of a task is from when
+ *   it is taken off the queue, to when its results are passed on.
+ *
+ * @signature  void* ThreadTransport::worker_routine(void* transport)
+ *
+ * @param      transport pointer to the ThreadTransport.
+ */
+void* ThreadTransport::worker_routine(void* transport)
+{
+    ThreadTransport* self = (ThreadTransport*) transport;
+    unsigned int worker = __sync_fetch_and_add(&self->nextWorker,1);
+    WorkerMetrics* metrics = &self->metrics;
+    Timeline* timeline = &self->timeline;
+
+    while(true)
+    {
+        ThreadTask task;
+
+        // get the next task that needs processing
+        unsigned long long idleStart = WorkerMetrics::now();
+        self->tasksAvailableSem.wait();
+        unsigned long long lockStart = WorkerMetrics::now();
+        metrics->add(worker,METRIC_IDLE_NS,lockStart-idleStart);
+        timeline->record(worker,SPAN_IDLE,idleStart,lockStart,TIMELINE_NO_CHUNK);
+        {
+            Lock scopelock(&self->taskAccess.sem);
+            unsigned long long lockEnd = WorkerMetrics::now();
+            metrics->add(worker,METRIC_TASK_WAIT_NS,lockEnd-lockStart);
+            timeline->record(worker,SPAN_TASK_LOCK,lockStart,lockEnd,TIMELINE_NO_CHUNK);
+            if (self->tasks.empty())
+            {
+                break;
+            }
+            task = self->tasks.front();
+            self->tasks.pop_front();
+        }
+        self->tasksNotFullSem.post();
+        unsigned long chunk = task.chunk;
+
+        // gather the numbers of the jobs; no candidate above the largest one
+        // can divide any of them
+        std::vector<mpz_t*> subjects;
+        Number* largest = &task.jobs[0]->subject;
+        for(register unsigned int i = 0; i < task.jobs.size(); ++i)
+        {
+            subjects.push_back(&task.jobs[i]->subject.value);
+            if (mpz_cmp(task.jobs[i]->subject.value,largest->value) > 0)
+            {
+                largest = &task.jobs[i]->subject;
+            }
+        }
+
+        // calculate the bounds of the chunk
+        Number loBound;
+        Number hiBound;
+        mpz_set_ui(loBound.value,chunk);
+        mpz_mul_ui(loBound.value,loBound.value,self->options->chunkSize);
+        mpz_add_ui(loBound.value,loBound.value,1);
+        mpz_add_ui(hiBound.value,loBound.value,self->options->chunkSize-1);
+        if (mpz_cmp(hiBound.value,largest->value) > 0)
+        {
+            mpz_set(hiBound.value,largest->value);
+        }
+
+        // do the processing. the results of a cancelled task are incomplete,
+        // so they are dropped
+        FindFactorsTask newTask(&subjects,hiBound.value,loBound.value);
+        newTask.set_cancel_flag(&self->cancelled);
+        unsigned long long executeStart = WorkerMetrics::now();
+        bool completed = newTask.execute();
+        unsigned long long executeEnd = WorkerMetrics::now();
+        metrics->add(worker,METRIC_EXECUTE_NS,executeEnd-executeStart);
+        timeline->record(worker,SPAN_EXECUTE,executeStart,executeEnd,chunk);
+        if (!completed)
+        {
+            continue;
+        }
+
+        // post results of the task to each job
+        Number candidates;
+        mpz_sub(candidates.value,hiBound.value,loBound.value);
+        mpz_add_ui(candidates.value,candidates.value,1);
+        unsigned long hits = 0;
+        for(register unsigned int i = 0; i < task.jobs.size(); ++i)
+        {
+            Job* job = task.jobs[i];
+            std::vector<Number*> factors;
+            std::vector<mpz_t*>* taskResults = newTask.get_results(i);
+            hits += taskResults->size();
+            for(register unsigned int j = 0; j < taskResults->size(); ++j)
+            {
+                Number* numPtr = new Number();
+                mpz_set(numPtr->value,*taskResults->at(j));
+                factors.push_back(numPtr);
+            }
+            job->collector->chunk_done(worker,chunk,&factors);
+
+            if (__sync_sub_and_fetch(&job->chunksLeft,1) == 0)
+            {
+                job->endTime = current_timestamp();
+                job->doneSem.post();
+            }
+        }
+
+        unsigned long long taskEnd = WorkerMetrics::now();
+        metrics->add(worker,METRIC_RESULT_WAIT_NS,taskEnd-executeEnd);
+        timeline->record(worker,SPAN_PUBLISH,executeEnd,taskEnd,chunk);
+        metrics->add(worker,METRIC_TASKS,1);
+        if (mpz_sgn(candidates.value) > 0)
+        {
+            metrics->add(worker,METRIC_CANDIDATES,mpz_get_ui(candidates.value)*task.jobs.size());
+        }
+        metrics->add(worker,METRIC_HITS,hits);
+        metrics->add_latency(worker,taskEnd-lockStart);
+        gmp_arena_task_done();
+    }
+
+    gmp_arena_thread_done();
+    return 0;
+}
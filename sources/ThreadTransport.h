@@ -0,0 +1,92 @@
+/**
+ * header file for the ThreadTransport class. implementation is in
+ *   ThreadTransport.cpp
+ *
+ * @sourceFile ThreadTransport.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Agent-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * transport of the threads backend. chunks are passed to a pool of worker
+ *   threads through a queue, and the workers pass their results straight to
+ *   the collector. see Engine.h for what a transport does.
+ *
+ * each task refers to the job it is part of, so the same pool can work on
+ *   more than one number at a time, as in batch mode. chunks posted with just
+ *   their index are part of the job of the number in the options. a task may
+ *   also be for the same chunk of several jobs, whose factors are then found
+ *   together.
+ *
+ * once the cancellation flag is set, the workers stop the task they are on,
+ *   and skip the tasks left in the queue; none of their results are passed to
+ *   the collectors.
+ *
+ * each worker counts its tasks, and the time it spends executing them, and
+ *   waiting into its slot of the metrics. the thread that posts the tasks
+ *   counts into the producer slot. with --trace, they also record what they
+ *   spend their time on into their slots of the timeline.
+ */
+#ifndef THREADTRANSPORT_H
+#define THREADTRANSPORT_H
+
+#include <deque>
+#include <vector>
+#include <pthread.h>
+#include "Engine.h"
+#include "Semaphore.h"
+#include "Timeline.h"
+#include "WorkerMetrics.h"
+#include "ResultCollector.h"
+
+/**
+ * a chunk waiting in the tasks queue, and the jobs it is checked for. the
+ *   factors of all the jobs are found at once.
+ */
+struct ThreadTask
+{
+    std::vector<Job*> jobs;
+    unsigned long chunk;
+};
+
+class ThreadTransport
+{
+public:
+
+    ThreadTransport(EngineOptions* _options,ResultCollector* _collector);
+    ~ThreadTransport();
+    bool start();
+    bool post(unsigned long chunk);
+    bool post(Job* job,unsigned long chunk);
+    bool post(std::vector<Job*>* jobs,unsigned long chunk);
+    bool finish();
+    volatile int* get_cancel_flag();
+    WorkerMetrics* get_metrics();
+    Timeline* get_timeline();
+
+private:
+
+    static void* worker_routine(void* transport);
+
+    EngineOptions* options;
+    WorkerMetrics metrics;
+    Timeline timeline;
+    Job job;
+    std::deque<ThreadTask> tasks;
+    std::vector<pthread_t> workers;
+    unsigned int nextWorker;
+    volatile int cancelled;
+    Semaphore taskAccess;
+    Semaphore tasksNotFullSem;
+    Semaphore tasksAvailableSem;
+};
+
+#endif
@@ -1,10 +1,75 @@
 /**
  * the threaded version of the program.
  *
- * usage: ./Threads-Main [integer] [log file]
+ * usage: ./Threads-Main [-s|--stream] [-m|--memory-budget bytes[k|m|g]]
+ *   [-c|--checkpoint file] [--resume] [--cache file] [--no-analysis]
+ *   [--count] [--sigma] [--range a b] [--first-factor] [--deadline ms]
+ *   [--chunk-size n] [--metrics file] [--trace file] [--footprint]
+ *   [--gmp-arena] [--spin] [integer] [log file] [num workers]
+ *        ./Threads-Main [-m|--memory-budget bytes[k|m|g]] [--cache file]
+ *   [--no-analysis] [--chunk-size n] [--metrics file] [--trace file]
+ *   [--footprint] [--gmp-arena] [--spin] --batch file|- [log file]
+ *   [num workers]
  *
  * finds all the factors of the passed integer.
  *
+ * with -c, progress is periodically saved to the checkpoint file. with
+ *   --resume, the run continues from the progress saved in the checkpoint file.
+ *
+ * with -s, each factor is printed on a line of its own as soon as all the
+ *   factors below it are known, instead of all together at the end. progress
+ *   is printed to stderr instead of stdout.
+ *
+ * with -m, once the factors found take up more memory than the budget, they
+ *   are spilled to temporary files, and merged back when they are printed.
+ *
+ * with --batch, the factors of every integer in the file, one per line, are
+ *   found using the same workers, and printed in the order of the file, each
+ *   with its runtime. - reads the integers from stdin. an integer may be
+ *   followed by a priority from 1 to 16; while integers share the workers,
+ *   each gets a share of them in proportion to its priority.
+ *
+ * with --cache, the factorization of the integer is looked up in the cache
+ *   file first, and the workers are only started if it is not there; it is
+ *   added to the cache once its factors are found. the cache file can be
+ *   shared by any number of runs at the same time.
+ *
+ * the small primes of the integer are divided out, and what is left is
+ *   checked for being a prime, or a prime power first; if that finds all of
+ *   its primes, no workers are started. --no-analysis turns this off.
+ *
+ * with --count, or --sigma, only the number of factors, or their sum is
+ *   printed; the factors are not kept. with --range, only the factors from a
+ *   to b are found. they can be used together, and cannot be used with -c.
+ *
+ * with --first-factor, only the smallest factor above 1 is printed, and the
+ *   workers stop as soon as it is known. with --deadline, the workers stop once
+ *   the time limit in milliseconds is up, and the factors found so far are
+ *   printed, with how far the search got.
+ *
+ * --chunk-size sets how many candidates are in each task handed to a worker.
+ *
+ * with --metrics, the counters of every worker, and a histogram of its task
+ *   latencies are dumped to the file at exit, and every second while a single
+ *   integer is searched; as json if the file name ends in .json, or as
+ *   OpenMetrics text otherwise.
+ *
+ * with --trace, what every worker, the thread that posts the tasks, and the
+ *   progress reporter spent their time on is written to the file at exit as a
+ *   Chrome trace, which can be opened in chrome://tracing, or
+ *   ui.perfetto.dev.
+ *
+ * with --footprint, every progress line is followed by the memory the run
+ *   takes up, which is printed once more at exit: the resident, and
+ *   proportional set size of the program, the bytes allocated by GMP, the
+ *   bytes of the factors held in memory, and how full the task queue is.
+ *
+ * with --gmp-arena, GMP allocates its numbers from pools kept by every worker
+ *   thread, instead of from malloc, and the pools are trimmed between tasks.
+ *
+ * with --spin, the locks, and semaphores shared by the workers are spun on for
+ *   a while before sleeping on them, instead of only sleeping; see SpinWait.h.
+ *
  * anything that is printed to stdout is also printed to the specified file.
  *
  * @sourceFile Threads-Main.cpp
@@ -19,67 +84,11 @@
  *
  * @programmer Eric Tsang
  *
- * @note       none
+ * @note       same as Factors-Main.out with the threads backend.
  */
-#include <vector>
-#include <fcntl.h>
-#include <stdio.h>
-#include <unistd.h>
-#include <pthread.h>
-#include <algorithm>
-#include <sys/stat.h>
-#include <sys/time.h>
-#include "Lock.h"
-#include "Number.h"
-#include "Semaphore.h"
-#include "FindFactorsTask.h"
-
-#define MAX_PENDING_TASKS_PER_WORKER 10
-#define MAX_NUMBERS_PER_TASK 10000
-
-long current_timestamp();
-void* worker_routine(void*);
-int main(int,char**);
-
-/**
- * number to find all the factors of.
- */
-Number prime;
-
-/**
- * vector used to store all the serialized tasks produced by the main thread,
- *   and consumed by worker threads.
- */
-std::vector<Number*> tasks;
-
-/**
- * vector used to store all the results tasks produced by the worker threads,
- *   and consumed by main thread.
- */
-std::vector<Number*> results;
-
-/**
- * set to true once all tasks have been produced by the main thread, so worker
- *   threads know that there are no more tasks to consume once the tasks vector
- *   is empty, and this flag is set to true.
- */
-bool allTasksProduced = false;
-
-/**
- * mutex used to ensure mutual access to the tasks vector.
- */
-Semaphore taskAccess(false,1);
-
-/**
- * mutex used to ensure that there is only a maximum of MAX_PENDING_TASKS tasks
- *   in the tasks vector at any time.
- */
-Semaphore tasksNotFullSem(false,0);
-
-/**
- * mutex used to ensure mutual access to the results vector.
- */
-Semaphore resultAccess(false,1);
+#include "Engine.h"
+#include "BatchRunner.h"
+#include "ThreadTransport.h"
 
 /**
  * entry point of the program.
@@ -96,9 +105,9 @@ Semaphore resultAccess(false,1);
  *
  * @note
  *
- * sets up synchronization primitives, spawns worker threads, generates tasks
- *   for workers, receives results from workers, waits for workers to terminate,
- *   writes results to a file, and stdout.
+ * spawns worker threads, generates tasks for workers, receives results from
+ *   workers, waits for workers to terminate, writes results to a file, and
+ *   stdout.
  *
  * @signature  int main(int argc,char** argv)
  *
@@ -109,235 +118,23 @@ Semaphore resultAccess(false,1);
  */
 int main(int argc,char** argv)
 {
-    // parse command line arguments
-    if (argc != 4)
-    {
-        fprintf(stderr,"usage: %s [integer] [path to log file] [num workers]\n",argv[0]);
-        return 1;
-    }
-    if(mpz_set_str(prime.value,argv[1],10) == -1)
-    {
-        fprintf(stderr,"usage: %s [integer] [path to log file] [num workers]\n",argv[0]);
-        return 1;
-    }
-    int logfile = open(argv[2],O_CREAT|O_WRONLY|O_APPEND);
-    FILE* logFileOut = fdopen(logfile,"w");
-    if(logfile == -1 || errno)
+    EngineOptions options;
+    if (!parse_options(argc,argv,"threads",&options))
     {
-        fprintf(stderr,"usage: %s [integer] [path to log file] [num workers]\nerror occurred: ",argv[0]);
-        perror(0);
         return 1;
     }
-    unsigned int numWorkers = atoi(argv[3]);
-    if (numWorkers <= 0)
-    {
-        fprintf(stderr,"usage: %s [integer] [path to log file] [num workers]\n num workers must be larger than or equal to 1",argv[0]);
-        return 1;
-    }
-
-    // set up synchronization primitives
-    for(register unsigned int i; i < numWorkers*MAX_PENDING_TASKS_PER_WORKER; ++i)
-    {
-        tasksNotFullSem.post();
-    }
-
-    // get start time
-    long startTime = current_timestamp();
 
-    // create the worker threads
-    std::vector<pthread_t> workers;
-    for(register unsigned int i = 0; i < numWorkers; ++i)
+    int status;
+    if (options.batchPath != 0)
     {
-        pthread_t worker;
-        pthread_create(&worker,0,worker_routine,0);
-        workers.push_back(worker);
+        BatchRunner runner(&options);
+        status = runner.run();
     }
-
-    // create tasks and place them into the tasks vector
+    else
     {
-        Number prevPercentageComplete;
-        Number percentageComplete;
-        Number tempLoBound;
-        Number loBound;
-
-        for(mpz_set_ui(loBound.value,1);
-            mpz_cmp(loBound.value,prime.value) <= 0;
-            mpz_add_ui(loBound.value,loBound.value,MAX_NUMBERS_PER_TASK))
-        {
-            // calculate and print percentage complete
-            mpz_set(prevPercentageComplete.value,percentageComplete.value);
-            mpz_mul_ui(tempLoBound.value,loBound.value,100);
-            mpz_div(percentageComplete.value,tempLoBound.value,prime.value);
-            if(mpz_cmp(prevPercentageComplete.value,percentageComplete.value) != 0)
-            {
-                gmp_fprintf(stdout,"%Zd%\n",percentageComplete.value);
-                gmp_fprintf(logFileOut,"%Zd%\n",percentageComplete.value);
-            }
-
-            // insert the task into the task queue once there is room
-            Number* newNum = new Number();
-            mpz_set(newNum->value,loBound.value);
-            tasksNotFullSem.wait();
-            Lock scopelock(&taskAccess.sem);
-            tasks.push_back(newNum);
-        }
+        status = run_engine<ThreadTransport>(&options);
     }
-    allTasksProduced = true;
-
-    // join all worker threads
-    for(register unsigned int i = 0; i < numWorkers; ++i)
-    {
-        void* unused;
-        pthread_join(workers[i],&unused);
-    }
-
-    // get end time
-    long endTime = current_timestamp();
 
-    // print out calculation results
-    std::sort(results.begin(),results.end(),[](Number* i,Number* j)
-    {
-        return mpz_cmp(i->value,j->value) < 0;
-    });
-    fprintf(stdout,"factors: ");
-    fprintf(logFileOut,"factors: ");
-    for(register unsigned int i = 0; i < results.size(); ++i)
-    {
-        gmp_fprintf(stdout,"%s%Zd",i?", ":"",results[i]->value);
-        gmp_fprintf(logFileOut,"%s%Zd",i?", ":"",results[i]->value);
-        delete results[i];
-    }
-    fprintf(stdout,"\n");
-    fprintf(logFileOut,"\n");
-
-    // print out execution results
-    fprintf(stdout,"total runtime: %lums\n",endTime-startTime);
-    fprintf(logFileOut,"total runtime: %lums\n",endTime-startTime);
-
-    // release system resources
-    fclose(logFileOut);
-    close(logfile);
-
-    return 0;
-}
-
-/**
- * routine executed by worker threads.
- *
- * @function   worker_routine
- *
- * @date       2016-01-15
- *
- * @revision   none
- *
- * @designer   Eric Tsang
- *
- * @programmer Eric Tsang
- *
- * @note
- *
- * continuously reads tasks from the tasks vector, executes them, and writes the
- *   results to the results pipe for the parent to receive.
- *
- * once there are no more tasks to execute, the thread terminates.
- *
- * @signature  void* worker_routine(void*)
- */
-void* worker_routine(void*)
-{
-    bool yield = false;
-
-    while(true)
-    {
-        if (yield)
-        {
-            pthread_yield();
-            yield = false;
-        }
-        Number* loBoundPtr;
-
-        // get the next task that needs processing
-        {
-            Lock scopelock(&taskAccess.sem);
-
-            // if there are tasks available to get, get them
-            if(!tasks.empty())
-            {
-                loBoundPtr = tasks.back();
-                tasks.pop_back();
-            }
-
-            // otherwise, if there are tasks available in the future, wait for
-            // them to be available
-            else if(!allTasksProduced)
-            {
-                yield = true;
-                continue;
-            }
-
-            // otherwise, there are no more tasks, end the loop
-            else
-            {
-                break;
-            }
-        }
-        tasksNotFullSem.post();
-
-        // calculate the hiBound for a task
-        Number hiBound;
-        mpz_add_ui(hiBound.value,loBoundPtr->value,MAX_NUMBERS_PER_TASK-1);
-        if(mpz_cmp(hiBound.value,prime.value) > 0)
-        {
-            mpz_set(hiBound.value,prime.value);
-        }
-
-        // create the task
-        FindFactorsTask newTask(prime.value,hiBound.value,loBoundPtr->value);
-
-        // do the processing
-        newTask.execute();
-
-        // post results of the tasks
-        {
-            Lock scopelock(&resultAccess.sem);
-
-            std::vector<mpz_t*>* taskResults = newTask.get_results();
-            for(register unsigned int i = 0; i < taskResults->size(); ++i)
-            {
-                Number* numPtr = new Number();
-                mpz_set(numPtr->value,*taskResults->at(i));
-                results.push_back(numPtr);
-            }
-        }
-
-        delete loBoundPtr;
-    }
-
-    pthread_exit(0);
-}
-
-/**
- * returns the current system time in milliseconds.
- *
- * @function   current_timestamp
- *
- * @date       2016-01-15
- *
- * @revision   none
- *
- * @designer   Eric Tsang
- *
- * @programmer Eric Tsang
- *
- * @note       none
- *
- * @signature  long current_timestamp()
- *
- * @return     current system time in milliseconds.
- */
-long current_timestamp()
-{
-    struct timeval te;
-    gettimeofday(&te, NULL); // get current time
-    return te.tv_sec*1000L + te.tv_usec/1000; // caculate milliseconds
+    fclose(options.logFileOut);
+    return status;
 }
@@ -0,0 +1,328 @@
+/**
+ * implementation of the Timeline class declared in Timeline.h
+ *
+ * @sourceFile Timeline.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @class      Timeline
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * a span is written into its slot before the count is raised past it, so
+ *   a slot never counts a span that is not written yet. spans are only read
+ *   by write, once the workers are done.
+ *
+ * times in the trace are in microseconds since the timeline was made.
+ */
+#include "Timeline.h"
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+static void write_slot_name(FILE* out,unsigned int slot,unsigned int numWorkers,pid_t pid);
+
+/**
+ * names of the spans, indexed by the SPAN_ defines.
+ */
+static const char* spanNames[NUM_SPANS] =
+{
+    "dispatch",
+    "idle",
+    "task lock wait",
+    "execute",
+    "publish",
+    "result lock wait",
+    "progress"
+};
+
+/**
+ * instantiates a Timeline instance.
+ *
+ * @class      Timeline
+ *
+ * @method     Timeline
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the slots are mapped as shared memory, so processes forked after
+ *   this record into the same slots. if the mapping fails, nothing is
+ *   recorded, and write fails.
+ *
+ * @signature  Timeline::Timeline(unsigned int _numWorkers,bool enabled)
+ *
+ * @param      _numWorkers number of workers; extra slots are made for the
+ *   producer, and the reporter.
+ * @param      enabled true if spans are to be recorded.
+ *
+ * @return     an instance of a Timeline.
+ */
+Timeline::Timeline(unsigned int _numWorkers,bool enabled)
+    :numWorkers(_numWorkers)
+    ,origin(WorkerMetrics::now())
+    ,slots(0)
+{
+    if (enabled)
+    {
+        slots = (TimelineSlot*) mmap(0,(numWorkers+2)*sizeof(TimelineSlot),PROT_READ|PROT_WRITE,
+            MAP_SHARED|MAP_ANONYMOUS,-1,0);
+        if (slots == MAP_FAILED)
+        {
+            slots = 0;
+        }
+    }
+}
+
+/**
+ * destructor for the Timeline.
+ *
+ * @class      Timeline
+ *
+ * @method     ~Timeline
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  Timeline::~Timeline()
+ */
+Timeline::~Timeline()
+{
+    if (slots != 0)
+    {
+        munmap(slots,(numWorkers+2)*sizeof(TimelineSlot));
+    }
+}
+
+/**
+ * records a span of a worker.
+ *
+ * @class      Timeline
+ *
+ * @method     record
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must only be called by the owner of the slot. does nothing if
+ *   the timeline is not enabled.
+ *
+ * @signature  void Timeline::record(unsigned int worker,unsigned int span,
+ *   unsigned long long start,unsigned long long end,unsigned long chunk)
+ *
+ * @param      worker slot of the worker, get_producer, or get_reporter.
+ * @param      span one of the SPAN_ defines.
+ * @param      start time the span started at, from WorkerMetrics::now.
+ * @param      end time the span ended at, from WorkerMetrics::now.
+ * @param      chunk chunk the span was spent on, or TIMELINE_NO_CHUNK.
+ */
+void Timeline::record(unsigned int worker,unsigned int span,unsigned long long start,unsigned long long end,unsigned long chunk)
+{
+    if (slots == 0)
+    {
+        return;
+    }
+    TimelineSlot* slot = &slots[worker];
+    unsigned long long count = __atomic_load_n(&slot->count,__ATOMIC_RELAXED);
+    if (count >= TIMELINE_SPANS)
+    {
+        ++slot->dropped;
+        return;
+    }
+    slot->spans[count].start = start;
+    slot->spans[count].end = end;
+    slot->spans[count].chunk = chunk;
+    slot->spans[count].span = span;
+    __atomic_store_n(&slot->count,count+1,__ATOMIC_RELEASE);
+}
+
+/**
+ * returns the slot of the thread that posts the tasks.
+ *
+ * @class      Timeline
+ *
+ * @method     get_producer
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       it is the slot after the last worker, as in the metrics.
+ *
+ * @signature  unsigned int Timeline::get_producer()
+ *
+ * @return     slot of the producer.
+ */
+unsigned int Timeline::get_producer()
+{
+    return numWorkers;
+}
+
+/**
+ * returns the slot of the thread that reports the progress.
+ *
+ * @class      Timeline
+ *
+ * @method     get_reporter
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       it is the slot after the producer.
+ *
+ * @signature  unsigned int Timeline::get_reporter()
+ *
+ * @return     slot of the reporter.
+ */
+unsigned int Timeline::get_reporter()
+{
+    return numWorkers+1;
+}
+
+/**
+ * writes every span to a file in the Chrome trace event format.
+ *
+ * @class      Timeline
+ *
+ * @method     write
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * every span is a complete ("X") event of the thread of its slot, with the
+ *   chunk it was spent on in its arguments. metadata events name the threads,
+ *   and keep them in the order of their slots. the number of spans dropped
+ *   from full slots is written in otherData.
+ *
+ * must only be called once the workers are done.
+ *
+ * @signature  bool Timeline::write(const char* path)
+ *
+ * @param      path path of the file.
+ *
+ * @return     true if the file was written; false otherwise, with errno set.
+ */
+bool Timeline::write(const char* path)
+{
+    if (slots == 0)
+    {
+        errno = ENOMEM;
+        return false;
+    }
+
+    FILE* out = fopen(path,"w");
+    if (out == 0)
+    {
+        return false;
+    }
+
+    pid_t pid = getpid();
+    unsigned long long dropped = 0;
+    fprintf(out,"{\"traceEvents\":[\n");
+    fprintf(out,"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"factors\"}}",pid);
+    for(register unsigned int i = 0; i < numWorkers+2; ++i)
+    {
+        write_slot_name(out,i,numWorkers,pid);
+        dropped += slots[i].dropped;
+        unsigned long long count = __atomic_load_n(&slots[i].count,__ATOMIC_ACQUIRE);
+        for(register unsigned long long j = 0; j < count; ++j)
+        {
+            TimelineSpan* span = &slots[i].spans[j];
+            fprintf(out,",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                spanNames[span->span],pid,i,(span->start-origin)/1e3,(span->end-span->start)/1e3);
+            if (span->chunk != TIMELINE_NO_CHUNK)
+            {
+                fprintf(out,",\"args\":{\"chunk\":%lu}",span->chunk);
+            }
+            fprintf(out,"}");
+        }
+    }
+    fprintf(out,"\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":%llu}}\n",dropped);
+
+    bool written = ferror(out) == 0;
+    return fclose(out) == 0 && written;
+}
+
+/**
+ * writes the metadata events that name the thread of a slot, and place it.
+ *
+ * @function   write_slot_name
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the producer, and the reporter are sorted before the workers.
+ *
+ * @signature  void write_slot_name(FILE* out,unsigned int slot,
+ *   unsigned int numWorkers,pid_t pid)
+ *
+ * @param      out file to write to.
+ * @param      slot slot of the thread.
+ * @param      numWorkers number of workers.
+ * @param      pid process id the events are written under.
+ */
+void write_slot_name(FILE* out,unsigned int slot,unsigned int numWorkers,pid_t pid)
+{
+    fprintf(out,",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"",pid,slot);
+    if (slot == numWorkers)
+    {
+        fprintf(out,"producer");
+    }
+    else if (slot == numWorkers+1)
+    {
+        fprintf(out,"reporter");
+    }
+    else
+    {
+        fprintf(out,"worker %u",slot);
+    }
+    fprintf(out,"\"}}");
+    fprintf(out,",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"sort_index\":%d}}",
+        pid,slot,slot >= numWorkers ? (int) (slot-numWorkers)-2 : (int) slot);
+}
@@ -0,0 +1,91 @@
+/**
+ * header file for the Timeline class. implementation is in Timeline.cpp
+ *
+ * @sourceFile Timeline.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * spans of time that the workers, the thread that posts the tasks, and the
+ *   reporter spent doing things, so they can be seen on a timeline. like the
+ *   metrics, each of them has a slot of its own, which only it writes to, so
+ *   recording a span never takes a lock, and the slots live in shared memory,
+ *   so worker processes record into the slots that the parent writes out.
+ *
+ * a slot holds up to TIMELINE_SPANS spans; any more are counted, but dropped.
+ *   spans are indexed by the SPAN_ defines, and their times are taken from
+ *   WorkerMetrics::now.
+ *
+ * write writes every span in the Chrome trace event format, which can be
+ *   opened in chrome://tracing, or ui.perfetto.dev. each slot is a thread of
+ *   its own, named after the worker.
+ *
+ * a timeline that is not enabled maps no memory, and records nothing.
+ */
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include "WorkerMetrics.h"
+
+#define SPAN_DISPATCH 0
+#define SPAN_IDLE 1
+#define SPAN_TASK_LOCK 2
+#define SPAN_EXECUTE 3
+#define SPAN_PUBLISH 4
+#define SPAN_RESULT_LOCK 5
+#define SPAN_PROGRESS 6
+#define NUM_SPANS 7
+
+#define TIMELINE_SPANS 65536
+#define TIMELINE_NO_CHUNK ((unsigned long) -1)
+
+/**
+ * a span of time spent doing one thing, on a chunk if it is not
+ *   TIMELINE_NO_CHUNK.
+ */
+struct TimelineSpan
+{
+    unsigned long long start;
+    unsigned long long end;
+    unsigned long chunk;
+    unsigned int span;
+};
+
+/**
+ * the spans of a worker, and how many of them there are.
+ */
+struct alignas(CACHE_LINE_SIZE) TimelineSlot
+{
+    unsigned long long count;
+    unsigned long long dropped;
+    TimelineSpan spans[TIMELINE_SPANS];
+};
+
+class Timeline
+{
+public:
+
+    Timeline(unsigned int _numWorkers,bool enabled);
+    ~Timeline();
+    void record(unsigned int worker,unsigned int span,unsigned long long start,unsigned long long end,unsigned long chunk);
+    unsigned int get_producer();
+    unsigned int get_reporter();
+    bool write(const char* path);
+
+private:
+
+    unsigned int numWorkers;
+    unsigned long long origin;
+    TimelineSlot* slots;
+};
+
+#endif
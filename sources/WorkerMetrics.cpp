@@ -0,0 +1,567 @@
+/**
+ * implementation of the WorkerMetrics class declared in WorkerMetrics.h
+ *
+ * @sourceFile WorkerMetrics.cpp
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @class      WorkerMetrics
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * a latency below WORKER_HISTOGRAM_SUB_BUCKETS nanoseconds has a bucket of its
+ *   own. above that, a latency whose highest set bit is bit m goes into one of
+ *   WORKER_HISTOGRAM_SUB_BUCKETS buckets for that bit, picked by the bits below
+ *   it, so the buckets of bit m are 2^(m-4) nanoseconds wide.
+ *
+ * a counter is only written by the worker that owns its slot, so it is
+ *   updated with a relaxed load, and store instead of a locked add. the dump
+ *   reads the counters while they are being written, so it may be a task
+ *   behind.
+ */
+#include "WorkerMetrics.h"
+#include <time.h>
+#include <errno.h>
+#include <string.h>
+#include <string>
+#include <sys/mman.h>
+
+static unsigned int bucket_of(unsigned long long ns);
+static unsigned long long bucket_limit(unsigned int bucket);
+static unsigned long long load(unsigned long long* counter);
+static void write_worker_label(FILE* out,unsigned int worker,unsigned int numWorkers);
+
+/**
+ * names of the counters, indexed by the METRIC_ defines, and whether they are
+ *   times in nanoseconds.
+ */
+static const char* metricNames[NUM_METRICS] =
+{
+    "tasks",
+    "candidates",
+    "hits",
+    "execute_seconds",
+    "task_wait_seconds",
+    "result_wait_seconds",
+    "not_full_wait_seconds",
+    "idle_seconds"
+};
+static const bool metricIsTime[NUM_METRICS] =
+{
+    false,false,false,true,true,true,true,true
+};
+static const char* metricHelp[NUM_METRICS] =
+{
+    "Tasks executed to completion.",
+    "Candidates tested, once for every number of a task.",
+    "Candidates that were factors.",
+    "Time spent in FindFactorsTask::execute.",
+    "Time blocked acquiring the lock of the task queue, or pipe.",
+    "Time blocked passing results back, or acquiring the lock of the feedback pipe.",
+    "Time blocked waiting for room in the task queue, or pipe.",
+    "Time waiting for a task to become available."
+};
+
+/**
+ * instantiates a WorkerMetrics instance.
+ *
+ * @class      WorkerMetrics
+ *
+ * @method     WorkerMetrics
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the slots are mapped as shared memory, so processes forked after
+ *   this count into the same slots. if the mapping fails, nothing is counted,
+ *   and dump fails.
+ *
+ * @signature  WorkerMetrics::WorkerMetrics(unsigned int _numWorkers)
+ *
+ * @param      _numWorkers number of workers; an extra slot is made for the
+ *   producer.
+ *
+ * @return     an instance of a WorkerMetrics.
+ */
+WorkerMetrics::WorkerMetrics(unsigned int _numWorkers)
+    :numWorkers(_numWorkers)
+{
+    slots = (WorkerSlot*) mmap(0,(numWorkers+1)*sizeof(WorkerSlot),PROT_READ|PROT_WRITE,
+        MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    if (slots == MAP_FAILED)
+    {
+        slots = 0;
+    }
+}
+
+/**
+ * destructor for the WorkerMetrics.
+ *
+ * @class      WorkerMetrics
+ *
+ * @method     ~WorkerMetrics
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  WorkerMetrics::~WorkerMetrics()
+ */
+WorkerMetrics::~WorkerMetrics()
+{
+    if (slots != 0)
+    {
+        munmap(slots,(numWorkers+1)*sizeof(WorkerSlot));
+    }
+}
+
+/**
+ * adds an amount to a counter of a worker.
+ *
+ * @class      WorkerMetrics
+ *
+ * @method     add
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must only be called by the owner of the slot.
+ *
+ * @signature  void WorkerMetrics::add(unsigned int worker,unsigned int metric,
+ *   unsigned long long amount)
+ *
+ * @param      worker slot of the worker, or get_producer.
+ * @param      metric one of the METRIC_ defines.
+ * @param      amount amount to add to the counter.
+ */
+void WorkerMetrics::add(unsigned int worker,unsigned int metric,unsigned long long amount)
+{
+    if (slots != 0)
+    {
+        unsigned long long* counter = &slots[worker].counters[metric];
+        __atomic_store_n(counter,load(counter)+amount,__ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * records the latency of a task in the histogram of a worker.
+ *
+ * @class      WorkerMetrics
+ *
+ * @method     add_latency
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       must only be called by the owner of the slot.
+ *
+ * @signature  void WorkerMetrics::add_latency(unsigned int worker,
+ *   unsigned long long ns)
+ *
+ * @param      worker slot of the worker.
+ * @param      ns latency of the task in nanoseconds.
+ */
+void WorkerMetrics::add_latency(unsigned int worker,unsigned long long ns)
+{
+    if (slots != 0)
+    {
+        unsigned long long* bucket = &slots[worker].latencies[bucket_of(ns)];
+        __atomic_store_n(bucket,load(bucket)+1,__ATOMIC_RELAXED);
+        __atomic_store_n(&slots[worker].latencySum,load(&slots[worker].latencySum)+ns,__ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * returns the slot of the thread that posts the tasks.
+ *
+ * @class      WorkerMetrics
+ *
+ * @method     get_producer
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       it is the slot after the last worker.
+ *
+ * @signature  unsigned int WorkerMetrics::get_producer()
+ *
+ * @return     slot of the producer.
+ */
+unsigned int WorkerMetrics::get_producer()
+{
+    return numWorkers;
+}
+
+/**
+ * writes every slot to a file.
+ *
+ * @class      WorkerMetrics
+ *
+ * @method     dump
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the slots are written to path.tmp, which is then renamed to the
+ *   path.
+ *
+ * @signature  bool WorkerMetrics::dump(const char* path)
+ *
+ * @param      path path of the file; json if it ends in .json, OpenMetrics
+ *   text otherwise.
+ *
+ * @return     true if the file was written; false otherwise, with errno set.
+ */
+bool WorkerMetrics::dump(const char* path)
+{
+    if (slots == 0)
+    {
+        errno = ENOMEM;
+        return false;
+    }
+
+    std::string tempPath = std::string(path)+".tmp";
+    FILE* out = fopen(tempPath.c_str(),"w");
+    if (out == 0)
+    {
+        return false;
+    }
+    size_t length = strlen(path);
+    if (length >= 5 && strcmp(path+length-5,".json") == 0)
+    {
+        write_json(out);
+    }
+    else
+    {
+        write_open_metrics(out);
+    }
+    bool written = ferror(out) == 0;
+    written = fclose(out) == 0 && written;
+    return written && rename(tempPath.c_str(),path) == 0;
+}
+
+/**
+ * returns the time of the monotonic clock.
+ *
+ * @class      WorkerMetrics
+ *
+ * @method     now
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       only differences between times are meaningful.
+ *
+ * @signature  unsigned long long WorkerMetrics::now()
+ *
+ * @return     time in nanoseconds.
+ */
+unsigned long long WorkerMetrics::now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC,&time);
+    return time.tv_sec*1000000000ULL+time.tv_nsec;
+}
+
+/**
+ * writes every slot as OpenMetrics text.
+ *
+ * @class      WorkerMetrics
+ *
+ * @method     write_open_metrics
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * every counter is a family of its own, with a sample for each slot labelled
+ *   by its worker. times are in seconds. the latency histogram only has a
+ *   bucket for the buckets that are not empty; their counts are cumulative, as
+ *   OpenMetrics requires.
+ *
+ * @signature  void WorkerMetrics::write_open_metrics(FILE* out)
+ *
+ * @param      out file to write to.
+ */
+void WorkerMetrics::write_open_metrics(FILE* out)
+{
+    for(register unsigned int m = 0; m < NUM_METRICS; ++m)
+    {
+        fprintf(out,"# TYPE factors_worker_%s counter\n",metricNames[m]);
+        fprintf(out,"# HELP factors_worker_%s %s\n",metricNames[m],metricHelp[m]);
+        for(register unsigned int i = 0; i <= numWorkers; ++i)
+        {
+            unsigned long long value = load(&slots[i].counters[m]);
+            fprintf(out,"factors_worker_%s_total",metricNames[m]);
+            write_worker_label(out,i,numWorkers);
+            if (metricIsTime[m])
+            {
+                fprintf(out," %.9f\n",value/1e9);
+            }
+            else
+            {
+                fprintf(out," %llu\n",value);
+            }
+        }
+    }
+
+    fprintf(out,"# TYPE factors_worker_task_latency_seconds histogram\n");
+    fprintf(out,"# HELP factors_worker_task_latency_seconds Time from taking a task to passing back its results.\n");
+    for(register unsigned int i = 0; i < numWorkers; ++i)
+    {
+        unsigned long long count = 0;
+        for(register unsigned int b = 0; b < WORKER_HISTOGRAM_BUCKETS; ++b)
+        {
+            unsigned long long inBucket = load(&slots[i].latencies[b]);
+            if (inBucket == 0)
+            {
+                continue;
+            }
+            count += inBucket;
+            fprintf(out,"factors_worker_task_latency_seconds_bucket{worker=\"%u\",le=\"%.9f\"} %llu\n",
+                i,bucket_limit(b)/1e9,count);
+        }
+        fprintf(out,"factors_worker_task_latency_seconds_bucket{worker=\"%u\",le=\"+Inf\"} %llu\n",i,count);
+        fprintf(out,"factors_worker_task_latency_seconds_count{worker=\"%u\"} %llu\n",i,count);
+        fprintf(out,"factors_worker_task_latency_seconds_sum{worker=\"%u\"} %.9f\n",i,
+            load(&slots[i].latencySum)/1e9);
+    }
+    fprintf(out,"# EOF\n");
+}
+
+/**
+ * writes every slot as json.
+ *
+ * @class      WorkerMetrics
+ *
+ * @method     write_json
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the output is an object with a "workers" array holding an object
+ *   for each slot. counters keep their names, and times stay in nanoseconds,
+ *   with _seconds replaced by _ns. the latency buckets are [upper limit in
+ *   nanoseconds, count] pairs of the buckets that are not empty; their counts
+ *   are not cumulative.
+ *
+ * @signature  void WorkerMetrics::write_json(FILE* out)
+ *
+ * @param      out file to write to.
+ */
+void WorkerMetrics::write_json(FILE* out)
+{
+    fprintf(out,"{\"workers\":[");
+    for(register unsigned int i = 0; i <= numWorkers; ++i)
+    {
+        fprintf(out,"%s\n  {\"worker\":",i == 0 ? "" : ",");
+        if (i == numWorkers)
+        {
+            fprintf(out,"\"producer\"");
+        }
+        else
+        {
+            fprintf(out,"%u",i);
+        }
+        for(register unsigned int m = 0; m < NUM_METRICS; ++m)
+        {
+            std::string name = metricNames[m];
+            if (metricIsTime[m])
+            {
+                name.replace(name.size()-7,7,"ns");
+            }
+            fprintf(out,",\"%s\":%llu",name.c_str(),load(&slots[i].counters[m]));
+        }
+        fprintf(out,",\"latency_sum_ns\":%llu,\"latency_buckets\":[",load(&slots[i].latencySum));
+        bool first = true;
+        for(register unsigned int b = 0; b < WORKER_HISTOGRAM_BUCKETS; ++b)
+        {
+            unsigned long long inBucket = load(&slots[i].latencies[b]);
+            if (inBucket != 0)
+            {
+                fprintf(out,"%s[%llu,%llu]",first ? "" : ",",bucket_limit(b),inBucket);
+                first = false;
+            }
+        }
+        fprintf(out,"]}");
+    }
+    fprintf(out,"\n]}\n");
+}
+
+/**
+ * returns the histogram bucket that a latency is recorded in.
+ *
+ * @function   bucket_of
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       see the top of this file for how the buckets are laid out.
+ *
+ * @signature  unsigned int bucket_of(unsigned long long ns)
+ *
+ * @param      ns latency in nanoseconds.
+ *
+ * @return     index of the bucket.
+ */
+unsigned int bucket_of(unsigned long long ns)
+{
+    if (ns < WORKER_HISTOGRAM_SUB_BUCKETS)
+    {
+        return ns;
+    }
+    unsigned int bit = 63-__builtin_clzll(ns);
+    return (bit-3)*WORKER_HISTOGRAM_SUB_BUCKETS+((ns>>(bit-4))&(WORKER_HISTOGRAM_SUB_BUCKETS-1));
+}
+
+/**
+ * returns the largest latency that is recorded in a bucket.
+ *
+ * @function   bucket_limit
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the inverse of bucket_of.
+ *
+ * @signature  unsigned long long bucket_limit(unsigned int bucket)
+ *
+ * @param      bucket index of the bucket.
+ *
+ * @return     largest latency of the bucket in nanoseconds.
+ */
+unsigned long long bucket_limit(unsigned int bucket)
+{
+    if (bucket < WORKER_HISTOGRAM_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    unsigned int bit = bucket/WORKER_HISTOGRAM_SUB_BUCKETS+3;
+    unsigned long long subBucket = bucket%WORKER_HISTOGRAM_SUB_BUCKETS;
+    return ((WORKER_HISTOGRAM_SUB_BUCKETS+subBucket+1)<<(bit-4))-1;
+}
+
+/**
+ * reads a counter that may be written by another thread, or process.
+ *
+ * @function   load
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  unsigned long long load(unsigned long long* counter)
+ *
+ * @param      counter counter to read.
+ *
+ * @return     value of the counter.
+ */
+unsigned long long load(unsigned long long* counter)
+{
+    return __atomic_load_n(counter,__ATOMIC_RELAXED);
+}
+
+/**
+ * writes the label of a slot of an OpenMetrics sample.
+ *
+ * @function   write_worker_label
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the producer is labelled "producer".
+ *
+ * @signature  void write_worker_label(FILE* out,unsigned int worker,
+ *   unsigned int numWorkers)
+ *
+ * @param      out file to write to.
+ * @param      worker slot of the sample.
+ * @param      numWorkers number of workers.
+ */
+void write_worker_label(FILE* out,unsigned int worker,unsigned int numWorkers)
+{
+    if (worker == numWorkers)
+    {
+        fprintf(out,"{worker=\"producer\"}");
+    }
+    else
+    {
+        fprintf(out,"{worker=\"%u\"}",worker);
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * header file for the WorkerMetrics class. implementation is in
+ *   WorkerMetrics.cpp
+ *
+ * @sourceFile WorkerMetrics.h
+ *
+ * @program    Factors-Main.out, Threads-Main.out, Processes-Main.out
+ *
+ * @date       2016-01-15
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note
+ *
+ * runtime counters of every worker, and of the thread that posts the tasks.
+ *   each of them has a slot of its own, which only it writes to, so counting
+ *   never takes a lock. slots are aligned to cache lines, so workers never
+ *   write to the same line, and live in shared memory, so worker processes
+ *   count into the same slots that the parent dumps.
+ *
+ * the counters are indexed by the METRIC_ defines. times are in nanoseconds,
+ *   taken from the monotonic clock by now.
+ *
+ * each slot also has a histogram of task latencies in the style of
+ *   HdrHistogram. every power of 2 is split into WORKER_HISTOGRAM_SUB_BUCKETS
+ *   buckets, so a latency is recorded to within about 6 percent of its value,
+ *   whatever its size.
+ *
+ * dump writes all the slots to a file, as json if its name ends in .json, or
+ *   as OpenMetrics text otherwise. the file is written beside its path, and
+ *   renamed over it, so it can be read while it is being updated.
+ */
+#ifndef WORKERMETRICS_H
+#define WORKERMETRICS_H
+
+#include <stdio.h>
+
+#define METRIC_TASKS 0
+#define METRIC_CANDIDATES 1
+#define METRIC_HITS 2
+#define METRIC_EXECUTE_NS 3
+#define METRIC_TASK_WAIT_NS 4
+#define METRIC_RESULT_WAIT_NS 5
+#define METRIC_NOT_FULL_WAIT_NS 6
+#define METRIC_IDLE_NS 7
+#define NUM_METRICS 8
+
+#define WORKER_HISTOGRAM_SUB_BUCKETS 16
+#define WORKER_HISTOGRAM_BUCKETS 976
+#define CACHE_LINE_SIZE 64
+
+/**
+ * the counters, and latency histogram of a worker.
+ */
+struct alignas(CACHE_LINE_SIZE) WorkerSlot
+{
+    unsigned long long counters[NUM_METRICS];
+    unsigned long long latencySum;
+    unsigned long long latencies[WORKER_HISTOGRAM_BUCKETS];
+};
+
+class WorkerMetrics
+{
+public:
+
+    WorkerMetrics(unsigned int _numWorkers);
+    ~WorkerMetrics();
+    void add(unsigned int worker,unsigned int metric,unsigned long long amount);
+    void add_latency(unsigned int worker,unsigned long long ns);
+    unsigned int get_producer();
+    bool dump(const char* path);
+    static unsigned long long now();
+
+private:
+
+    void write_open_metrics(FILE* out);
+    void write_json(FILE* out);
+
+    unsigned int numWorkers;
+    WorkerSlot* slots;
+};
+
+#endif